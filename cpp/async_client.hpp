@@ -0,0 +1,195 @@
+/**
+ * Drip C++ SDK - Future-returning API variants for the testdrip harness
+ *
+ * AsyncClient wraps a drip::Client with *Async methods that queue the call
+ * and return a std::future immediately. A fixed set of worker threads runs
+ * the queued calls, so callers can keep any number of requests outstanding
+ * without an OS thread each; the worker count bounds how many are on the
+ * wire at once. Exceptions (DripError and friends) are delivered through the
+ * future and rethrown by get().
+ *
+ * drip::Client only offers blocking calls and its curl handles are private,
+ * so the calls cannot be driven from a single curl_multi loop here; the
+ * workers block on the SDK instead, sharing the wrapped client the same way
+ * the race tests' threads did.
+ *
+ * With a Retrier, calls that are safe to repeat (reads, and writes that carry
+ * an idempotency key or external run id) retry retryable failures on the
+ * worker before the future is resolved. Other writes are never retried.
+ * Every attempt is recorded in ClientMetrics when metrics are enabled.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "client_metrics.hpp"
+#include "retry_policy.hpp"
+
+class AsyncClient {
+public:
+    typedef decltype(std::declval<drip::Client&>().ping()) PingResult;
+    typedef decltype(std::declval<drip::Client&>().createCustomer(drip::CreateCustomerParams())) CustomerResult;
+    typedef decltype(std::declval<drip::Client&>().getCustomer(std::string())) GetCustomerResult;
+    typedef decltype(std::declval<drip::Client&>().listCustomers(drip::ListCustomersOptions())) ListCustomersResult;
+    typedef decltype(std::declval<drip::Client&>().getBalance(std::string())) BalanceResult;
+    typedef decltype(std::declval<drip::Client&>().trackUsage(drip::TrackUsageParams())) TrackUsageResult;
+    typedef decltype(std::declval<drip::Client&>().recordRun(drip::RecordRunParams())) RecordRunResult;
+    typedef decltype(std::declval<drip::Client&>().startRun(drip::StartRunParams())) StartRunResult;
+    typedef decltype(std::declval<drip::Client&>().emitEvent(drip::EmitEventParams())) EmitEventResult;
+    typedef decltype(std::declval<drip::Client&>().endRun(std::string(), drip::EndRunParams())) EndRunResult;
+
+    /** `retrier` is optional and must outlive the AsyncClient. */
+    AsyncClient(drip::Client& client, size_t workers, Retrier* retrier = nullptr)
+        : client_(client), retrier_(retrier), stopping_(false) {
+        if (workers == 0) workers = 1;
+        for (size_t i = 0; i < workers; ++i) workers_.emplace_back(&AsyncClient::run, this, i);
+    }
+
+    /** Runs every queued call, then joins the workers. */
+    ~AsyncClient() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    std::future<PingResult> pingAsync() {
+        return submit_retried(true, [this] {
+            return metered(Endpoint::PING, [&] { return client_.ping(); });
+        });
+    }
+
+    std::future<CustomerResult> createCustomerAsync(const drip::CreateCustomerParams& params) {
+        return submit([this, params] {
+            return metered(Endpoint::CREATE_CUSTOMER, [&] { return client_.createCustomer(params); });
+        });
+    }
+
+    std::future<GetCustomerResult> getCustomerAsync(const std::string& customer_id) {
+        return submit_retried(true, [this, customer_id] {
+            return metered(Endpoint::GET_CUSTOMER, [&] { return client_.getCustomer(customer_id); });
+        });
+    }
+
+    std::future<ListCustomersResult> listCustomersAsync(const drip::ListCustomersOptions& opts) {
+        return submit_retried(true, [this, opts] {
+            return metered(Endpoint::LIST_CUSTOMERS, [&] { return client_.listCustomers(opts); });
+        });
+    }
+
+    std::future<BalanceResult> getBalanceAsync(const std::string& customer_id) {
+        return submit_retried(true, [this, customer_id] {
+            return metered(Endpoint::GET_BALANCE, [&] { return client_.getBalance(customer_id); });
+        });
+    }
+
+    std::future<TrackUsageResult> trackUsageAsync(const drip::TrackUsageParams& params) {
+        return submit_retried(!params.idempotency_key.empty(), [this, params] {
+            return metered(Endpoint::TRACK_USAGE, params, [&] { return client_.trackUsage(params); });
+        });
+    }
+
+    std::future<RecordRunResult> recordRunAsync(const drip::RecordRunParams& params) {
+        return submit_retried(!params.external_run_id.empty(), [this, params] {
+            return metered(Endpoint::RECORD_RUN, [&] { return client_.recordRun(params); });
+        });
+    }
+
+    std::future<StartRunResult> startRunAsync(const drip::StartRunParams& params) {
+        return submit([this, params] {
+            return metered(Endpoint::START_RUN, [&] { return client_.startRun(params); });
+        });
+    }
+
+    std::future<EmitEventResult> emitEventAsync(const drip::EmitEventParams& params) {
+        return submit_retried(!params.idempotency_key.empty(), [this, params] {
+            return metered(Endpoint::EMIT_EVENT, params, [&] { return client_.emitEvent(params); });
+        });
+    }
+
+    std::future<EndRunResult> endRunAsync(const std::string& run_id, const drip::EndRunParams& params) {
+        return submit([this, run_id, params] {
+            return metered(Endpoint::END_RUN, [&] { return client_.endRun(run_id, params); });
+        });
+    }
+
+    /** Run an arbitrary sequence of calls on the wrapped client as one queued job. */
+    template <typename F>
+    std::future<decltype(std::declval<F&>()(std::declval<drip::Client&>()))> callAsync(F fn) {
+        return submit([this, fn]() mutable { return fn(client_); });
+    }
+
+    /** Calls queued but not yet picked up by a worker. */
+    size_t queued() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return queue_.size();
+    }
+
+    size_t workers() const { return workers_.size(); }
+
+    /** The retry policy idempotent calls go through, or null. */
+    Retrier* retrier() const { return retrier_; }
+
+private:
+    template <typename F>
+    std::future<decltype(std::declval<F&>()())> submit_retried(bool idempotent, F fn) {
+        if (!retrier_ || !idempotent) return submit(fn);
+        return submit([this, fn] { return retrier_->call(fn); });
+    }
+
+    template <typename F>
+    std::future<decltype(std::declval<F&>()())> submit(F fn) {
+        typedef decltype(fn()) R;
+        // packaged_task is move-only; std::function needs a copyable target
+        std::shared_ptr<std::packaged_task<R()> > task =
+            std::make_shared<std::packaged_task<R()> >(std::move(fn));
+        std::future<R> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            queue_.push_back([task] { (*task)(); });
+        }
+        cv_.notify_one();
+        return result;
+    }
+
+    void run(size_t index) {
+        TraceRecorder& trace = TraceRecorder::instance();
+        if (trace.enabled()) trace.set_thread_name("AsyncClient worker " + std::to_string(index));
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            job();
+        }
+    }
+
+    drip::Client& client_;
+    Retrier* retrier_;
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()> > queue_;
+    bool stopping_;
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,258 @@
+/**
+ * Drip C++ SDK - Balance read cache for the testdrip harness
+ *
+ * Gating logic asks "can this customer keep going?" before every request,
+ * which as a getBalance() call costs a full round trip each time. The
+ * balance only needs to be recent, not live, so BalanceCache keeps the last
+ * answer per customer and serves it until it is max_staleness old. Entries
+ * are spread over independently locked shards by customer ID, so concurrent
+ * gate checks for different customers don't contend; a hit is a hash lookup
+ * under one shard mutex. Misses are single-flight per customer: a get() that
+ * finds a fetch already in flight waits for its answer instead of sending
+ * another getBalance().
+ *
+ * Writes keep the cache honest:
+ *   adjust()         applies a known charge to the cached balance locally.
+ *   on_record_run()  adjusts by the run's total_cost_units when the caller
+ *                    knows the USDC rate, else drops the entry.
+ *   invalidate()     drops the entry so the next get() refetches.
+ * trackUsage() results carry no cost, so usage alone leaves the entry in
+ * place; max_staleness bounds how long that can go unnoticed.
+ *
+ * A fetch that overlaps a write to its shard (adjust or invalidation) is
+ * returned to its callers but not stored, so a slow read can't put a
+ * pre-write balance back; the write also detaches the fetch, so get() calls
+ * made after the write start a fresh one rather than joining it.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "client_metrics.hpp"
+#include "latency_histogram.hpp"
+
+struct BalanceCacheOptions {
+    std::chrono::milliseconds max_staleness = std::chrono::milliseconds(1000);
+    size_t shards = 16;
+};
+
+struct BalanceCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;         // getBalance() fetches, including refetches of entries too old
+    uint64_t coalesced = 0;      // Misses that waited on a fetch already in flight
+    uint64_t invalidations = 0;
+    uint64_t adjustments = 0;
+    LatencyHistogram hit_ns;     // Cache lookup time on hits, in nanoseconds
+    LatencyHistogram miss_us;    // getBalance() time on misses, in microseconds
+
+    double hit_ratio() const {
+        uint64_t total = hits + misses + coalesced;
+        return total ? static_cast<double>(hits) / total : 0.0;
+    }
+};
+
+class BalanceCache {
+public:
+    typedef decltype(std::declval<drip::Client&>().getBalance(std::string())) Balance;
+    typedef decltype(std::declval<drip::Client&>().recordRun(drip::RecordRunParams())) RecordRunResult;
+
+    explicit BalanceCache(const BalanceCacheOptions& opts = BalanceCacheOptions()) : opts_(opts) {
+        size_t n = opts_.shards ? opts_.shards : 1;
+        for (size_t i = 0; i < n; ++i) shards_.push_back(std::unique_ptr<Shard>(new Shard()));
+    }
+
+    BalanceCache(const BalanceCache&) = delete;
+    BalanceCache& operator=(const BalanceCache&) = delete;
+
+    /** Cached balance if fresh, else fetched with `client` (and cached). Rethrows fetch errors. */
+    Balance get(drip::Client& client, const std::string& customer_id) {
+        Shard& s = shard_for(customer_id);
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t epoch;
+        std::shared_ptr<std::promise<Balance> > promise;
+        {
+            std::unique_lock<std::mutex> lock(s.mtx);
+            std::unordered_map<std::string, Entry>::iterator it = s.entries.find(customer_id);
+            if (it != s.entries.end() && t0 - it->second.fetched < opts_.max_staleness) {
+                Balance value = it->second.value;
+                ++s.stats.hits;
+                s.stats.hit_ns.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - t0).count());
+                return value;
+            }
+            std::unordered_map<std::string, Fetch>::iterator in = s.fetches.find(customer_id);
+            if (in != s.fetches.end()) {
+                ++s.stats.coalesced;
+                std::shared_future<Balance> pending = in->second.value;
+                lock.unlock();
+                return pending.get();
+            }
+            promise = std::make_shared<std::promise<Balance> >();
+            s.fetches[customer_id] = Fetch{promise, promise->get_future().share()};
+            epoch = s.epoch;
+        }
+
+        Balance value;
+        try {
+            value = metered(Endpoint::GET_BALANCE, [&] { return client.getBalance(customer_id); });
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(s.mtx);
+                end_fetch_locked(s, customer_id, promise);
+            }
+            promise->set_exception(std::current_exception());
+            throw;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(s.mtx);
+            ++s.stats.misses;
+            s.stats.miss_us.record(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+            if (s.epoch == epoch) s.entries[customer_id] = Entry{value, t1};
+            end_fetch_locked(s, customer_id, promise);
+        }
+        promise->set_value(value);
+        return value;
+    }
+
+    /** Cached balance regardless of age; false if there is none. Never fetches. */
+    bool peek(const std::string& customer_id, Balance& out) const {
+        Shard& s = shard_for(customer_id);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        std::unordered_map<std::string, Entry>::const_iterator it = s.entries.find(customer_id);
+        if (it == s.entries.end()) return false;
+        out = it->second.value;
+        return true;
+    }
+
+    void invalidate(const std::string& customer_id) {
+        Shard& s = shard_for(customer_id);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        s.entries.erase(customer_id);
+        s.fetches.erase(customer_id);
+        ++s.epoch;
+        ++s.stats.invalidations;
+    }
+
+    /**
+     * Add `delta_usdc` (negative for a charge) to the cached balance, keeping
+     * its number of decimals. Entries that don't parse are dropped instead.
+     * Returns false if nothing was cached for the customer.
+     */
+    bool adjust(const std::string& customer_id, double delta_usdc) {
+        Shard& s = shard_for(customer_id);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        // A fetch in flight read the balance before this charge, cached or not
+        s.fetches.erase(customer_id);
+        ++s.epoch;
+        std::unordered_map<std::string, Entry>::iterator it = s.entries.find(customer_id);
+        if (it == s.entries.end()) return false;
+        std::string& text = it->second.value.balance_usdc;
+        char* end = nullptr;
+        double current = std::strtod(text.c_str(), &end);
+        if (end == text.c_str()) {
+            s.entries.erase(it);
+            ++s.stats.invalidations;
+            return false;
+        }
+        const char* dot = std::strchr(text.c_str(), '.');
+        int decimals = dot ? static_cast<int>(std::strspn(dot + 1, "0123456789")) : 0;
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.*f", decimals, current + delta_usdc);
+        text = buf;
+        ++s.stats.adjustments;
+        return true;
+    }
+
+    /** Write-through for recordRun(): charge total_cost_units at `usdc_per_cost_unit`, or invalidate if unknown (<= 0). */
+    void on_record_run(const std::string& customer_id, const RecordRunResult& result,
+                       double usdc_per_cost_unit = 0) {
+        if (usdc_per_cost_unit > 0 && result.total_cost_units > 0) {
+            if (adjust(customer_id, -result.total_cost_units * usdc_per_cost_unit)) return;
+        }
+        invalidate(customer_id);
+    }
+
+    void clear() {
+        for (auto& s : shards_) {
+            std::lock_guard<std::mutex> lock(s->mtx);
+            s->entries.clear();
+            s->fetches.clear();
+            ++s->epoch;
+        }
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (const auto& s : shards_) {
+            std::lock_guard<std::mutex> lock(s->mtx);
+            n += s->entries.size();
+        }
+        return n;
+    }
+
+    BalanceCacheStats stats() const {
+        BalanceCacheStats out;
+        for (const auto& s : shards_) {
+            std::lock_guard<std::mutex> lock(s->mtx);
+            out.hits += s->stats.hits;
+            out.misses += s->stats.misses;
+            out.coalesced += s->stats.coalesced;
+            out.invalidations += s->stats.invalidations;
+            out.adjustments += s->stats.adjustments;
+            out.hit_ns.merge(s->stats.hit_ns);
+            out.miss_us.merge(s->stats.miss_us);
+        }
+        return out;
+    }
+
+private:
+    struct Entry {
+        Balance value;
+        std::chrono::steady_clock::time_point fetched;
+    };
+
+    /** A getBalance() in flight; later misses for the customer wait on `value`. */
+    struct Fetch {
+        std::shared_ptr<std::promise<Balance> > promise;
+        std::shared_future<Balance> value;
+    };
+
+    struct Shard {
+        mutable std::mutex mtx;
+        std::unordered_map<std::string, Entry> entries;
+        std::unordered_map<std::string, Fetch> fetches;
+        uint64_t epoch = 0;  // Bumped by every adjustment and invalidation in this shard
+        BalanceCacheStats stats;
+    };
+
+    /** Forget `promise`'s fetch unless a write already detached it (and maybe started another). */
+    static void end_fetch_locked(Shard& s, const std::string& customer_id,
+                                 const std::shared_ptr<std::promise<Balance> >& promise) {
+        std::unordered_map<std::string, Fetch>::iterator it = s.fetches.find(customer_id);
+        if (it != s.fetches.end() && it->second.promise == promise) s.fetches.erase(it);
+    }
+
+    Shard& shard_for(const std::string& customer_id) const {
+        return *shards_[std::hash<std::string>()(customer_id) % shards_.size()];
+    }
+
+    BalanceCacheOptions opts_;
+    std::vector<std::unique_ptr<Shard> > shards_;
+};
@@ -0,0 +1,301 @@
+/**
+ * Drip C++ SDK - Bulk customer provisioning for the testdrip harness
+ *
+ * The SDK creates and fetches one customer per call, which is fine for a
+ * signup but not for onboarding a tenant with tens of thousands of end-users.
+ * BulkCustomers fans a list out over a ClientPool: the input is cut into
+ * chunks of chunk_size, and `parallelism` threads each lease a client and
+ * work through whole chunks on it, so every thread reuses one warm
+ * connection for a chunk's worth of calls. Results come back in input order,
+ * one outcome per entry, and a failed entry never fails the batch.
+ *
+ * createCustomers() is idempotent on external_customer_id:
+ *   - Duplicate external IDs in the input are created once and share the
+ *     outcome. Entries without an external ID are each created on their own.
+ *   - A create that conflicts (409) because the customer already exists is
+ *     treated as success. The SDK has no lookup by external ID, so conflicts
+ *     are resolved from an index of listCustomers() pages: first from what
+ *     earlier batches already scanned, then by resuming the scan where it
+ *     left off, at most max_scan_pages pages per batch. The index holds up to
+ *     max_index_entries customers and lives as long as the BulkCustomers.
+ * So re-running a partially failed provisioning job is safe and returns the
+ * same customer IDs. Pass a Retrier to retry network errors, 429s and 5xxs;
+ * that is safe for creates for the same reason.
+ *
+ * getCustomers() fetches by Drip customer ID with the same chunking and
+ * parallelism, deduplicating repeated IDs.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client_metrics.hpp"
+#include "client_pool.hpp"
+#include "retry_policy.hpp"
+
+struct BulkCustomerOptions {
+    size_t chunk_size = 100;
+    size_t parallelism = 8;      // Worker threads; each holds one leased client at a time
+    int max_scan_pages = 50;     // listCustomers() pages a batch may read to resolve conflicts
+    size_t max_index_entries = 100000;  // Scanned customers kept for later batches' conflicts
+};
+
+struct BulkCustomerOutcome {
+    bool ok = false;
+    bool existing = false;  // Already existed (conflict resolved), not created by this call
+    drip::Customer customer;
+    std::string error;
+};
+
+struct BulkCustomerStats {
+    size_t requested = 0;
+    size_t unique = 0;      // Distinct external IDs / customer IDs actually sent
+    size_t succeeded = 0;   // Over `requested`, so duplicates count once each
+    size_t existing = 0;
+    size_t failed = 0;
+    size_t chunks = 0;
+    size_t calls = 0;       // API calls, including the conflict-resolution scan
+    int64_t elapsed_us = 0;
+
+    double per_sec() const { return elapsed_us > 0 ? succeeded * 1e6 / elapsed_us : 0.0; }
+};
+
+class BulkCustomers {
+public:
+    explicit BulkCustomers(ClientPool& pool, const BulkCustomerOptions& opts = BulkCustomerOptions(),
+                           Retrier* retrier = nullptr)
+        : pool_(pool), opts_(opts), retrier_(retrier) {
+        if (opts_.chunk_size == 0) opts_.chunk_size = 1;
+        if (opts_.parallelism == 0) opts_.parallelism = 1;
+    }
+
+    BulkCustomers(const BulkCustomers&) = delete;
+    BulkCustomers& operator=(const BulkCustomers&) = delete;
+
+    /** Create every customer in `params`; outcomes are in input order. */
+    std::vector<BulkCustomerOutcome> createCustomers(const std::vector<drip::CreateCustomerParams>& params,
+                                                     BulkCustomerStats* stats_out = nullptr) {
+        int64_t t0 = now_us();
+        std::vector<size_t> slot;            // Input index -> unique index
+        std::vector<size_t> unique;          // Unique index -> first input index
+        dedupe(params, [](const drip::CreateCustomerParams& p) { return p.external_customer_id; }, slot, unique);
+
+        std::vector<BulkCustomerOutcome> results(unique.size());
+        std::vector<char> conflicted(unique.size(), 0);
+        std::atomic<size_t> calls{0};
+        size_t chunks = run_chunks(unique.size(), [&](drip::Client& c, size_t u) {
+            const drip::CreateCustomerParams& p = params[unique[u]];
+            calls.fetch_add(1, std::memory_order_relaxed);
+            try {
+                results[u].customer = with_retry([&] {
+                    return metered(Endpoint::CREATE_CUSTOMER, [&] { return c.createCustomer(p); });
+                });
+                results[u].ok = true;
+            } catch (const drip::DripError& e) {
+                if (e.status_code() == 409) conflicted[u] = 1;
+                results[u].error = e.what();
+            } catch (const std::exception& e) {
+                results[u].error = e.what();
+            }
+        });
+
+        std::map<std::string, size_t> pending;
+        for (size_t u = 0; u < unique.size(); ++u) {
+            const std::string& ext = params[unique[u]].external_customer_id;
+            if (conflicted[u] && !ext.empty()) pending[ext] = u;
+        }
+        if (!pending.empty()) resolve_existing(pending, results, calls);
+
+        std::vector<BulkCustomerOutcome> out = expand(results, slot);
+        if (stats_out) *stats_out = summarize(out, unique.size(), chunks, calls, now_us() - t0);
+        return out;
+    }
+
+    /** Fetch every customer in `customer_ids`; outcomes are in input order. */
+    std::vector<BulkCustomerOutcome> getCustomers(const std::vector<std::string>& customer_ids,
+                                                  BulkCustomerStats* stats_out = nullptr) {
+        int64_t t0 = now_us();
+        std::vector<size_t> slot, unique;
+        dedupe(customer_ids, [](const std::string& id) { return id; }, slot, unique);
+
+        std::vector<BulkCustomerOutcome> results(unique.size());
+        std::atomic<size_t> calls{0};
+        size_t chunks = run_chunks(unique.size(), [&](drip::Client& c, size_t u) {
+            const std::string& id = customer_ids[unique[u]];
+            calls.fetch_add(1, std::memory_order_relaxed);
+            try {
+                results[u].customer = with_retry([&] {
+                    return metered(Endpoint::GET_CUSTOMER, [&] { return c.getCustomer(id); });
+                });
+                results[u].ok = true;
+            } catch (const std::exception& e) {
+                results[u].error = e.what();
+            }
+        });
+
+        std::vector<BulkCustomerOutcome> out = expand(results, slot);
+        if (stats_out) *stats_out = summarize(out, unique.size(), chunks, calls, now_us() - t0);
+        return out;
+    }
+
+private:
+    static int64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    template <typename F>
+    auto with_retry(F fn) -> decltype(fn()) {
+        return retrier_ ? retrier_->call(fn) : fn();
+    }
+
+    template <typename T, typename Key>
+    static void dedupe(const std::vector<T>& items, Key key, std::vector<size_t>& slot, std::vector<size_t>& unique) {
+        std::map<std::string, size_t> seen;
+        slot.resize(items.size());
+        for (size_t i = 0; i < items.size(); ++i) {
+            const std::string k = key(items[i]);
+            if (k.empty()) {
+                // No ID to be idempotent on: every such entry is its own call
+                slot[i] = unique.size();
+                unique.push_back(i);
+                continue;
+            }
+            std::map<std::string, size_t>::iterator it = seen.find(k);
+            if (it == seen.end()) {
+                it = seen.insert(std::make_pair(k, unique.size())).first;
+                unique.push_back(i);
+            }
+            slot[i] = it->second;
+        }
+    }
+
+    /** Run fn(client, index) for every index in [0, n), one chunk per lease. Returns the chunk count. */
+    template <typename F>
+    size_t run_chunks(size_t n, F fn) {
+        size_t chunks = (n + opts_.chunk_size - 1) / opts_.chunk_size;
+        std::atomic<size_t> next{0};
+        auto worker = [&] {
+            for (size_t k = next.fetch_add(1); k < chunks; k = next.fetch_add(1)) {
+                ClientPool::Lease client = pool_.acquire();
+                size_t end = std::min(n, (k + 1) * opts_.chunk_size);
+                for (size_t i = k * opts_.chunk_size; i < end; ++i) fn(*client, i);
+            }
+        };
+        size_t threads = std::min(opts_.parallelism, chunks);
+        std::vector<std::thread> pool;
+        for (size_t t = 1; t < threads; ++t) pool.push_back(std::thread(worker));
+        if (threads > 0) worker();
+        for (size_t t = 0; t < pool.size(); ++t) pool[t].join();
+        return chunks;
+    }
+
+    /**
+     * Resolve conflicted external IDs from the scan index, resuming the
+     * listCustomers() scan where the previous batch stopped (wrapping to the
+     * first page once) for the ones it doesn't hold yet.
+     */
+    void resolve_existing(std::map<std::string, size_t>& pending, std::vector<BulkCustomerOutcome>& results,
+                          std::atomic<size_t>& calls) {
+        std::lock_guard<std::mutex> lock(index_mtx_);
+        for (std::map<std::string, size_t>::iterator it = pending.begin(); it != pending.end();) {
+            std::map<std::string, drip::Customer>::const_iterator hit = index_.find(it->first);
+            if (hit == index_.end()) {
+                ++it;
+                continue;
+            }
+            mark_existing(results[it->second], hit->second);
+            pending.erase(it++);
+        }
+        if (pending.empty()) return;
+
+        ClientPool::Lease client = pool_.acquire();
+        drip::ListCustomersOptions opts;
+        opts.limit = 100;
+        bool wrapped = scan_cursor_.empty();  // Starting from the first page is a full pass
+        try {
+            for (int page = 0; page < opts_.max_scan_pages && !pending.empty(); ++page) {
+                opts.starting_after = scan_cursor_;
+                calls.fetch_add(1, std::memory_order_relaxed);
+                drip::ListCustomersResponse r = with_retry([&] {
+                    return metered(Endpoint::LIST_CUSTOMERS, [&] { return client->listCustomers(opts); });
+                });
+                for (size_t i = 0; i < r.customers.size(); ++i) {
+                    const drip::Customer& c = r.customers[i];
+                    if (c.external_customer_id.empty()) continue;
+                    if (index_.size() < opts_.max_index_entries) index_[c.external_customer_id] = c;
+                    std::map<std::string, size_t>::iterator it = pending.find(c.external_customer_id);
+                    if (it == pending.end()) continue;
+                    mark_existing(results[it->second], c);
+                    pending.erase(it);
+                }
+                if (r.customers.size() < static_cast<size_t>(opts.limit)) {
+                    // End of the list: the next page starts over, unless this pass already did
+                    scan_cursor_.clear();
+                    if (wrapped) break;
+                    wrapped = true;
+                } else {
+                    scan_cursor_ = r.customers.back().id;
+                }
+            }
+        } catch (const std::exception& e) {
+            for (std::map<std::string, size_t>::iterator it = pending.begin(); it != pending.end(); ++it) {
+                results[it->second].error += std::string(" (lookup failed: ") + e.what() + ")";
+            }
+            return;
+        }
+        for (std::map<std::string, size_t>::iterator it = pending.begin(); it != pending.end(); ++it) {
+            results[it->second].error += " (not found when resolving conflict)";
+        }
+    }
+
+    static void mark_existing(BulkCustomerOutcome& o, const drip::Customer& c) {
+        o.customer = c;
+        o.ok = true;
+        o.existing = true;
+        o.error.clear();
+    }
+
+    static std::vector<BulkCustomerOutcome> expand(const std::vector<BulkCustomerOutcome>& results,
+                                                   const std::vector<size_t>& slot) {
+        std::vector<BulkCustomerOutcome> out;
+        out.reserve(slot.size());
+        for (size_t i = 0; i < slot.size(); ++i) out.push_back(results[slot[i]]);
+        return out;
+    }
+
+    static BulkCustomerStats summarize(const std::vector<BulkCustomerOutcome>& out, size_t unique,
+                                       size_t chunks, const std::atomic<size_t>& calls, int64_t elapsed_us) {
+        BulkCustomerStats s;
+        s.requested = out.size();
+        s.unique = unique;
+        s.chunks = chunks;
+        s.calls = calls.load();
+        s.elapsed_us = elapsed_us;
+        for (size_t i = 0; i < out.size(); ++i) {
+            if (!out[i].ok) ++s.failed;
+            else ++s.succeeded;
+            if (out[i].existing) ++s.existing;
+        }
+        return s;
+    }
+
+    ClientPool& pool_;
+    BulkCustomerOptions opts_;
+    Retrier* retrier_;
+
+    std::mutex index_mtx_;
+    std::map<std::string, drip::Customer> index_;  // External ID -> customer, from conflict scans
+    std::string scan_cursor_;                      // starting_after for the next scan page
+};
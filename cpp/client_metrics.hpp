@@ -0,0 +1,349 @@
+/**
+ * Drip C++ SDK - Per-endpoint client metrics for the testdrip harness
+ *
+ * Wrapping an SDK call in metered() records, per endpoint: requests, errors
+ * by HTTP status (0 = network failure, -1 = non-Drip exception), a latency
+ * histogram at microsecond resolution, request payload bytes and an
+ * in-flight gauge.
+ *
+ *   auto balance = metered(Endpoint::GET_BALANCE, [&] { return client.getBalance(id); });
+ *   metered(Endpoint::TRACK_USAGE, params, [&] { return client.trackUsage(params); });
+ *
+ * Counters are aggregated per thread: each thread writes to its own shard
+ * behind a mutex nobody else takes except a scrape, so recording is an
+ * uncontended lock and a few increments. Only the in-flight gauges are
+ * shared atomics. Metrics are off until ClientMetrics::instance().enable(),
+ * and metered() is a plain call while they and tracing are; with tracing on
+ * each call is also recorded as a TraceRecorder span. Builds with
+ * DRIP_PROFILE=1 also time sampled calls per stage (request_profiler.hpp).
+ * While a FaultInjector is active, every metered call goes through it, so
+ * injected delays and errors are measured like real ones
+ * (fault_injection.hpp).
+ *
+ * write_prometheus() renders everything in the Prometheus text exposition
+ * format. Latency buckets are fixed (100us .. 10s) so merging shards is a
+ * sum. drip::Client's transport is private, so response sizes can't be
+ * observed and only request bodies the harness can serialize (trackUsage,
+ * emitEvent) count towards bytes sent.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fault_injection.hpp"
+#include "json_writer.hpp"
+#include "request_profiler.hpp"
+#include "trace_events.hpp"
+
+// X(id, "name")
+#define DRIP_ENDPOINTS(X)                   \
+    X(PING,            "ping")              \
+    X(CREATE_CUSTOMER, "createCustomer")    \
+    X(GET_CUSTOMER,    "getCustomer")       \
+    X(LIST_CUSTOMERS,  "listCustomers")     \
+    X(GET_BALANCE,     "getBalance")        \
+    X(TRACK_USAGE,     "trackUsage")        \
+    X(RECORD_RUN,      "recordRun")         \
+    X(START_RUN,       "startRun")          \
+    X(EMIT_EVENT,      "emitEvent")         \
+    X(END_RUN,         "endRun")
+
+enum class Endpoint : uint8_t {
+#define X(id, name) id,
+    DRIP_ENDPOINTS(X)
+#undef X
+    COUNT
+};
+
+static const size_t ENDPOINT_COUNT = static_cast<size_t>(Endpoint::COUNT);
+
+inline const char* endpoint_name(Endpoint e) {
+    static const char* const names[] = {
+#define X(id, name) name,
+        DRIP_ENDPOINTS(X)
+#undef X
+    };
+    return names[static_cast<size_t>(e)];
+}
+
+/** Request body size for calls the harness can serialize; 0 for the rest. */
+inline size_t request_bytes(const drip::TrackUsageParams& p) {
+    JsonWriter& w = thread_json_writer();
+    write_json(w, p);
+    return w.str().size();
+}
+
+inline size_t request_bytes(const drip::EmitEventParams& p) {
+    JsonWriter& w = thread_json_writer();
+    write_json(w, p);
+    return w.str().size();
+}
+
+/** Not serialized by the harness; a recordRun is passed as a body only so offline results can echo it. */
+inline size_t request_bytes(const drip::RecordRunParams&) { return 0; }
+
+class ClientMetrics {
+public:
+    /** Upper bucket bounds in microseconds; a final +Inf bucket is implicit. */
+    static const int64_t* bucket_bounds_us() {
+        static const int64_t bounds[] = {100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+                                         100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000};
+        return bounds;
+    }
+    static const size_t BUCKETS = 16;
+
+    struct EndpointStats {
+        uint64_t requests = 0;
+        uint64_t errors = 0;
+        std::map<int, uint64_t> errors_by_status;
+        uint64_t buckets[BUCKETS + 1] = {};  // Not cumulative; last is +Inf
+        int64_t latency_sum_us = 0;
+        uint64_t bytes_sent = 0;
+
+        void merge(const EndpointStats& o) {
+            requests += o.requests;
+            errors += o.errors;
+            for (const auto& kv : o.errors_by_status) errors_by_status[kv.first] += kv.second;
+            for (size_t i = 0; i <= BUCKETS; ++i) buckets[i] += o.buckets[i];
+            latency_sum_us += o.latency_sum_us;
+            bytes_sent += o.bytes_sent;
+        }
+    };
+
+    static ClientMetrics& instance() {
+        static ClientMetrics metrics;
+        return metrics;
+    }
+
+    void enable(bool on = true) { enabled_.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /** Records one finished call from the thread that made it; status 0 = success. */
+    void record(Endpoint e, int64_t latency_us, bool failed, int status, size_t bytes_sent) {
+        Shard& s = local_shard();
+        std::lock_guard<std::mutex> lock(s.mtx);
+        EndpointStats& st = s.endpoints[static_cast<size_t>(e)];
+        ++st.requests;
+        if (failed) {
+            ++st.errors;
+            ++st.errors_by_status[status];
+        }
+        size_t b = 0;
+        while (b < BUCKETS && latency_us > bucket_bounds_us()[b]) ++b;
+        ++st.buckets[b];
+        st.latency_sum_us += latency_us;
+        st.bytes_sent += bytes_sent;
+    }
+
+    std::atomic<int>& in_flight(Endpoint e) { return in_flight_[static_cast<size_t>(e)]; }
+
+    /** Every thread's shard summed, per endpoint. */
+    std::vector<EndpointStats> snapshot() const {
+        std::vector<EndpointStats> out(ENDPOINT_COUNT);
+        std::lock_guard<std::mutex> lock(shards_mtx_);
+        for (const auto& s : shards_) {
+            std::lock_guard<std::mutex> shard_lock(s->mtx);
+            for (size_t i = 0; i < ENDPOINT_COUNT; ++i) out[i].merge(s->endpoints[i]);
+        }
+        return out;
+    }
+
+    void write_prometheus(std::ostream& os) const {
+        std::vector<EndpointStats> stats = snapshot();
+        std::ostringstream out;  // Fresh stream: callers' std::fixed etc. would mangle bucket bounds
+        out << std::setprecision(10);
+        auto label = [](size_t i) { return std::string("endpoint=\"") + endpoint_name(static_cast<Endpoint>(i)) + "\""; };
+        auto used = [&](size_t i) { return stats[i].requests > 0 || in_flight_[i].load() > 0; };
+
+        out << "# HELP drip_client_requests_total SDK calls made, by endpoint.\n"
+            << "# TYPE drip_client_requests_total counter\n";
+        for (size_t i = 0; i < ENDPOINT_COUNT; ++i) {
+            if (used(i)) out << "drip_client_requests_total{" << label(i) << "} " << stats[i].requests << "\n";
+        }
+
+        out << "# HELP drip_client_errors_total Failed SDK calls, by endpoint and HTTP status (0 = network, -1 = other).\n"
+            << "# TYPE drip_client_errors_total counter\n";
+        for (size_t i = 0; i < ENDPOINT_COUNT; ++i) {
+            for (const auto& kv : stats[i].errors_by_status) {
+                out << "drip_client_errors_total{" << label(i) << ",status=\"" << kv.first << "\"} "
+                    << kv.second << "\n";
+            }
+        }
+
+        out << "# HELP drip_client_request_duration_seconds SDK call latency, by endpoint.\n"
+            << "# TYPE drip_client_request_duration_seconds histogram\n";
+        for (size_t i = 0; i < ENDPOINT_COUNT; ++i) {
+            if (!stats[i].requests) continue;
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < BUCKETS; ++b) {
+                cumulative += stats[i].buckets[b];
+                out << "drip_client_request_duration_seconds_bucket{" << label(i) << ",le=\""
+                    << bucket_bounds_us()[b] / 1e6 << "\"} " << cumulative << "\n";
+            }
+            cumulative += stats[i].buckets[BUCKETS];
+            out << "drip_client_request_duration_seconds_bucket{" << label(i) << ",le=\"+Inf\"} " << cumulative << "\n"
+                << "drip_client_request_duration_seconds_sum{" << label(i) << "} "
+                << stats[i].latency_sum_us / 1e6 << "\n"
+                << "drip_client_request_duration_seconds_count{" << label(i) << "} " << cumulative << "\n";
+        }
+
+        out << "# HELP drip_client_request_bytes_total Request body bytes sent (trackUsage and emitEvent only).\n"
+            << "# TYPE drip_client_request_bytes_total counter\n";
+        for (size_t i = 0; i < ENDPOINT_COUNT; ++i) {
+            if (stats[i].bytes_sent) {
+                out << "drip_client_request_bytes_total{" << label(i) << "} " << stats[i].bytes_sent << "\n";
+            }
+        }
+
+        out << "# HELP drip_client_in_flight_requests SDK calls currently waiting on the API.\n"
+            << "# TYPE drip_client_in_flight_requests gauge\n";
+        for (size_t i = 0; i < ENDPOINT_COUNT; ++i) {
+            if (used(i)) out << "drip_client_in_flight_requests{" << label(i) << "} " << in_flight_[i].load() << "\n";
+        }
+        out << "# EOF\n";
+        os << out.str();
+    }
+
+private:
+    struct Shard {
+        std::mutex mtx;
+        EndpointStats endpoints[ENDPOINT_COUNT];
+    };
+
+    ClientMetrics() : enabled_(false) {
+        for (size_t i = 0; i < ENDPOINT_COUNT; ++i) in_flight_[i].store(0);
+    }
+
+    // Shards outlive their threads, so counts from finished workers are kept.
+    Shard& local_shard() {
+        static thread_local Shard* shard = nullptr;
+        if (!shard) {
+            std::lock_guard<std::mutex> lock(shards_mtx_);
+            shards_.push_back(std::unique_ptr<Shard>(new Shard()));
+            shard = shards_.back().get();
+        }
+        return *shard;
+    }
+
+    std::atomic<bool> enabled_;
+    std::atomic<int> in_flight_[ENDPOINT_COUNT];
+    mutable std::mutex shards_mtx_;
+    std::vector<std::unique_ptr<Shard> > shards_;
+};
+
+#if DRIP_PROFILE
+/** Profiler stage "error": construct, throw and catch a copy of the DripError the call raised. */
+inline void profile_error(Endpoint endpoint, const drip::DripError& e) {
+    ProfileScope scope(static_cast<size_t>(endpoint), ProfileStage::FAILURE, true);
+    try {
+        throw drip::DripError(e);
+    } catch (const drip::DripError&) {
+    }
+}
+#define DRIP_PROFILE_SAMPLE() RequestProfiler::instance().sample()
+#else
+#define DRIP_PROFILE_SAMPLE() false
+#endif
+
+template <typename F>
+auto metered_call(ClientMetrics& m, Endpoint endpoint, F& fn, size_t bytes_sent,
+                  bool profiled = false) -> decltype(fn()) {
+    struct Call {
+        ClientMetrics& m;
+        Endpoint endpoint;
+        size_t bytes_sent;
+        std::chrono::steady_clock::time_point start;
+        bool failed;
+        int status;
+
+        ~Call() {
+            int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (m.enabled()) {
+                m.in_flight(endpoint).fetch_sub(1, std::memory_order_relaxed);
+                m.record(endpoint, us, failed, status, bytes_sent);
+            }
+            TraceRecorder& trace = TraceRecorder::instance();
+            if (trace.enabled()) {
+                TraceEvent e{endpoint_name(endpoint), "sdk", trace.to_us(start), us,
+                             std::map<std::string, std::string>()};
+                if (failed) e.args["status"] = std::to_string(status);
+                trace.complete(std::move(e));
+            }
+        }
+    };
+    if (m.enabled()) m.in_flight(endpoint).fetch_add(1, std::memory_order_relaxed);
+    Call call{m, endpoint, bytes_sent, std::chrono::steady_clock::now(), false, 0};
+    (void)profiled;
+    try {
+        DRIP_PROFILE_SCOPE(sdk, endpoint, ProfileStage::SDK, profiled);
+        return fn();
+    } catch (const drip::DripError& e) {
+        call.failed = true;
+        call.status = e.status_code();
+#if DRIP_PROFILE
+        if (profiled) profile_error(endpoint, e);
+#endif
+        throw;
+    } catch (...) {
+        call.failed = true;
+        call.status = -1;
+        throw;
+    }
+}
+
+/** metered_call(), or a plain call while metrics, tracing and profiling are all off. */
+template <typename F>
+auto metered_dispatch(ClientMetrics& m, Endpoint endpoint, F& fn, size_t bytes_sent,
+                      bool profiled) -> decltype(fn()) {
+    if (!m.enabled() && !TraceRecorder::instance().enabled() && !profiled) return fn();
+    return metered_call(m, endpoint, fn, bytes_sent, profiled);
+}
+
+/** Run fn() (one SDK call), recording it under `endpoint` if metrics or tracing are enabled. */
+template <typename F>
+auto metered(Endpoint endpoint, F fn) -> decltype(fn()) {
+    ClientMetrics& m = ClientMetrics::instance();
+    bool profiled = DRIP_PROFILE_SAMPLE();
+    FaultInjector& faults = FaultInjector::instance();
+    if (faults.active()) {
+        auto faulted = [&] { return faults.call(0, fn); };
+        return metered_dispatch(m, endpoint, faulted, 0, profiled);
+    }
+    return metered_dispatch(m, endpoint, fn, 0, profiled);
+}
+
+/**
+ * metered() for a call whose request body is `body`; it is only serialized
+ * when metrics are on, the call is profiled or injected faults cap bandwidth.
+ */
+template <typename Params, typename F>
+auto metered(Endpoint endpoint, const Params& body, F fn) -> decltype(fn()) {
+    ClientMetrics& m = ClientMetrics::instance();
+    bool profiled = DRIP_PROFILE_SAMPLE();
+    FaultInjector& faults = FaultInjector::instance();
+    size_t bytes = 0;
+    if (m.enabled() || profiled || (faults.active() && faults.limits_bandwidth())) {
+        DRIP_PROFILE_SCOPE(encode, endpoint, ProfileStage::HARNESS_ENCODE, profiled);
+        bytes = request_bytes(body);
+    }
+    if (faults.active()) {
+        auto faulted = [&] { return faults.call(bytes, body, fn); };
+        return metered_dispatch(m, endpoint, faulted, bytes, profiled);
+    }
+    return metered_dispatch(m, endpoint, fn, bytes, profiled);
+}
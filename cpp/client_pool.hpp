@@ -0,0 +1,188 @@
+/**
+ * Drip C++ SDK - Reusable client pool for the testdrip harness
+ *
+ * Each drip::Client owns its own HTTP connection state, so a client that is
+ * reused for consecutive requests can keep its connection alive, while a
+ * client shared by many threads serializes (or re-establishes) connections
+ * underneath them. ClientPool hands out up to max_clients clients built from
+ * one Config; a Lease returns its client to the idle list when destroyed, and
+ * acquire() blocks while every client is leased out.
+ *
+ * warm(n) pays connection setup up front: it builds clients in parallel and
+ * pings each one, so DNS, TCP and TLS are done before the first real
+ * request. Short-lived jobs then start at warm-connection latency instead of
+ * paying one handshake per worker on their first calls.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PoolWarmStats {
+    size_t warmed = 0;      // Clients built and pinged successfully
+    size_t failed = 0;      // Built, but the ping failed (still pooled; they connect on first use)
+    size_t unbuilt = 0;     // The drip::Client constructor threw; nothing was pooled for these
+    int64_t elapsed_us = 0;
+    int64_t slowest_us = 0; // Longest single construct + ping
+    std::string last_error;
+};
+
+class ClientPool {
+public:
+    class Lease {
+    public:
+        Lease() : pool_(nullptr), client_(nullptr) {}
+        Lease(Lease&& other) : pool_(other.pool_), client_(other.client_) {
+            other.pool_ = nullptr;
+            other.client_ = nullptr;
+        }
+        Lease& operator=(Lease&& other) {
+            if (this != &other) {
+                release();
+                pool_ = other.pool_;
+                client_ = other.client_;
+                other.pool_ = nullptr;
+                other.client_ = nullptr;
+            }
+            return *this;
+        }
+        ~Lease() { release(); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        drip::Client& operator*() const { return *client_; }
+        drip::Client* operator->() const { return client_; }
+        explicit operator bool() const { return client_ != nullptr; }
+
+    private:
+        friend class ClientPool;
+        Lease(ClientPool* pool, drip::Client* client) : pool_(pool), client_(client) {}
+
+        void release() {
+            if (pool_) pool_->put_back(client_);
+            pool_ = nullptr;
+            client_ = nullptr;
+        }
+
+        ClientPool* pool_;
+        drip::Client* client_;
+    };
+
+    ClientPool(const drip::Config& config, size_t max_clients)
+        : config_(config), max_clients_(max_clients ? max_clients : 1) {}
+
+    ClientPool(const ClientPool&) = delete;
+    ClientPool& operator=(const ClientPool&) = delete;
+
+    /** Borrow a client, creating one if the pool is below max_clients. */
+    Lease acquire() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this] { return !idle_.empty() || clients_.size() < max_clients_; });
+        drip::Client* c;
+        if (!idle_.empty()) {
+            c = idle_.back();
+            idle_.pop_back();
+        } else {
+            clients_.push_back(std::unique_ptr<drip::Client>(new drip::Client(config_)));
+            c = clients_.back().get();
+        }
+        return Lease(this, c);
+    }
+
+    /**
+     * Build and ping up to `n` more idle clients in parallel (capped at
+     * max_clients), so their connections are open before the first acquire().
+     * Construction and ping failures are counted in the stats, never thrown.
+     */
+    PoolWarmStats warm(size_t n) {
+        PoolWarmStats stats;
+        auto t0 = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            n = std::min(n, max_clients_ - clients_.size());
+        }
+        std::vector<std::unique_ptr<drip::Client> > fresh(n);
+        std::vector<int64_t> took(n, 0);
+        std::vector<std::string> errors(n);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < n; ++i) {
+            threads.push_back(std::thread([&, i] {
+                auto c0 = std::chrono::steady_clock::now();
+                // An exception escaping a std::thread would terminate the process
+                try {
+                    fresh[i].reset(new drip::Client(config_));
+                    fresh[i]->ping();
+                } catch (const std::exception& e) {
+                    errors[i] = e.what();
+                    if (errors[i].empty()) errors[i] = fresh[i] ? "ping failed" : "client construction failed";
+                } catch (...) {
+                    errors[i] = fresh[i] ? "ping failed" : "client construction failed";
+                }
+                took[i] = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - c0).count();
+            }));
+        }
+        for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            for (size_t i = 0; i < n; ++i) {
+                if (!fresh[i]) {
+                    ++stats.unbuilt;
+                    stats.last_error = errors[i];
+                    continue;
+                }
+                // Another thread may have filled the pool meanwhile; extra clients are dropped
+                if (clients_.size() >= max_clients_) break;
+                idle_.push_back(fresh[i].get());
+                clients_.push_back(std::move(fresh[i]));
+                if (errors[i].empty()) ++stats.warmed;
+                else {
+                    ++stats.failed;
+                    stats.last_error = errors[i];
+                }
+                stats.slowest_us = std::max(stats.slowest_us, took[i]);
+            }
+        }
+        cv_.notify_all();
+        stats.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        return stats;
+    }
+
+    const drip::Config& config() const { return config_; }
+    size_t max_clients() const { return max_clients_; }
+
+    /** Clients constructed so far (each one is at least one connection setup). */
+    size_t created() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return clients_.size();
+    }
+
+private:
+    void put_back(drip::Client* c) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            idle_.push_back(c);
+        }
+        cv_.notify_one();
+    }
+
+    drip::Config config_;
+    size_t max_clients_;
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<drip::Client> > clients_;
+    std::vector<drip::Client*> idle_;
+};
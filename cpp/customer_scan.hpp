@@ -0,0 +1,167 @@
+/**
+ * Drip C++ SDK - Streaming listCustomers() scan for the testdrip harness
+ *
+ * listCustomers() returns one page at a time, and collecting every page into
+ * a vector grows without bound. A reconciliation job that walks the whole
+ * customer list only needs one customer at a time. CustomerScan is a lazy
+ * input range over the list:
+ *
+ *   CustomerScan scan(client);                // every page, 100 per page
+ *   for (const drip::Customer& c : scan) reconcile(c);
+ *
+ * Pages are chained by cursor: each request sets starting_after to the last
+ * ID of the page before it. While the caller works through one page, the
+ * next one is already being fetched on a background thread. So at most two
+ * pages are held at once, whatever the list's size, and the caller only
+ * waits when it consumes items faster than the API returns them
+ * (wait_us() says how long that was).
+ *
+ * The scan ends on a short page, after max_pages pages, or if the cursor
+ * stops moving (a page whose last ID is empty or repeats the cursor). A
+ * failed fetch is rethrown from begin() or operator++ on the caller's
+ * thread. A scan is single-pass: begin() may only be called once.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "client_metrics.hpp"
+
+class CustomerScan {
+public:
+    class iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef drip::Customer value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const drip::Customer* pointer;
+        typedef const drip::Customer& reference;
+
+        iterator() : scan_(nullptr) {}
+
+        reference operator*() const { return scan_->current_[scan_->pos_]; }
+        pointer operator->() const { return &scan_->current_[scan_->pos_]; }
+
+        iterator& operator++() {
+            if (!scan_->next_item()) scan_ = nullptr;
+            return *this;
+        }
+
+        bool operator==(const iterator& o) const { return scan_ == o.scan_; }
+        bool operator!=(const iterator& o) const { return scan_ != o.scan_; }
+
+    private:
+        friend class CustomerScan;
+        explicit iterator(CustomerScan* scan) : scan_(scan) {}
+        CustomerScan* scan_;  // Null = end
+    };
+
+    /** `max_pages` = 0 scans to the end; `prefetch` = false fetches each page when it is reached. */
+    explicit CustomerScan(drip::Client& client, const drip::ListCustomersOptions& opts = drip::ListCustomersOptions(),
+                          int max_pages = 0, bool prefetch = true)
+        : client_(client), opts_(opts), max_pages_(max_pages), prefetch_(prefetch), started_(false),
+          pending_(false), pos_(0), pages_(0), items_(0), peak_buffered_(0), wait_us_(0) {
+        if (opts_.limit < 1) opts_.limit = 100;
+    }
+
+    // A prefetch in flight refers to this object, so it must not move
+    CustomerScan(const CustomerScan&) = delete;
+    CustomerScan& operator=(const CustomerScan&) = delete;
+
+    ~CustomerScan() {
+        // Don't leave a fetch running against a client that may go away; a
+        // deferred one (prefetch off) never started, and waiting would run it
+        if (pending_ && next_.wait_for(std::chrono::seconds(0)) != std::future_status::deferred) next_.wait();
+    }
+
+    iterator begin() {
+        if (started_) throw std::logic_error("CustomerScan is single-pass");
+        started_ = true;
+        fetch_after(opts_.starting_after);
+        return load_page() ? iterator(this) : iterator();
+    }
+
+    iterator end() { return iterator(); }
+
+    int pages() const { return pages_; }
+    uint64_t items() const { return items_; }
+    /** Most customers held at once (current page plus the one being prefetched). */
+    size_t peak_buffered() const { return peak_buffered_; }
+    /** Time the caller spent blocked waiting for a page. */
+    int64_t wait_us() const { return wait_us_; }
+
+private:
+    static int64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void fetch_after(const std::string& cursor) {
+        drip::ListCustomersOptions page = opts_;
+        page.starting_after = cursor;
+        drip::Client* client = &client_;
+        next_ = std::async(prefetch_ ? std::launch::async : std::launch::deferred, [client, page] {
+            return metered(Endpoint::LIST_CUSTOMERS, [&] { return client->listCustomers(page); });
+        });
+        pending_ = true;
+        cursor_ = cursor;
+    }
+
+    /** Swap in the fetched page and start fetching the one after it. False when the list is done. */
+    bool load_page() {
+        while (pending_) {
+            int64_t t0 = now_us();
+            pending_ = false;
+            drip::ListCustomersResponse r = next_.get();
+            wait_us_ += now_us() - t0;
+            ++pages_;
+            current_.swap(r.customers);
+            pos_ = 0;
+
+            bool full = current_.size() >= static_cast<size_t>(opts_.limit);
+            bool more = full && (max_pages_ == 0 || pages_ < max_pages_) &&
+                        !current_.back().id.empty() && current_.back().id != cursor_;
+            if (more) fetch_after(current_.back().id);
+            peak_buffered_ = std::max(peak_buffered_, current_.size() + (more ? static_cast<size_t>(opts_.limit) : 0));
+            if (!current_.empty()) {
+                ++items_;
+                return true;
+            }
+        }
+        current_.clear();
+        return false;
+    }
+
+    bool next_item() {
+        if (++pos_ < current_.size()) {
+            ++items_;
+            return true;
+        }
+        return load_page();
+    }
+
+    drip::Client& client_;
+    drip::ListCustomersOptions opts_;
+    int max_pages_;
+    bool prefetch_;
+    bool started_;
+    std::future<drip::ListCustomersResponse> next_;
+    bool pending_;
+    std::string cursor_;  // starting_after of the page in flight
+    std::vector<drip::Customer> current_;
+    size_t pos_;
+    int pages_;
+    uint64_t items_;
+    size_t peak_buffered_;
+    int64_t wait_us_;
+};
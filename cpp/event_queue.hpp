@@ -0,0 +1,229 @@
+/**
+ * Drip C++ SDK - Non-blocking emitEvent path for the testdrip harness
+ *
+ * BoundedMpscQueue is a fixed-capacity lock-free ring (Vyukov's bounded
+ * queue, single-consumer side): producers claim a slot with one CAS and
+ * publish it with a release store, so a push never takes a lock or makes a
+ * syscall. AsyncEventSender puts one on top of emitEvent(): training threads
+ * hand over EmitEventParams in well under a microsecond and a dedicated
+ * sender thread drains them in FIFO order, which preserves per-run ordering.
+ *
+ * Events without an idempotency_key get "<run_id>-aes<N>-<seq>" assigned on
+ * the sender thread before the first attempt, so a retried send is deduped
+ * server-side instead of being billed twice.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "client_metrics.hpp"
+
+template <typename T>
+class BoundedMpscQueue {
+public:
+    /** Capacity is rounded up to a power of two. */
+    explicit BoundedMpscQueue(size_t capacity)
+        : mask_(round_up(capacity) - 1), cells_(new Cell[mask_ + 1]),
+          enqueue_pos_(0), dequeue_pos_(0) {
+        for (size_t i = 0; i <= mask_; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+    BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+    /** Any thread. Returns false without blocking when the queue is full. */
+    bool try_push(T&& value) {
+        Cell* cell;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer thread only. Returns false when nothing is ready. */
+    bool try_pop(T& out) {
+        Cell& cell = cells_[dequeue_pos_ & mask_];
+        size_t seq = cell.seq.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(dequeue_pos_ + 1) < 0) return false;
+        out = std::move(cell.value);
+        cell.seq.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+        ++dequeue_pos_;
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    static size_t round_up(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueue_pos_;
+    alignas(64) size_t dequeue_pos_;
+};
+
+struct AsyncEventSenderStats {
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;  // emit() refused because the queue was full
+    uint64_t sent = 0;
+    uint64_t failed = 0;    // gave up after max_attempts
+    uint64_t retries = 0;
+    std::string last_error;
+};
+
+class AsyncEventSender {
+public:
+    explicit AsyncEventSender(drip::Client& client, size_t capacity = 4096, int max_attempts = 3)
+        : client_(client), queue_(capacity), max_attempts_(max_attempts),
+          accepted_(0), rejected_(0), completed_(0), stopping_(false), seq_(0),
+          key_tag_("-aes" + std::to_string(next_instance()) + "-") {
+        sender_ = std::thread(&AsyncEventSender::run, this);
+    }
+
+    ~AsyncEventSender() {
+        flush();
+        stopping_.store(true, std::memory_order_release);
+        sender_.join();
+    }
+
+    AsyncEventSender(const AsyncEventSender&) = delete;
+    AsyncEventSender& operator=(const AsyncEventSender&) = delete;
+
+    /** Hand an event to the sender thread. Never blocks; false if the queue is full. */
+    bool emit(drip::EmitEventParams&& params) {
+        if (!queue_.try_push(std::move(params))) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        accepted_.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    bool emit(const drip::EmitEventParams& params) {
+        drip::EmitEventParams copy(params);
+        return emit(std::move(copy));
+    }
+
+    /** Wait until every event accepted before this call has been sent or given up on. */
+    void flush() {
+        uint64_t target = accepted_.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(done_mtx_);
+        done_cv_.wait(lock, [&] { return completed_ >= target; });
+    }
+
+    AsyncEventSenderStats stats() const {
+        std::lock_guard<std::mutex> lock(done_mtx_);
+        AsyncEventSenderStats s = stats_;
+        s.accepted = accepted_.load(std::memory_order_relaxed);
+        s.rejected = rejected_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    static int next_instance() {
+        static std::atomic<int> n{0};
+        return ++n;
+    }
+
+    void run() {
+        int idle_us = 0;
+        drip::EmitEventParams params;
+        for (;;) {
+            if (!queue_.try_pop(params)) {
+                if (stopping_.load(std::memory_order_acquire)) return;
+                // Back off from spinning to sleeping so an idle sender costs nothing
+                if (idle_us == 0) {
+                    std::this_thread::yield();
+                    idle_us = 50;
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(idle_us));
+                    if (idle_us < 1000) idle_us *= 2;
+                }
+                continue;
+            }
+            idle_us = 0;
+
+            if (params.idempotency_key.empty()) {
+                params.idempotency_key = params.run_id + key_tag_ + std::to_string(seq_);
+            }
+            ++seq_;
+            send(params);
+        }
+    }
+
+    void send(const drip::EmitEventParams& params) {
+        std::string error;
+        int attempt = 0;
+        for (; attempt < max_attempts_; ++attempt) {
+            try {
+                metered(Endpoint::EMIT_EVENT, params, [&] { return client_.emitEvent(params); });
+                error.clear();
+                break;
+            } catch (const std::exception& e) {
+                error = e.what();
+                if (attempt + 1 < max_attempts_) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50 << attempt));
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(done_mtx_);
+        if (error.empty()) {
+            ++stats_.sent;
+        } else {
+            ++stats_.failed;
+            stats_.last_error = error;
+        }
+        stats_.retries += error.empty() ? attempt : attempt - 1;
+        ++completed_;
+        done_cv_.notify_all();
+    }
+
+    drip::Client& client_;
+    BoundedMpscQueue<drip::EmitEventParams> queue_;
+    int max_attempts_;
+    std::atomic<uint64_t> accepted_;
+    std::atomic<uint64_t> rejected_;
+
+    mutable std::mutex done_mtx_;
+    std::condition_variable done_cv_;
+    uint64_t completed_;
+    AsyncEventSenderStats stats_;
+
+    std::atomic<bool> stopping_;
+    uint64_t seq_;
+    std::string key_tag_;
+    std::thread sender_;
+};
@@ -0,0 +1,460 @@
+/**
+ * Drip C++ SDK - Fault injection for the testdrip harness
+ *
+ * The race tests, the benchmark and the ML scenarios normally measure the
+ * client and the live API together, and a slowdown or a burst of 429s
+ * can't be reproduced on demand. FaultInjector sits in front of every SDK
+ * call the harness makes (metered() routes calls through it when it is
+ * active) and degrades them the way a bad network or an overloaded API
+ * would:
+ *
+ *   latency=DIST   added delay per call (milliseconds):
+ *                    5                 fixed
+ *                    2-20              uniform
+ *                    normal:10:3       mean 10, sd 3 (clamped at 0)
+ *                    lognormal:5:0.8   median 5, sigma 0.8 (long tail)
+ *                    exp:10            exponential, mean 10
+ *   drop=P         fail a fraction P as a network error (status 0)
+ *   drop_ms=MS     how long a dropped call hangs first, like a timeout
+ *   429=P, 503=P   fail a fraction P with that status
+ *   bw=KBPS        cap one shared link at KBPS kbit/s; calls queue for it
+ *   req_bytes=N    request size charged for calls without a known body (512)
+ *   resp_bytes=N   response size charged to the link (512)
+ *   seed=N         make the sequence repeatable (0 = random)
+ *   offline        never call the SDK; answer with synthetic results
+ *
+ *   FaultOptions opts;
+ *   if (!opts.parse("latency=lognormal:20:0.5,429=0.02,offline", error)) ...
+ *   FaultInjector::instance().configure(opts);
+ *
+ * drip::Client's transport is private, so faults are injected around the
+ * call rather than inside it: an injected failure replaces the call (the
+ * request is never sent) with the DripError the SDK would have thrown, so
+ * Retrier, ClientGovernor and the spool react to it exactly as to a real
+ * one. Offline, the SDK isn't called at all and results are synthesized
+ * (mock_fill below), which isolates the harness's own overhead and its
+ * retry and back-pressure behaviour from server performance; the SDK's own
+ * serialization and parsing are then not measured.
+ *
+ * Each thread draws from its own generator, seeded from `seed` and the
+ * order in which threads first inject. A seeded single-threaded run is
+ * therefore repeatable; a multi-threaded one is statistically the same
+ * from run to run. Configure before starting load: configure() is not
+ * synchronized with calls in flight.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+/** A latency distribution in milliseconds. */
+struct LatencyDist {
+    enum Kind { NONE, FIXED, UNIFORM, NORMAL, LOGNORMAL, EXPONENTIAL };
+    Kind kind = NONE;
+    double a = 0;  // fixed value, uniform low, mean or median
+    double b = 0;  // uniform high, sd or sigma
+
+    /** One sample in microseconds, never negative. */
+    int64_t sample_us(std::mt19937_64& rng) const {
+        double ms = 0;
+        switch (kind) {
+            case NONE: return 0;
+            case FIXED: ms = a; break;
+            case UNIFORM: ms = std::uniform_real_distribution<double>(a, b)(rng); break;
+            case NORMAL: ms = std::normal_distribution<double>(a, b)(rng); break;
+            case LOGNORMAL: ms = std::lognormal_distribution<double>(std::log(a), b)(rng); break;
+            case EXPONENTIAL: ms = std::exponential_distribution<double>(1.0 / a)(rng); break;
+        }
+        return ms > 0 ? static_cast<int64_t>(ms * 1000.0) : 0;
+    }
+
+    bool parse(const std::string& text, std::string& error) {
+        size_t colon = text.find(':');
+        std::string name = text.substr(0, colon);
+        std::string args = colon == std::string::npos ? "" : text.substr(colon + 1);
+        double x = 0, y = 0;
+        if (name == "normal" || name == "lognormal") {
+            size_t sep = args.find(':');
+            if (sep == std::string::npos || !number(args.substr(0, sep), x) || !number(args.substr(sep + 1), y) ||
+                x < 0 || y <= 0 || (name == "lognormal" && x <= 0)) {
+                error = "latency=" + name + " needs MEAN:SD (lognormal: MEDIAN:SIGMA), both > 0";
+                return false;
+            }
+            kind = name == "normal" ? NORMAL : LOGNORMAL;
+        } else if (name == "exp") {
+            if (!number(args, x) || x <= 0) {
+                error = "latency=exp needs a mean > 0, e.g. exp:10";
+                return false;
+            }
+            kind = EXPONENTIAL;
+        } else if (colon == std::string::npos && text.find('-') != std::string::npos) {
+            size_t dash = text.find('-');
+            if (!number(text.substr(0, dash), x) || !number(text.substr(dash + 1), y) || x < 0 || y < x) {
+                error = "latency range needs LOW-HIGH with 0 <= LOW <= HIGH, e.g. 2-20";
+                return false;
+            }
+            kind = UNIFORM;
+        } else if (colon == std::string::npos && number(text, x) && x >= 0) {
+            kind = x > 0 ? FIXED : NONE;
+        } else {
+            error = "unknown latency distribution: " + text;
+            return false;
+        }
+        a = x;
+        b = y;
+        return true;
+    }
+
+    std::string describe() const {
+        std::ostringstream os;
+        switch (kind) {
+            case NONE: return "none";
+            case FIXED: os << a << "ms"; break;
+            case UNIFORM: os << a << "-" << b << "ms"; break;
+            case NORMAL: os << "normal(" << a << "ms, sd " << b << ")"; break;
+            case LOGNORMAL: os << "lognormal(median " << a << "ms, sigma " << b << ")"; break;
+            case EXPONENTIAL: os << "exp(mean " << a << "ms)"; break;
+        }
+        return os.str();
+    }
+
+    /** Whole-string strtod. */
+    static bool number(const std::string& s, double& out) {
+        if (s.empty()) return false;
+        char* end = nullptr;
+        out = std::strtod(s.c_str(), &end);
+        return end == s.c_str() + s.size() && std::isfinite(out);
+    }
+};
+
+struct FaultOptions {
+    LatencyDist latency;
+    double drop_rate = 0;          // Network errors (status 0)
+    int drop_ms = 0;               // Hang before a drop fails
+    double rate_limit_rate = 0;    // 429s
+    double unavailable_rate = 0;   // 503s
+    double bandwidth_kbps = 0;     // 0 = unlimited
+    size_t request_bytes = 512;    // For calls whose body the harness doesn't serialize
+    size_t response_bytes = 512;
+    uint64_t seed = 0;             // 0 = random
+    bool offline = false;
+
+    /** Whether any call could be delayed, failed or answered locally. */
+    bool any() const {
+        return latency.kind != LatencyDist::NONE || drop_rate > 0 || rate_limit_rate > 0 ||
+               unavailable_rate > 0 || bandwidth_kbps > 0 || offline;
+    }
+
+    /** Only the offline switch: for setup calls (connectivity, fixtures) that shouldn't be degraded. */
+    FaultOptions setup_only() const {
+        FaultOptions o;
+        o.offline = offline;
+        return o;
+    }
+
+    /** Apply a comma-separated spec (see the file comment) on top of the current values. */
+    bool parse(const std::string& spec, std::string& error) {
+        std::stringstream ss(spec);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (item.empty()) continue;
+            size_t eq = item.find('=');
+            std::string key = item.substr(0, eq);
+            std::string value = eq == std::string::npos ? "" : item.substr(eq + 1);
+            double v = 0;
+            if (key == "offline" && eq == std::string::npos) {
+                offline = true;
+            } else if (key == "latency") {
+                if (!latency.parse(value, error)) return false;
+            } else if (key == "drop" || key == "429" || key == "503") {
+                if (!LatencyDist::number(value, v) || v < 0 || v > 1) {
+                    error = key + "= needs a probability between 0 and 1";
+                    return false;
+                }
+                (key == "drop" ? drop_rate : key == "429" ? rate_limit_rate : unavailable_rate) = v;
+            } else if (key == "bw") {
+                if (!LatencyDist::number(value, v) || v < 0) {
+                    error = "bw= needs a rate in kbit/s";
+                    return false;
+                }
+                bandwidth_kbps = v;
+            } else if (key == "drop_ms" || key == "req_bytes" || key == "resp_bytes" || key == "seed") {
+                if (!LatencyDist::number(value, v) || v < 0 || v != std::floor(v)) {
+                    error = key + "= needs a whole number >= 0";
+                    return false;
+                }
+                if (key == "drop_ms") drop_ms = static_cast<int>(v);
+                else if (key == "req_bytes") request_bytes = static_cast<size_t>(v);
+                else if (key == "resp_bytes") response_bytes = static_cast<size_t>(v);
+                else seed = static_cast<uint64_t>(v);
+            } else {
+                error = "unknown fault: " + item;
+                return false;
+            }
+        }
+        if (drop_rate + rate_limit_rate + unavailable_rate > 1) {
+            error = "drop, 429 and 503 rates add up to more than 1";
+            return false;
+        }
+        return true;
+    }
+
+    std::string describe() const {
+        std::ostringstream os;
+        os << "latency " << latency.describe();
+        if (drop_rate > 0) os << ", drop " << drop_rate * 100 << "%" << (drop_ms > 0 ? " after " + std::to_string(drop_ms) + "ms" : "");
+        if (rate_limit_rate > 0) os << ", 429 " << rate_limit_rate * 100 << "%";
+        if (unavailable_rate > 0) os << ", 503 " << unavailable_rate * 100 << "%";
+        if (bandwidth_kbps > 0) os << ", link " << bandwidth_kbps << " kbit/s";
+        if (seed) os << ", seed " << seed;
+        if (offline) os << ", offline";
+        return os.str();
+    }
+};
+
+struct FaultStats {
+    uint64_t calls = 0;
+    uint64_t dropped = 0;
+    uint64_t rate_limited = 0;
+    uint64_t unavailable = 0;
+    uint64_t mocked = 0;          // Answered offline
+    int64_t latency_us = 0;       // Added delay, summed over calls
+    int64_t bandwidth_us = 0;     // Queueing and transfer time on the capped link
+};
+
+// Synthetic results for offline calls: plausible IDs, and the request echoed
+// back where the harness passes its body. Types without an overload stay
+// default-constructed.
+template <typename T>
+inline void mock_fill(T&, uint64_t) {}
+
+inline void mock_fill(drip::HealthResult& r, uint64_t) {
+    r.ok = true;
+    r.status = "healthy";
+    r.latency_ms = 0;
+}
+
+inline void mock_fill(drip::Customer& r, uint64_t n) { r.id = "mock_cus_" + std::to_string(n); }
+inline void mock_fill(drip::RunResult& r, uint64_t n) { r.id = "mock_run_" + std::to_string(n); }
+inline void mock_fill(drip::EventResult& r, uint64_t n) { r.id = "mock_evt_" + std::to_string(n); }
+
+inline void mock_fill(drip::TrackUsageResult& r, uint64_t n) {
+    r.success = true;
+    r.usage_event_id = "mock_usage_" + std::to_string(n);
+}
+
+inline void mock_fill(drip::RecordRunResult& r, uint64_t n) {
+    r.run.id = "mock_run_" + std::to_string(n);
+    r.run.workflow_id = "mock_workflow";
+}
+
+template <typename T, typename Body>
+inline void mock_fill(T& r, uint64_t n, const Body&) { mock_fill(r, n); }
+
+inline void mock_fill(drip::TrackUsageResult& r, uint64_t n, const drip::TrackUsageParams& p) {
+    mock_fill(r, n);
+    if (!p.idempotency_key.empty()) r.usage_event_id = "mock_usage_" + p.idempotency_key;  // Same key, same event
+    r.customer_id = p.customer_id;
+    r.quantity = p.quantity;
+}
+
+inline void mock_fill(drip::RecordRunResult& r, uint64_t n, const drip::RecordRunParams& p) {
+    mock_fill(r, n);
+    r.events.created = static_cast<int>(p.events.size());
+}
+
+inline void mock_fill(drip::EventResult& r, uint64_t n, const drip::EmitEventParams& p) {
+    mock_fill(r, n);
+    if (!p.idempotency_key.empty()) r.id = "mock_evt_" + p.idempotency_key;
+    r.run_id = p.run_id;
+    r.event_type = p.event_type;
+    r.quantity = p.quantity;
+}
+
+class FaultInjector {
+public:
+    static FaultInjector& instance() {
+        static FaultInjector f;
+        return f;
+    }
+
+    /** Replace the fault set; injection is active while any fault (or an outage) is set. */
+    void configure(const FaultOptions& opts) {
+        opts_ = opts;
+        base_seed_ = opts.seed ? opts.seed : std::random_device()();
+        epoch_.fetch_add(1, std::memory_order_relaxed);
+        threads_.store(0, std::memory_order_relaxed);
+        link_free_us_.store(0, std::memory_order_relaxed);
+        active_.store(opts.any() || outage(), std::memory_order_release);
+    }
+
+    /** Fail every call as a network error until cleared, like a full outage. */
+    void set_outage(bool on) {
+        outage_.store(on, std::memory_order_relaxed);
+        active_.store(on || opts_.any(), std::memory_order_release);
+    }
+
+    bool active() const { return active_.load(std::memory_order_relaxed); }
+    bool offline() const { return active() && opts_.offline; }
+    bool outage() const { return outage_.load(std::memory_order_relaxed); }
+    /** Callers only need to size request bodies when the link is capped. */
+    bool limits_bandwidth() const { return opts_.bandwidth_kbps > 0; }
+    const FaultOptions& options() const { return opts_; }
+
+    /** Inject, then run fn() (or answer it offline). `bytes_sent` = 0 charges req_bytes. */
+    template <typename F>
+    auto call(size_t bytes_sent, F& fn) -> decltype(fn()) {
+        inject(bytes_sent);
+        if (!opts_.offline) return fn();
+        decltype(fn()) r;
+        mock_fill(r, next_mock());
+        return r;
+    }
+
+    template <typename Body, typename F>
+    auto call(size_t bytes_sent, const Body& body, F& fn) -> decltype(fn()) {
+        inject(bytes_sent);
+        if (!opts_.offline) return fn();
+        decltype(fn()) r;
+        mock_fill(r, next_mock(), body);
+        return r;
+    }
+
+    FaultStats stats() const {
+        FaultStats s;
+        s.calls = calls_.load();
+        s.dropped = dropped_.load();
+        s.rate_limited = rate_limited_.load();
+        s.unavailable = unavailable_.load();
+        s.mocked = mocked_.load();
+        s.latency_us = latency_us_.load();
+        s.bandwidth_us = bandwidth_us_.load();
+        return s;
+    }
+
+    /** One line: the fault set and what it has done so far. */
+    void write_summary(std::ostream& os) const {
+        FaultStats s = stats();
+        os << "Faults (" << opts_.describe() << "): " << s.calls << " calls";
+        if (s.dropped) os << ", " << s.dropped << " dropped";
+        if (s.rate_limited) os << ", " << s.rate_limited << " x 429";
+        if (s.unavailable) os << ", " << s.unavailable << " x 503";
+        if (s.mocked) os << ", " << s.mocked << " answered offline";
+        os << std::fixed;
+        os.precision(1);
+        if (s.latency_us) os << ", +" << s.latency_us / 1000.0 << "ms latency";
+        if (s.bandwidth_us) os << ", " << s.bandwidth_us / 1000.0 << "ms on the link";
+        os.unsetf(std::ios::floatfield);
+        os.precision(6);
+    }
+
+private:
+    FaultInjector()
+        : active_(false), outage_(false), epoch_(0), threads_(0), base_seed_(0), link_free_us_(0),
+          mock_seq_(0), calls_(0), dropped_(0), rate_limited_(0), unavailable_(0), mocked_(0),
+          latency_us_(0), bandwidth_us_(0) {}
+
+    static int64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void sleep_us(int64_t us) {
+        if (us > 0) std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+
+    std::mt19937_64& rng() {
+        struct Local {
+            uint64_t epoch = 0;
+            std::mt19937_64 rng;
+        };
+        static thread_local Local local;
+        uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+        if (local.epoch != epoch) {
+            local.epoch = epoch;
+            local.rng.seed(base_seed_ + threads_.fetch_add(1, std::memory_order_relaxed));
+        }
+        return local.rng;
+    }
+
+    uint64_t next_mock() {
+        mocked_.fetch_add(1, std::memory_order_relaxed);
+        return mock_seq_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    /** Reserve the link for `bytes` after whoever is ahead; returns when they are through. */
+    void transfer(size_t bytes) {
+        int64_t tx_us = static_cast<int64_t>(bytes * 8000.0 / opts_.bandwidth_kbps);
+        int64_t now = now_us();
+        int64_t free_at = link_free_us_.load(std::memory_order_relaxed);
+        int64_t done;
+        do {
+            done = std::max(now, free_at) + tx_us;
+        } while (!link_free_us_.compare_exchange_weak(free_at, done, std::memory_order_relaxed));
+        sleep_us(done - now);
+        bandwidth_us_.fetch_add(done - now, std::memory_order_relaxed);
+    }
+
+    void inject(size_t bytes_sent) {
+        calls_.fetch_add(1, std::memory_order_relaxed);
+        if (outage()) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            throw drip::DripError("injected fault: connection refused (outage)", 0, "NETWORK");
+        }
+        std::mt19937_64& r = rng();
+        int64_t delay = opts_.latency.sample_us(r);
+        if (delay > 0) {
+            sleep_us(delay);
+            latency_us_.fetch_add(delay, std::memory_order_relaxed);
+        }
+        if (opts_.bandwidth_kbps > 0) {
+            transfer((bytes_sent ? bytes_sent : opts_.request_bytes) + opts_.response_bytes);
+        }
+        if (opts_.drop_rate <= 0 && opts_.rate_limit_rate <= 0 && opts_.unavailable_rate <= 0) return;
+
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(r);
+        if (u < opts_.drop_rate) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            sleep_us(static_cast<int64_t>(opts_.drop_ms) * 1000);
+            throw drip::DripError("injected fault: connection dropped", 0, "NETWORK");
+        }
+        u -= opts_.drop_rate;
+        if (u < opts_.rate_limit_rate) {
+            rate_limited_.fetch_add(1, std::memory_order_relaxed);
+            throw drip::DripError("injected fault: rate limit exceeded", 429, "RATE_LIMITED");
+        }
+        u -= opts_.rate_limit_rate;
+        if (u < opts_.unavailable_rate) {
+            unavailable_.fetch_add(1, std::memory_order_relaxed);
+            throw drip::DripError("injected fault: service unavailable", 503, "SERVICE_UNAVAILABLE");
+        }
+    }
+
+    FaultOptions opts_;
+    std::atomic<bool> active_;
+    std::atomic<bool> outage_;
+    std::atomic<uint64_t> epoch_;    // Bumped by configure() so threads reseed
+    std::atomic<uint64_t> threads_;  // Threads seeded this epoch
+    uint64_t base_seed_;
+    std::atomic<int64_t> link_free_us_;  // When the capped link is next idle
+    std::atomic<uint64_t> mock_seq_;
+    std::atomic<uint64_t> calls_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> rate_limited_;
+    std::atomic<uint64_t> unavailable_;
+    std::atomic<uint64_t> mocked_;
+    std::atomic<int64_t> latency_us_;
+    std::atomic<int64_t> bandwidth_us_;
+};
@@ -0,0 +1,152 @@
+/**
+ * Drip C++ SDK - Hedged reads for the testdrip harness
+ *
+ * Hedger runs idempotent reads on an AsyncClient and, if the first attempt
+ * hasn't answered within the running p95 of attempt latency, sends a second
+ * one and takes whichever answers first. Hedging after p95 costs roughly 5%
+ * extra reads and cuts the tail caused by one slow connection or server.
+ * The slower attempt still completes on the pool; its result is dropped.
+ *
+ * Each attempt goes through the AsyncClient's Retrier, when it has one, so a
+ * hedged read retries exactly like the plain *Async reads it is compared
+ * with. Failures are not hedged: if the first attempt fails (after its
+ * retries) before the hedge delay, its error is rethrown. A read fails only
+ * when every attempt it sent has failed.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "async_client.hpp"
+#include "latency_histogram.hpp"
+#include "retry_policy.hpp"
+
+struct HedgeOptions {
+    int64_t initial_delay_us = 10000;  // Until `warmup` attempts have been timed
+    int64_t min_delay_us = 1000;
+    double delay_quantile = 0.95;
+    uint64_t warmup = 20;
+};
+
+struct HedgeStats {
+    uint64_t reads;
+    uint64_t hedges;      // Reads that sent a second attempt
+    uint64_t hedge_wins;  // ...and got their answer from it
+};
+
+class Hedger {
+public:
+    /** Attempts run on `pool`, which must outlive any read still in flight. */
+    explicit Hedger(AsyncClient& pool, const HedgeOptions& opts = HedgeOptions())
+        : pool_(pool), opts_(opts), shared_(std::make_shared<Shared>()) {}
+
+    /** Run fn(client), hedging once after the current delay; rethrows if every attempt fails. */
+    template <typename F>
+    auto read(F fn) -> decltype(fn(std::declval<drip::Client&>())) {
+        typedef decltype(fn(std::declval<drip::Client&>())) R;
+        struct Race {
+            std::mutex mtx;
+            std::condition_variable cv;
+            int launched = 0;
+            int failed = 0;
+            int winner = -1;
+            std::unique_ptr<R> value;
+            std::exception_ptr error;
+        };
+        std::shared_ptr<Race> race = std::make_shared<Race>();
+        std::shared_ptr<Shared> shared = shared_;
+
+        auto launch = [&](int which) {
+            {
+                std::lock_guard<std::mutex> lock(race->mtx);
+                ++race->launched;
+            }
+            Retrier* retrier = pool_.retrier();
+            pool_.callAsync([race, shared, fn, which, retrier](drip::Client& c) mutable {
+                auto t0 = std::chrono::steady_clock::now();
+                std::unique_ptr<R> value;
+                std::exception_ptr error;
+                try {
+                    value.reset(new R(retrier ? retrier->call([&] { return fn(c); }) : fn(c)));
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                shared->record(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - t0).count());
+                {
+                    std::lock_guard<std::mutex> lock(race->mtx);
+                    if (value && race->winner < 0) {
+                        race->winner = which;
+                        race->value = std::move(value);
+                    } else if (!value) {
+                        ++race->failed;
+                        race->error = error;
+                    }
+                }
+                race->cv.notify_all();
+            });
+        };
+
+        std::chrono::microseconds delay(hedge_delay_us());
+        launch(0);
+        std::unique_lock<std::mutex> lock(race->mtx);
+        auto settled = [&] { return race->winner >= 0 || race->failed == race->launched; };
+        bool hedged = false;
+        if (!race->cv.wait_for(lock, delay, settled)) {
+            lock.unlock();
+            launch(1);
+            hedged = true;
+            lock.lock();
+            race->cv.wait(lock, settled);
+        }
+        shared_->count(hedged, race->winner == 1);
+        if (race->winner < 0) std::rethrow_exception(race->error);
+        return std::move(*race->value);
+    }
+
+    /** Delay before the second attempt: p95 of timed attempts, or the initial delay while warming up. */
+    int64_t hedge_delay_us() const {
+        std::lock_guard<std::mutex> lock(shared_->mtx);
+        if (shared_->latency.count() < opts_.warmup) return opts_.initial_delay_us;
+        return std::max(opts_.min_delay_us, shared_->latency.percentile(opts_.delay_quantile));
+    }
+
+    HedgeStats stats() const {
+        std::lock_guard<std::mutex> lock(shared_->mtx);
+        return shared_->stats;
+    }
+
+private:
+    // Outlives the Hedger if a losing attempt is still queued on the pool.
+    struct Shared {
+        std::mutex mtx;
+        LatencyHistogram latency;
+        HedgeStats stats{0, 0, 0};
+
+        void record(int64_t us) {
+            std::lock_guard<std::mutex> lock(mtx);
+            latency.record(us);
+        }
+
+        void count(bool hedged, bool hedge_won) {
+            std::lock_guard<std::mutex> lock(mtx);
+            ++stats.reads;
+            if (hedged) ++stats.hedges;
+            if (hedge_won) ++stats.hedge_wins;
+        }
+    };
+
+    AsyncClient& pool_;
+    HedgeOptions opts_;
+    std::shared_ptr<Shared> shared_;
+};
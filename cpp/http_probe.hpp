@@ -0,0 +1,257 @@
+/**
+ * Drip C++ SDK - Transport-level probe for the testdrip harness
+ *
+ * The SDK does not expose its curl handles, so connection setup cannot be
+ * counted through drip::Client. HttpProbe issues GETs against the same API
+ * host directly with libcurl and reads back what curl measured: how many new
+ * connections each request opened and how long it took. With
+ * reuse_connections the probe keeps one easy handle (keep-alive) plus a share
+ * handle for the DNS cache and TLS sessions; without it every request gets a
+ * fresh handle, paying DNS + TCP + TLS each time.
+ *
+ * Each result carries curl's phase breakdown (DNS, connect, TLS, server
+ * wait, transfer), which is how a slow ping is split into network setup vs
+ * time spent in the API; PhaseHistograms aggregates them over many probes.
+ *
+ * probe_concurrent() puts many requests in flight at once on a curl multi
+ * handle, either over HTTP/2 (multiplexed onto as few connections as curl can
+ * manage) or HTTP/1.1 (one request per connection, capped at
+ * max_connections), to show what a multiplexed transport would buy.
+ */
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.hpp"
+
+namespace probe_detail {
+
+inline void global_init() {
+    // Function-local static: runs once, thread-safe under C++11
+    static const CURLcode init = curl_global_init(CURL_GLOBAL_DEFAULT);
+    (void)init;
+}
+
+inline size_t discard(char*, size_t size, size_t nmemb, void*) { return size * nmemb; }
+
+}  // namespace probe_detail
+
+/** Time spent in each phase of one request, in microseconds (0 when the phase was skipped). */
+struct RequestPhases {
+    int64_t dns_us = 0;
+    int64_t connect_us = 0;   // TCP handshake
+    int64_t tls_us = 0;       // TLS handshake
+    int64_t server_us = 0;    // Request sent -> first response byte (time to first byte minus setup)
+    int64_t transfer_us = 0;  // First -> last response byte
+    int64_t total_us = 0;
+};
+
+/** Phase deltas from curl's cumulative timers for the transfer `h` just finished. */
+inline RequestPhases read_phases(CURL* h) {
+    curl_off_t dns = 0, connect = 0, app = 0, pre = 0, start = 0, total = 0;
+    curl_easy_getinfo(h, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+    curl_easy_getinfo(h, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(h, CURLINFO_APPCONNECT_TIME_T, &app);
+    curl_easy_getinfo(h, CURLINFO_PRETRANSFER_TIME_T, &pre);
+    curl_easy_getinfo(h, CURLINFO_STARTTRANSFER_TIME_T, &start);
+    curl_easy_getinfo(h, CURLINFO_TOTAL_TIME_T, &total);
+    RequestPhases p;
+    p.dns_us = dns;
+    p.connect_us = connect > dns ? connect - dns : 0;
+    p.tls_us = app > connect ? app - connect : 0;  // APPCONNECT stays 0 on reused or plain-HTTP connections
+    p.server_us = start > pre ? start - pre : 0;
+    p.transfer_us = total > start ? total - start : 0;
+    p.total_us = total;
+    return p;
+}
+
+struct PhaseHistograms {
+    LatencyHistogram dns, connect, tls, server, transfer, total;
+
+    void record(const RequestPhases& p) {
+        dns.record(p.dns_us);
+        connect.record(p.connect_us);
+        tls.record(p.tls_us);
+        server.record(p.server_us);
+        transfer.record(p.transfer_us);
+        total.record(p.total_us);
+    }
+
+    void merge(const PhaseHistograms& o) {
+        dns.merge(o.dns);
+        connect.merge(o.connect);
+        tls.merge(o.tls);
+        server.merge(o.server);
+        transfer.merge(o.transfer);
+        total.merge(o.total);
+    }
+};
+
+struct ProbeResult {
+    bool ok = false;
+    long http_status = 0;
+    long new_connections = 0;  // Connections curl had to open for this request
+    int64_t total_us = 0;
+    RequestPhases phases;
+    std::string error;
+};
+
+class HttpProbe {
+public:
+    explicit HttpProbe(bool reuse_connections, const std::string& api_key = "")
+        : reuse_(reuse_connections), easy_(nullptr), share_(nullptr), headers_(nullptr) {
+        probe_detail::global_init();
+        if (!api_key.empty()) {
+            std::string auth = "Authorization: Bearer " + api_key;
+            headers_ = curl_slist_append(headers_, auth.c_str());
+        }
+        if (reuse_) {
+            share_ = curl_share_init();
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+            easy_ = curl_easy_init();
+        }
+    }
+
+    ~HttpProbe() {
+        if (easy_) curl_easy_cleanup(easy_);
+        if (share_) curl_share_cleanup(share_);
+        if (headers_) curl_slist_free_all(headers_);
+    }
+
+    HttpProbe(const HttpProbe&) = delete;
+    HttpProbe& operator=(const HttpProbe&) = delete;
+
+    ProbeResult get(const std::string& url) {
+        CURL* h = reuse_ ? easy_ : curl_easy_init();
+        ProbeResult r;
+        if (!h) {
+            r.error = "curl_easy_init failed";
+            return r;
+        }
+        curl_easy_setopt(h, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, &probe_detail::discard);
+        curl_easy_setopt(h, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(h, CURLOPT_TIMEOUT_MS, 30000L);
+        if (headers_) curl_easy_setopt(h, CURLOPT_HTTPHEADER, headers_);
+        if (share_) curl_easy_setopt(h, CURLOPT_SHARE, share_);
+
+        CURLcode rc = curl_easy_perform(h);
+        if (rc == CURLE_OK) {
+            curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &r.http_status);
+            curl_easy_getinfo(h, CURLINFO_NUM_CONNECTS, &r.new_connections);
+            r.phases = read_phases(h);
+            r.total_us = r.phases.total_us;
+            r.ok = r.http_status >= 200 && r.http_status < 300;
+            if (!r.ok) r.error = "HTTP " + std::to_string(r.http_status);
+        } else {
+            r.error = curl_easy_strerror(rc);
+        }
+
+        if (!reuse_) curl_easy_cleanup(h);
+        return r;
+    }
+
+private:
+    bool reuse_;
+    CURL* easy_;
+    CURLSH* share_;
+    struct curl_slist* headers_;
+};
+
+struct ConcurrentProbeResult {
+    int ok = 0;
+    int failed = 0;
+    long connections = 0;    // Connections opened across all requests
+    long http_version = 0;   // CURL_HTTP_VERSION_* negotiated by the last completed request
+    int64_t wall_us = 0;
+    LatencyHistogram latency;
+    std::string error;
+};
+
+/**
+ * Issue `in_flight` GETs to `url` concurrently from one thread. With http2,
+ * requests wait for an existing connection to be multiplexed onto
+ * (CURLOPT_PIPEWAIT) instead of opening their own; HTTP/1.1 requests open up
+ * to max_connections connections and queue behind them.
+ */
+inline ConcurrentProbeResult probe_concurrent(const std::string& url, const std::string& api_key,
+                                              int in_flight, bool http2, long max_connections) {
+    probe_detail::global_init();
+    ConcurrentProbeResult r;
+
+    struct curl_slist* headers = nullptr;
+    if (!api_key.empty()) {
+        std::string auth = "Authorization: Bearer " + api_key;
+        headers = curl_slist_append(headers, auth.c_str());
+    }
+
+    CURLM* multi = curl_multi_init();
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, http2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_connections);
+
+    std::vector<CURL*> handles;
+    for (int i = 0; i < in_flight; ++i) {
+        CURL* h = curl_easy_init();
+        if (!h) break;
+        curl_easy_setopt(h, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, &probe_detail::discard);
+        curl_easy_setopt(h, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(h, CURLOPT_TIMEOUT_MS, 60000L);
+        curl_easy_setopt(h, CURLOPT_HTTP_VERSION, http2 ? CURL_HTTP_VERSION_2TLS : CURL_HTTP_VERSION_1_1);
+        if (http2) curl_easy_setopt(h, CURLOPT_PIPEWAIT, 1L);
+        if (headers) curl_easy_setopt(h, CURLOPT_HTTPHEADER, headers);
+        curl_multi_add_handle(multi, h);
+        handles.push_back(h);
+    }
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    int running = 0;
+    do {
+        CURLMcode mc = curl_multi_perform(multi, &running);
+        if (mc != CURLM_OK) {
+            r.error = curl_multi_strerror(mc);
+            break;
+        }
+        if (running) curl_multi_wait(multi, nullptr, 0, 100, nullptr);
+
+        CURLMsg* msg;
+        int left = 0;
+        while ((msg = curl_multi_info_read(multi, &left)) != nullptr) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            CURL* h = msg->easy_handle;
+            long status = 0, connects = 0;
+            curl_off_t total = 0;
+            curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &status);
+            curl_easy_getinfo(h, CURLINFO_NUM_CONNECTS, &connects);
+            curl_easy_getinfo(h, CURLINFO_TOTAL_TIME_T, &total);
+            curl_easy_getinfo(h, CURLINFO_HTTP_VERSION, &r.http_version);
+            r.connections += connects;
+            if (msg->data.result == CURLE_OK && status >= 200 && status < 300) {
+                ++r.ok;
+                r.latency.record(static_cast<int64_t>(total));
+            } else {
+                ++r.failed;
+                r.error = msg->data.result != CURLE_OK ? curl_easy_strerror(msg->data.result)
+                                                       : "HTTP " + std::to_string(status);
+            }
+        }
+    } while (running);
+
+    r.wall_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+
+    for (size_t i = 0; i < handles.size(); ++i) {
+        curl_multi_remove_handle(multi, handles[i]);
+        curl_easy_cleanup(handles[i]);
+    }
+    curl_multi_cleanup(multi);
+    if (headers) curl_slist_free_all(headers);
+    return r;
+}
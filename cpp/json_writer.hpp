@@ -0,0 +1,176 @@
+/**
+ * Drip C++ SDK - Direct-to-buffer JSON for metering request bodies
+ *
+ * Building a JSON DOM for every trackUsage()/emitEvent() body costs a node
+ * allocation per field and per metadata entry before a single byte is
+ * written. JsonWriter appends straight into one std::string instead: keys are
+ * literals, values are escaped in place and numbers are formatted on the
+ * stack. clear() keeps the buffer's capacity, so a writer that is reused
+ * (thread_json_writer() hands out one per thread) stops allocating once it
+ * has grown to fit the largest body it has seen.
+ *
+ * Field names follow the API's camelCase request bodies.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+class JsonWriter {
+public:
+    explicit JsonWriter(size_t reserve = 512) : first_(true) { buf_.reserve(reserve); }
+
+    /** Start a new document, keeping the buffer's capacity. */
+    void clear() {
+        buf_.clear();
+        first_ = true;
+    }
+
+    const std::string& str() const { return buf_; }
+    size_t capacity() const { return buf_.capacity(); }
+
+    void begin_object() {
+        buf_ += '{';
+        first_ = true;
+    }
+
+    void end_object() {
+        buf_ += '}';
+        first_ = false;
+    }
+
+    /** Key for the next value; `key` must not need escaping (it is a literal). */
+    void key(const char* key) {
+        if (!first_) buf_ += ',';
+        first_ = false;
+        buf_ += '"';
+        buf_.append(key);
+        buf_ += '"';
+        buf_ += ':';
+    }
+
+    void value(const std::string& s) { append_escaped(s.data(), s.size()); }
+
+    void value(double v) {
+        if (!std::isfinite(v)) {
+            buf_.append("null");
+            return;
+        }
+        // Shortest of %.15g / %.17g that reads back as the same double
+        char num[32];
+        int n = std::snprintf(num, sizeof(num), "%.15g", v);
+        if (std::strtod(num, nullptr) != v) n = std::snprintf(num, sizeof(num), "%.17g", v);
+        buf_.append(num, static_cast<size_t>(n));
+    }
+
+    void value(const std::map<std::string, std::string>& m) {
+        buf_ += '{';
+        bool first = true;
+        for (std::map<std::string, std::string>::const_iterator it = m.begin(); it != m.end(); ++it) {
+            if (!first) buf_ += ',';
+            first = false;
+            append_escaped(it->first.data(), it->first.size());
+            buf_ += ':';
+            append_escaped(it->second.data(), it->second.size());
+        }
+        buf_ += '}';
+        first_ = false;
+    }
+
+    /** key + string value, skipped when the value is empty (optional fields). */
+    void optional(const char* k, const std::string& s) {
+        if (s.empty()) return;
+        key(k);
+        value(s);
+    }
+
+    /** Raw, already-valid JSON (e.g. a pre-escaped fragment). */
+    void raw(const char* data, size_t len) {
+        buf_.append(data, len);
+        first_ = false;
+    }
+
+private:
+    void append_escaped(const char* s, size_t n) {
+        static const char hex[] = "0123456789abcdef";
+        buf_ += '"';
+        size_t run = 0;  // Start of the current stretch that needs no escaping
+        for (size_t i = 0; i < n; ++i) {
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            buf_.append(s + run, i - run);
+            run = i + 1;
+            switch (c) {
+                case '"':  buf_.append("\\\""); break;
+                case '\\': buf_.append("\\\\"); break;
+                case '\n': buf_.append("\\n"); break;
+                case '\r': buf_.append("\\r"); break;
+                case '\t': buf_.append("\\t"); break;
+                default: {
+                    const char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                    buf_.append(esc, 6);
+                }
+            }
+        }
+        buf_.append(s + run, n - run);
+        buf_ += '"';
+        first_ = false;
+    }
+
+    std::string buf_;
+    bool first_;
+};
+
+/** This thread's reusable writer, already cleared. */
+inline JsonWriter& thread_json_writer() {
+    static thread_local JsonWriter writer;
+    writer.clear();
+    return writer;
+}
+
+inline void write_json(JsonWriter& w, const drip::TrackUsageParams& p) {
+    w.begin_object();
+    w.key("customerId");
+    w.value(p.customer_id);
+    w.key("meter");
+    w.value(p.meter);
+    w.key("quantity");
+    w.value(p.quantity);
+    w.optional("units", p.units);
+    w.optional("description", p.description);
+    w.optional("idempotencyKey", p.idempotency_key);
+    if (!p.metadata.empty()) {
+        w.key("metadata");
+        w.value(p.metadata);
+    }
+    w.end_object();
+}
+
+inline void write_json(JsonWriter& w, const drip::EmitEventParams& p) {
+    w.begin_object();
+    w.key("runId");
+    w.value(p.run_id);
+    w.key("eventType");
+    w.value(p.event_type);
+    w.key("quantity");
+    w.value(p.quantity);
+    w.optional("units", p.units);
+    w.optional("description", p.description);
+    if (p.cost_units != 0) {
+        w.key("costUnits");
+        w.value(p.cost_units);
+    }
+    w.optional("idempotencyKey", p.idempotency_key);
+    if (!p.metadata.empty()) {
+        w.key("metadata");
+        w.value(p.metadata);
+    }
+    w.end_object();
+}
@@ -0,0 +1,153 @@
+/**
+ * Drip C++ SDK - Latency histogram for the testdrip harness
+ *
+ * HDR-style log-linear histogram of microsecond latencies. Values below
+ * 2^SUB_BITS are recorded exactly; above that, every power-of-two range is
+ * split into 2^(SUB_BITS-1) equal sub-buckets, so the relative error of any
+ * reported percentile stays under 1/64 (~1.6%) across the whole range.
+ *
+ * Recording is a couple of shifts and an increment with no allocation or
+ * locking. Histograms are not thread-safe: give each worker thread its own
+ * and merge() them once the workers have joined.
+ *
+ * serialize() writes a sparse one-line text form ("total min max sum" then
+ * "index:count" for each non-empty bucket) that deserialize() reads back
+ * exactly, so histograms from other processes merge like local ones.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 7;
+    static const int MAX_BITS = 40;  // ~12.7 days in microseconds
+
+    LatencyHistogram()
+        : counts_(bucket_count(), 0), total_(0), min_(0), max_(0), sum_(0) {}
+
+    void record(int64_t value_us) {
+        if (value_us < 0) value_us = 0;
+        const int64_t cap = (static_cast<int64_t>(1) << MAX_BITS) - 1;
+        if (value_us > cap) value_us = cap;
+        ++counts_[index_of(value_us)];
+        if (total_ == 0 || value_us < min_) min_ = value_us;
+        if (value_us > max_) max_ = value_us;
+        sum_ += value_us;
+        ++total_;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        if (other.total_ == 0) return;
+        for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+        if (total_ == 0 || other.min_ < min_) min_ = other.min_;
+        if (other.max_ > max_) max_ = other.max_;
+        sum_ += other.sum_;
+        total_ += other.total_;
+    }
+
+    void reset() {
+        counts_.assign(counts_.size(), 0);
+        total_ = min_ = max_ = sum_ = 0;
+    }
+
+    /** Latency at quantile q (0.0 - 1.0), as the upper edge of its bucket. */
+    int64_t percentile(double q) const {
+        if (total_ == 0) return 0;
+        if (q <= 0.0) return min_;
+        if (q >= 1.0) return max_;
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total_) + 0.5);
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                int64_t v = upper_edge(static_cast<int>(i));
+                return v > max_ ? max_ : v;
+            }
+        }
+        return max_;
+    }
+
+    std::string serialize() const {
+        std::ostringstream out;
+        out << total_ << " " << min_ << " " << max_ << " " << sum_;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            if (counts_[i]) out << " " << i << ":" << counts_[i];
+        }
+        return out.str();
+    }
+
+    /** Replace this histogram with a serialize()d one; false (and reset) if malformed. */
+    bool deserialize(const std::string& text) {
+        reset();
+        std::istringstream in(text);
+        uint64_t total = 0;
+        if (!(in >> total >> min_ >> max_ >> sum_)) {
+            reset();
+            return false;
+        }
+        uint64_t seen = 0;
+        std::string bucket;
+        while (in >> bucket) {
+            size_t colon = bucket.find(':');
+            if (colon == std::string::npos) break;
+            size_t idx = std::strtoull(bucket.c_str(), nullptr, 10);
+            if (idx >= counts_.size()) break;
+            uint64_t n = std::strtoull(bucket.c_str() + colon + 1, nullptr, 10);
+            counts_[idx] += n;
+            seen += n;
+        }
+        if (seen != total || !in.eof()) {
+            reset();
+            return false;
+        }
+        total_ = total;
+        return true;
+    }
+
+    uint64_t count() const { return total_; }
+    int64_t min() const { return min_; }
+    int64_t max() const { return max_; }
+    double mean() const { return total_ ? static_cast<double>(sum_) / total_ : 0.0; }
+
+private:
+    static int bucket_count() {
+        return (1 << SUB_BITS) + (MAX_BITS - SUB_BITS) * (1 << (SUB_BITS - 1));
+    }
+
+    static int msb(uint64_t v) {
+        int n = 0;
+        while (v >>= 1) ++n;
+        return n;
+    }
+
+    static int index_of(int64_t v) {
+        const int64_t exact = static_cast<int64_t>(1) << SUB_BITS;
+        if (v < exact) return static_cast<int>(v);
+        const int half = 1 << (SUB_BITS - 1);
+        int shift = msb(static_cast<uint64_t>(v)) - SUB_BITS + 1;
+        int sub = static_cast<int>(v >> shift);  // in [half, 2*half)
+        return (1 << SUB_BITS) + (shift - 1) * half + (sub - half);
+    }
+
+    static int64_t upper_edge(int idx) {
+        const int exact = 1 << SUB_BITS;
+        if (idx < exact) return idx;
+        const int half = 1 << (SUB_BITS - 1);
+        int shift = (idx - exact) / half + 1;
+        int64_t sub = (idx - exact) % half + half;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_;
+    int64_t min_;
+    int64_t max_;
+    int64_t sum_;
+};
@@ -0,0 +1,260 @@
+/**
+ * Drip C++ SDK - Line-oriented TCP sockets for the testdrip harness
+ *
+ * Just enough networking for the distributed bench: a coordinator listens,
+ * workers connect, and both sides exchange newline-terminated text lines.
+ * LineSocket buffers reads so read_line() returns one line at a time, and
+ * every call blocks (with an optional receive timeout); there is no
+ * non-blocking mode because each side only ever waits on one peer per
+ * thread. Errors come back as false / invalid sockets with error() set,
+ * matching how HttpProbe reports transport failures.
+ *
+ * POSIX sockets, with the Winsock equivalents on _WIN32 (link ws2_32).
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace line_socket_detail {
+
+#if defined(_WIN32)
+typedef SOCKET Handle;
+static const Handle INVALID = INVALID_SOCKET;
+inline void close_handle(Handle h) { closesocket(h); }
+inline void net_init() {
+    static const bool once = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    (void)once;
+}
+#else
+typedef int Handle;
+static const Handle INVALID = -1;
+inline void close_handle(Handle h) { ::close(h); }
+inline void net_init() {}
+#endif
+
+// A peer that hangs up mid-send must fail the send, not raise SIGPIPE and
+// kill the process: MSG_NOSIGNAL where it exists, SO_NOSIGPIPE (set on each
+// socket by no_sigpipe()) on macOS/BSD.
+#if defined(MSG_NOSIGNAL)
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+inline void no_sigpipe(Handle h) {
+#if defined(SO_NOSIGPIPE)
+    int one = 1;
+    setsockopt(h, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#else
+    (void)h;
+#endif
+}
+
+}  // namespace line_socket_detail
+
+/** This machine's host name, for labelling distributed workers. */
+inline std::string local_hostname() {
+    line_socket_detail::net_init();
+    char name[256] = {0};
+    if (gethostname(name, sizeof(name) - 1) != 0 || !name[0]) return "unknown";
+    return name;
+}
+
+class LineSocket {
+public:
+    typedef line_socket_detail::Handle Handle;
+
+    LineSocket() : fd_(line_socket_detail::INVALID) {}
+    explicit LineSocket(Handle fd) : fd_(fd) {
+        if (valid()) line_socket_detail::no_sigpipe(fd_);
+    }
+    ~LineSocket() { close(); }
+
+    LineSocket(LineSocket&& other) : fd_(other.fd_), buf_(std::move(other.buf_)), error_(std::move(other.error_)) {
+        other.fd_ = line_socket_detail::INVALID;
+    }
+    LineSocket& operator=(LineSocket&& other) {
+        if (this != &other) {
+            close();
+            fd_ = other.fd_;
+            buf_ = std::move(other.buf_);
+            error_ = std::move(other.error_);
+            other.fd_ = line_socket_detail::INVALID;
+        }
+        return *this;
+    }
+    LineSocket(const LineSocket&) = delete;
+    LineSocket& operator=(const LineSocket&) = delete;
+
+    /** Connect to host:port; check valid() / error() afterwards. */
+    static LineSocket connect(const std::string& host, int port) {
+        line_socket_detail::net_init();
+        LineSocket s;
+        struct addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* res = nullptr;
+        std::string port_str = std::to_string(port);
+        int rc = getaddrinfo(host.c_str(), port_str.c_str(), &hints, &res);
+        if (rc != 0) {
+            s.error_ = "cannot resolve " + host + ": " + gai_strerror(rc);
+            return s;
+        }
+        for (struct addrinfo* ai = res; ai; ai = ai->ai_next) {
+            Handle fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (fd == line_socket_detail::INVALID) continue;
+            if (::connect(fd, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0) {
+                s.fd_ = fd;
+                break;
+            }
+            line_socket_detail::close_handle(fd);
+        }
+        freeaddrinfo(res);
+        if (!s.valid()) {
+            s.error_ = "cannot connect to " + host + ":" + port_str;
+        } else {
+            s.set_nodelay();
+            line_socket_detail::no_sigpipe(s.fd_);
+        }
+        return s;
+    }
+
+    bool valid() const { return fd_ != line_socket_detail::INVALID; }
+    const std::string& error() const { return error_; }
+
+    void close() {
+        if (valid()) line_socket_detail::close_handle(fd_);
+        fd_ = line_socket_detail::INVALID;
+    }
+
+    /** Give up on reads that see no data for `ms` (0 = wait forever). */
+    void set_receive_timeout(int ms) {
+#if defined(_WIN32)
+        DWORD tv = static_cast<DWORD>(ms);
+#else
+        struct timeval tv;
+        tv.tv_sec = ms / 1000;
+        tv.tv_usec = (ms % 1000) * 1000;
+#endif
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+    }
+
+    /** Send `line` plus a newline. */
+    bool send_line(const std::string& line) { return send_all(line + "\n"); }
+
+    bool send_all(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            int n = static_cast<int>(::send(fd_, data.data() + sent, static_cast<int>(data.size() - sent),
+                                            line_socket_detail::SEND_FLAGS));
+            if (n <= 0) {
+                error_ = "send failed";
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /** Next line without its newline; false on EOF, timeout or error. */
+    bool read_line(std::string& line) {
+        for (;;) {
+            size_t nl = buf_.find('\n');
+            if (nl != std::string::npos) {
+                line.assign(buf_, 0, nl);
+                if (!line.empty() && line[line.size() - 1] == '\r') line.resize(line.size() - 1);
+                buf_.erase(0, nl + 1);
+                return true;
+            }
+            char chunk[4096];
+            int n = static_cast<int>(::recv(fd_, chunk, sizeof(chunk), 0));
+            if (n <= 0) {
+                error_ = n == 0 ? "connection closed" : "receive failed or timed out";
+                return false;
+            }
+            buf_.append(chunk, static_cast<size_t>(n));
+        }
+    }
+
+private:
+    void set_nodelay() {
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+    }
+
+    Handle fd_;
+    std::string buf_;
+    std::string error_;
+};
+
+class LineListener {
+public:
+    /** Listen on all interfaces at `port`; check valid() / error() afterwards. */
+    explicit LineListener(int port) : fd_(line_socket_detail::INVALID) {
+        line_socket_detail::net_init();
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ == line_socket_detail::INVALID) {
+            error_ = "socket() failed";
+            return;
+        }
+        int one = 1;
+        setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(static_cast<unsigned short>(port));
+        if (::bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd_, 64) != 0) {
+            error_ = "cannot listen on port " + std::to_string(port);
+            line_socket_detail::close_handle(fd_);
+            fd_ = line_socket_detail::INVALID;
+        }
+    }
+
+    ~LineListener() {
+        if (valid()) line_socket_detail::close_handle(fd_);
+    }
+
+    LineListener(const LineListener&) = delete;
+    LineListener& operator=(const LineListener&) = delete;
+
+    bool valid() const { return fd_ != line_socket_detail::INVALID; }
+    const std::string& error() const { return error_; }
+
+    /** Block until a peer connects; peer_out receives its address. */
+    LineSocket accept(std::string& peer_out) {
+        struct sockaddr_storage addr;
+        socklen_t len = sizeof(addr);
+        LineSocket::Handle fd = ::accept(fd_, reinterpret_cast<struct sockaddr*>(&addr), &len);
+        char host[256] = "?";
+        if (fd != line_socket_detail::INVALID) {
+            getnameinfo(reinterpret_cast<struct sockaddr*>(&addr), len, host, sizeof(host), nullptr, 0, NI_NUMERICHOST);
+        }
+        peer_out = host;
+        return LineSocket(fd);
+    }
+
+private:
+    LineSocket::Handle fd_;
+    std::string error_;
+};
@@ -14,7 +14,38 @@
  *   ./drip-health              # Run all checks
  *   ./drip-health --quick      # Ping only
  *   ./drip-health --race       # Run concurrent race-condition tests
- *   ./drip-health --verbose    # Show extra details
+ *   ./drip-health --parallel   # Run independent checks concurrently
+ *   ./drip-health --bench      # Sustained load with latency percentiles
+ *   ./drip-health --verbose    # Show extra details (plus DNS/TCP/TLS/server phase timings)
+ *   ./drip-health --metrics    # Append a Prometheus dump of per-endpoint SDK metrics
+ *   ./drip-health --trace F    # Chrome trace of every SDK call (chrome://tracing, Perfetto)
+ *   ./drip-health --profile    # Per-stage time of sampled SDK calls (build with PROFILE=1)
+ *   ./drip-health --json F     # Latency/throughput/errors as JSON (checks and --bench)
+ *   ./drip-health --bench --baseline F --max-regress 10%   # Exit 1 if p99/throughput/errors regressed
+ *   ./drip-health --race --faults latency=lognormal:20:0.5,429=0.05   # Degraded network/API
+ *   ./drip-health --bench --offline   # No API at all: harness overhead and back-pressure only
+ *
+ * Benchmark options:
+ *   --concurrency N   Worker threads (default: 8)
+ *   --duration S      Seconds to run (default: 10)
+ *   --rps N           Target total request rate (default: unthrottled)
+ *   --ops LIST        Comma-separated: track,balance,list,run (default: all)
+ *   --open-loop       Fixed arrival schedule at --rps; latency from intended send
+ *   --arrivals KIND   poisson (default) or uniform
+ *   --clients MODE    shared (default), pooled, fresh (new client per request), or sharded
+ *   --pool-compare    Run fresh vs pooled clients plus a curl handshake probe
+ *   --connections N   Cap on pooled clients (sockets) shared by the workers
+ *   --warm N          Pre-open N pooled connections (DNS/TCP/TLS) before the run starts
+ *   --sweep LIST      Throughput at each concurrency level, e.g. 64,256,1024
+ *   --scaling         trackUsage throughput vs threads (1..64), shared vs sharded client
+ *   --governor        Shared rate limiter (--rps) and adaptive concurrency limit
+ *
+ * Bulk provisioning (customers/s, bulk vs one call at a time):
+ *   ./drip-health --bulk-customers 20000 --concurrency 16 --bulk-chunk 200
+ *
+ * Distributed benchmark (same options, merged across processes or hosts):
+ *   ./drip-health --coordinator 7400 --workers 4 --duration 30 --rps 2000
+ *   ./drip-health --worker coordinator-host:7400     # on each load machine
  */
 
 #include <drip/drip.hpp>
@@ -22,18 +53,41 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <functional>
+#include <future>
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <random>
 #include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "async_client.hpp"
+#include "balance_cache.hpp"
+#include "bulk_customers.hpp"
+#include "client_metrics.hpp"
+#include "client_pool.hpp"
+#include "customer_scan.hpp"
+#include "hedged_read.hpp"
+#include "http_probe.hpp"
+#include "latency_histogram.hpp"
+#include "line_socket.hpp"
+#include "perf_report.hpp"
+#include "process_stats.hpp"
+#include "rate_limiter.hpp"
+#include "retry_policy.hpp"
+#include "sharded_client.hpp"
+#include "trace_events.hpp"
+#include "workflow_cache.hpp"
+
 // =============================================================================
 // Types
 // =============================================================================
@@ -55,6 +109,10 @@ static const char* RED   = "\033[31m";
 static const char* DIM   = "\033[2m";
 static const char* RESET = "\033[0m";
 
+// Same default host as the JS checker (src/config.ts); only used by the
+// transport probe, which talks to the API without going through the SDK.
+static const char* DEFAULT_API_URL = "https://drip-app-hlunj.ondigitalocean.app";
+
 // =============================================================================
 // Helpers
 // =============================================================================
@@ -93,11 +151,46 @@ static int64_t now_ms() {
     ).count();
 }
 
+static int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+// Taken during static initialization, as close to process start as main.cpp can get
+static const int64_t process_start_us = now_us();
+
+/** When each startup step finished, relative to process_start_us (0 = not reached). */
+struct StartupTimeline {
+    int64_t config_us = 0;      // Environment / .env read, Config built
+    int64_t client_us = 0;      // drip::Client constructed
+    int64_t first_ping_us = 0;  // First ping() answered
+
+    static int64_t mark() { return now_us() - process_start_us; }
+};
+
+static std::vector<std::string> split_csv(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+static std::string fmt_ms(int64_t us) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2) << (us / 1000.0);
+    return ss.str();
+}
+
 // =============================================================================
 // Checks
 // =============================================================================
 
-static CheckResult check_customer_create(drip::Client& client, std::string& customer_id_out) {
+static CheckResult check_customer_create(drip::Client& client, std::string& customer_id_out,
+                                         std::ostream& out = std::cout) {
     auto start = now_ms();
     try {
         drip::CreateCustomerParams params;
@@ -107,14 +200,14 @@ static CheckResult check_customer_create(drip::Client& client, std::string& cust
         params.metadata["test"] = "true";
         params.metadata["source"] = "cpp_health_check";
 
-        auto result = client.createCustomer(params);
+        auto result = metered(Endpoint::CREATE_CUSTOMER, [&] { return client.createCustomer(params); });
         int dur = static_cast<int>(now_ms() - start);
         customer_id_out = result.id;
 
-        std::cout << "        id: " << result.id << std::endl;
-        std::cout << "        external_customer_id: " << result.external_customer_id << std::endl;
-        std::cout << "        status: " << result.status << std::endl;
-        std::cout << "        created_at: " << result.created_at << std::endl;
+        out << "        id: " << result.id << std::endl;
+        out << "        external_customer_id: " << result.external_customer_id << std::endl;
+        out << "        status: " << result.status << std::endl;
+        out << "        created_at: " << result.created_at << std::endl;
 
         return {"Create Customer", true, dur, "Created " + result.id, "external_id: " + params.external_customer_id};
     } catch (const drip::DripError& e) {
@@ -123,16 +216,16 @@ static CheckResult check_customer_create(drip::Client& client, std::string& cust
     }
 }
 
-static CheckResult check_connectivity(drip::Client& client) {
+static CheckResult check_connectivity(drip::Client& client, std::ostream& out = std::cout) {
     auto start = now_ms();
     try {
-        auto health = client.ping();
+        auto health = metered(Endpoint::PING, [&] { return client.ping(); });
         int dur = static_cast<int>(now_ms() - start);
 
-        std::cout << "        ok: " << (health.ok ? "true" : "false") << std::endl;
-        std::cout << "        status: " << health.status << std::endl;
-        std::cout << "        latency_ms: " << health.latency_ms << std::endl;
-        std::cout << "        timestamp: " << health.timestamp << std::endl;
+        out << "        ok: " << (health.ok ? "true" : "false") << std::endl;
+        out << "        status: " << health.status << std::endl;
+        out << "        latency_ms: " << health.latency_ms << std::endl;
+        out << "        timestamp: " << health.timestamp << std::endl;
 
         if (health.ok) {
             std::ostringstream msg;
@@ -147,11 +240,11 @@ static CheckResult check_connectivity(drip::Client& client) {
     }
 }
 
-static CheckResult check_authentication(drip::Client& client) {
+static CheckResult check_authentication(drip::Client& client, std::ostream& = std::cout) {
     auto start = now_ms();
     try {
         // Ping implicitly verifies auth since it uses the Bearer token
-        auto health = client.ping();
+        auto health = metered(Endpoint::PING, [&] { return client.ping(); });
         int dur = static_cast<int>(now_ms() - start);
 
         std::string key_desc;
@@ -170,7 +263,8 @@ static CheckResult check_authentication(drip::Client& client) {
     }
 }
 
-static CheckResult check_track_usage(drip::Client& client, const std::string& customer_id) {
+static CheckResult check_track_usage(drip::Client& client, const std::string& customer_id,
+                                     std::ostream& out = std::cout) {
     auto start = now_ms();
     try {
         drip::TrackUsageParams params;
@@ -182,15 +276,15 @@ static CheckResult check_track_usage(drip::Client& client, const std::string& cu
         params.metadata["sdk"] = "cpp";
         params.metadata["version"] = DRIP_SDK_VERSION;
 
-        auto result = client.trackUsage(params);
+        auto result = metered(Endpoint::TRACK_USAGE, params, [&] { return client.trackUsage(params); });
         int dur = static_cast<int>(now_ms() - start);
 
-        std::cout << "        success: " << (result.success ? "true" : "false") << std::endl;
-        std::cout << "        usage_event_id: " << result.usage_event_id << std::endl;
-        std::cout << "        customer_id: " << result.customer_id << std::endl;
-        std::cout << "        usage_type: " << result.usage_type << std::endl;
-        std::cout << "        quantity: " << result.quantity << std::endl;
-        std::cout << "        message: " << result.message << std::endl;
+        out << "        success: " << (result.success ? "true" : "false") << std::endl;
+        out << "        usage_event_id: " << result.usage_event_id << std::endl;
+        out << "        customer_id: " << result.customer_id << std::endl;
+        out << "        usage_type: " << result.usage_type << std::endl;
+        out << "        quantity: " << result.quantity << std::endl;
+        out << "        message: " << result.message << std::endl;
 
         if (result.success) {
             return {"Track Usage", true, dur, "Event recorded: " + result.usage_event_id, ""};
@@ -203,17 +297,18 @@ static CheckResult check_track_usage(drip::Client& client, const std::string& cu
     }
 }
 
-static CheckResult check_get_customer(drip::Client& client, const std::string& customer_id) {
+static CheckResult check_get_customer(drip::Client& client, const std::string& customer_id,
+                                      std::ostream& out = std::cout) {
     auto start = now_ms();
     try {
-        auto result = client.getCustomer(customer_id);
+        auto result = metered(Endpoint::GET_CUSTOMER, [&] { return client.getCustomer(customer_id); });
         int dur = static_cast<int>(now_ms() - start);
 
-        std::cout << "        id: " << result.id << std::endl;
-        std::cout << "        external_customer_id: " << result.external_customer_id << std::endl;
-        std::cout << "        status: " << result.status << std::endl;
-        std::cout << "        is_internal: " << (result.is_internal ? "true" : "false") << std::endl;
-        std::cout << "        created_at: " << result.created_at << std::endl;
+        out << "        id: " << result.id << std::endl;
+        out << "        external_customer_id: " << result.external_customer_id << std::endl;
+        out << "        status: " << result.status << std::endl;
+        out << "        is_internal: " << (result.is_internal ? "true" : "false") << std::endl;
+        out << "        created_at: " << result.created_at << std::endl;
 
         return {"Get Customer", true, dur, "Retrieved " + result.id, ""};
     } catch (const drip::DripError& e) {
@@ -222,20 +317,20 @@ static CheckResult check_get_customer(drip::Client& client, const std::string& c
     }
 }
 
-static CheckResult check_list_customers(drip::Client& client) {
+static CheckResult check_list_customers(drip::Client& client, std::ostream& out = std::cout) {
     auto start = now_ms();
     try {
         drip::ListCustomersOptions opts;
         opts.limit = 5;
-        auto result = client.listCustomers(opts);
+        auto result = metered(Endpoint::LIST_CUSTOMERS, [&] { return client.listCustomers(opts); });
         int dur = static_cast<int>(now_ms() - start);
 
         size_t show_count = std::min(result.customers.size(), static_cast<size_t>(5));
-        std::cout << "        total: " << result.total << std::endl;
-        std::cout << "        customers (first " << static_cast<int>(show_count) << "):" << std::endl;
+        out << "        total: " << result.total << std::endl;
+        out << "        customers (first " << static_cast<int>(show_count) << "):" << std::endl;
         for (size_t i = 0; i < show_count; ++i) {
             const auto& c = result.customers[i];
-            std::cout << "          [" << (i+1) << "] " << c.id << " (ext: " << c.external_customer_id << ", " << c.status << ")" << std::endl;
+            out << "          [" << (i+1) << "] " << c.id << " (ext: " << c.external_customer_id << ", " << c.status << ")" << std::endl;
         }
 
         return {"List Customers", true, dur, "Listed " + std::to_string(result.total) + " total", ""};
@@ -245,14 +340,59 @@ static CheckResult check_list_customers(drip::Client& client) {
     }
 }
 
-static CheckResult check_get_balance(drip::Client& client, const std::string& customer_id) {
+/** Walk `pages` pages of customers (0 = all) through CustomerScan, as a reconciliation job would. */
+static CheckResult check_scan_customers(drip::Client& client, int pages, std::ostream& out = std::cout) {
+    auto start = now_ms();
+    try {
+        drip::ListCustomersOptions opts;
+        opts.limit = 100;
+        CustomerScan scan(client, opts, pages);
+        ProcessSample before = sample_process();
+        int64_t peak_rss = before.rss_bytes;
+        int last_page = 0;
+        int64_t t0 = now_us();
+        for (const drip::Customer& c : scan) {
+            (void)c;
+            if (scan.pages() != last_page) {
+                last_page = scan.pages();
+                peak_rss = std::max(peak_rss, sample_process().rss_bytes);
+            }
+        }
+        int64_t scan_us = now_us() - t0;
+        peak_rss = std::max(peak_rss, sample_process().rss_bytes);
+        int dur = static_cast<int>(now_ms() - start);
+
+        double rate = scan_us > 0 ? scan.items() * 1e6 / scan_us : 0.0;
+        out << "        pages: " << scan.pages() << std::endl;
+        out << "        customers: " << scan.items() << std::endl;
+        out << "        customers/s: " << static_cast<int64_t>(rate) << std::endl;
+        out << "        waiting for pages: " << fmt_ms(scan.wait_us()) << "ms of " << fmt_ms(scan_us) << "ms" << std::endl;
+        out << "        peak buffered: " << scan.peak_buffered() << " customers" << std::endl;
+        if (before.rss_bytes >= 0) {
+            out << "        rss: " << before.rss_bytes / 1024 << " KB -> peak " << peak_rss / 1024 << " KB" << std::endl;
+        }
+
+        std::ostringstream msg;
+        msg << scan.items() << " customers in " << scan.pages() << " pages, "
+            << static_cast<int64_t>(rate) << "/s, at most " << scan.peak_buffered() << " held";
+        std::string details;
+        if (before.rss_bytes >= 0) details = "peak RSS +" + std::to_string((peak_rss - before.rss_bytes) / 1024) + " KB";
+        return {"Scan Customers", true, dur, msg.str(), details};
+    } catch (const drip::DripError& e) {
+        int dur = static_cast<int>(now_ms() - start);
+        return {"Scan Customers", false, dur, std::string("Failed: ") + e.what(), ""};
+    }
+}
+
+static CheckResult check_get_balance(drip::Client& client, const std::string& customer_id,
+                                     std::ostream& out = std::cout) {
     auto start = now_ms();
     try {
-        auto result = client.getBalance(customer_id);
+        auto result = metered(Endpoint::GET_BALANCE, [&] { return client.getBalance(customer_id); });
         int dur = static_cast<int>(now_ms() - start);
 
-        std::cout << "        customer_id: " << result.customer_id << std::endl;
-        std::cout << "        balance_usdc: " << result.balance_usdc << std::endl;
+        out << "        customer_id: " << result.customer_id << std::endl;
+        out << "        balance_usdc: " << result.balance_usdc << std::endl;
 
         return {"Get Balance", true, dur, "Balance: " + result.balance_usdc + " USDC", ""};
     } catch (const drip::DripError& e) {
@@ -261,7 +401,8 @@ static CheckResult check_get_balance(drip::Client& client, const std::string& cu
     }
 }
 
-static CheckResult check_record_run(drip::Client& client, const std::string& customer_id, std::string& workflow_id_out) {
+static CheckResult check_record_run(drip::Client& client, const std::string& customer_id, std::string& workflow_id_out,
+                                    std::ostream& out = std::cout) {
     auto start = now_ms();
     try {
         drip::RecordRunParams params;
@@ -279,16 +420,16 @@ static CheckResult check_record_run(drip::Client& client, const std::string& cus
         e2.quantity = 1;
         params.events.push_back(e2);
 
-        auto result = client.recordRun(params);
+        auto result = metered(Endpoint::RECORD_RUN, [&] { return client.recordRun(params); });
         int dur = static_cast<int>(now_ms() - start);
         workflow_id_out = result.run.workflow_id;
 
-        std::cout << "        run_id: " << result.run.id << std::endl;
-        std::cout << "        workflow_id: " << result.run.workflow_id << std::endl;
-        std::cout << "        workflow_name: " << result.run.workflow_name << std::endl;
-        std::cout << "        events created: " << result.events.created << std::endl;
-        std::cout << "        duration_ms: " << result.run.duration_ms << std::endl;
-        std::cout << "        summary: " << result.summary << std::endl;
+        out << "        run_id: " << result.run.id << std::endl;
+        out << "        workflow_id: " << result.run.workflow_id << std::endl;
+        out << "        workflow_name: " << result.run.workflow_name << std::endl;
+        out << "        events created: " << result.events.created << std::endl;
+        out << "        duration_ms: " << result.run.duration_ms << std::endl;
+        out << "        summary: " << result.summary << std::endl;
 
         return {"Record Run", true, dur, result.summary, ""};
     } catch (const drip::DripError& e) {
@@ -298,7 +439,8 @@ static CheckResult check_record_run(drip::Client& client, const std::string& cus
 }
 
 static CheckResult check_start_run(drip::Client& client, const std::string& customer_id,
-                                   const std::string& workflow_id, std::string& run_id_out) {
+                                   const std::string& workflow_id, std::string& run_id_out,
+                                   std::ostream& out = std::cout) {
     auto start = now_ms();
     try {
         drip::StartRunParams params;
@@ -306,16 +448,16 @@ static CheckResult check_start_run(drip::Client& client, const std::string& cust
         params.workflow_id = workflow_id;
         params.metadata["source"] = "cpp_health_check";
 
-        auto result = client.startRun(params);
+        auto result = metered(Endpoint::START_RUN, [&] { return client.startRun(params); });
         int dur = static_cast<int>(now_ms() - start);
         run_id_out = result.id;
 
-        std::cout << "        run_id: " << result.id << std::endl;
-        std::cout << "        customer_id: " << result.customer_id << std::endl;
-        std::cout << "        workflow_id: " << result.workflow_id << std::endl;
-        std::cout << "        workflow_name: " << result.workflow_name << std::endl;
-        std::cout << "        status: " << drip::run_status_to_string(result.status) << std::endl;
-        std::cout << "        created_at: " << result.created_at << std::endl;
+        out << "        run_id: " << result.id << std::endl;
+        out << "        customer_id: " << result.customer_id << std::endl;
+        out << "        workflow_id: " << result.workflow_id << std::endl;
+        out << "        workflow_name: " << result.workflow_name << std::endl;
+        out << "        status: " << drip::run_status_to_string(result.status) << std::endl;
+        out << "        created_at: " << result.created_at << std::endl;
 
         return {"Start Run", true, dur, "Started run " + result.id, ""};
     } catch (const drip::DripError& e) {
@@ -324,7 +466,8 @@ static CheckResult check_start_run(drip::Client& client, const std::string& cust
     }
 }
 
-static CheckResult check_emit_event(drip::Client& client, const std::string& run_id) {
+static CheckResult check_emit_event(drip::Client& client, const std::string& run_id,
+                                    std::ostream& out = std::cout) {
     auto start = now_ms();
     try {
         drip::EmitEventParams params;
@@ -334,15 +477,15 @@ static CheckResult check_emit_event(drip::Client& client, const std::string& run
         params.units = "checks";
         params.description = "SDK full demo - emitEvent";
 
-        auto result = client.emitEvent(params);
+        auto result = metered(Endpoint::EMIT_EVENT, params, [&] { return client.emitEvent(params); });
         int dur = static_cast<int>(now_ms() - start);
 
-        std::cout << "        event_id: " << result.id << std::endl;
-        std::cout << "        run_id: " << result.run_id << std::endl;
-        std::cout << "        event_type: " << result.event_type << std::endl;
-        std::cout << "        quantity: " << result.quantity << std::endl;
-        std::cout << "        is_duplicate: " << (result.is_duplicate ? "true" : "false") << std::endl;
-        std::cout << "        timestamp: " << result.timestamp << std::endl;
+        out << "        event_id: " << result.id << std::endl;
+        out << "        run_id: " << result.run_id << std::endl;
+        out << "        event_type: " << result.event_type << std::endl;
+        out << "        quantity: " << result.quantity << std::endl;
+        out << "        is_duplicate: " << (result.is_duplicate ? "true" : "false") << std::endl;
+        out << "        timestamp: " << result.timestamp << std::endl;
 
         return {"Emit Event", true, dur, "Emitted event " + result.id, ""};
     } catch (const drip::DripError& e) {
@@ -351,22 +494,23 @@ static CheckResult check_emit_event(drip::Client& client, const std::string& run
     }
 }
 
-static CheckResult check_end_run(drip::Client& client, const std::string& run_id) {
+static CheckResult check_end_run(drip::Client& client, const std::string& run_id,
+                                 std::ostream& out = std::cout) {
     auto start = now_ms();
     try {
         drip::EndRunParams params;
         params.status = drip::RUN_COMPLETED;
         params.metadata["completed_by"] = "cpp_health_check";
 
-        auto result = client.endRun(run_id, params);
+        auto result = metered(Endpoint::END_RUN, [&] { return client.endRun(run_id, params); });
         int dur = static_cast<int>(now_ms() - start);
 
-        std::cout << "        run_id: " << result.id << std::endl;
-        std::cout << "        status: " << drip::run_status_to_string(result.status) << std::endl;
-        std::cout << "        ended_at: " << result.ended_at << std::endl;
-        std::cout << "        duration_ms: " << result.duration_ms << std::endl;
-        std::cout << "        event_count: " << result.event_count << std::endl;
-        std::cout << "        total_cost_units: " << result.total_cost_units << std::endl;
+        out << "        run_id: " << result.id << std::endl;
+        out << "        status: " << drip::run_status_to_string(result.status) << std::endl;
+        out << "        ended_at: " << result.ended_at << std::endl;
+        out << "        duration_ms: " << result.duration_ms << std::endl;
+        out << "        event_count: " << result.event_count << std::endl;
+        out << "        total_cost_units: " << result.total_cost_units << std::endl;
 
         return {"End Run", true, dur, "Ended run in " + std::to_string(result.duration_ms) + "ms", ""};
     } catch (const drip::DripError& e) {
@@ -375,6 +519,186 @@ static CheckResult check_end_run(drip::Client& client, const std::string& run_id
     }
 }
 
+/** Root /health URL for a Config, matching what ping() requests. */
+static std::string health_url(const drip::Config& config) {
+    std::string base = config.base_url.empty() ? DEFAULT_API_URL : config.base_url;
+    if (base.size() >= 3 && base.substr(base.size() - 3) == "/v1") base.resize(base.size() - 3);
+    return base + "/health";
+}
+
+static std::string format_phases(const RequestPhases& p) {
+    return "dns " + fmt_ms(p.dns_us) + " / tcp " + fmt_ms(p.connect_us) + " / tls " + fmt_ms(p.tls_us) +
+           " / server " + fmt_ms(p.server_us) + " / transfer " + fmt_ms(p.transfer_us) + " ms";
+}
+
+/** Lay a probe's phases out as back-to-back trace spans ending at end_us. */
+static void trace_phases(const std::string& label, int64_t end_us, const RequestPhases& p) {
+    TraceRecorder& trace = TraceRecorder::instance();
+    if (!trace.enabled()) return;
+    const char* names[] = {"dns", "tcp", "tls", "server", "transfer"};
+    const int64_t durs[] = {p.dns_us, p.connect_us, p.tls_us, p.server_us, p.transfer_us};
+    int64_t ts = end_us - p.total_us;
+    trace.complete(label, "probe", ts, p.total_us);
+    for (int i = 0; i < 5; ++i) {
+        if (durs[i] > 0) trace.complete(label + " " + names[i], "probe", ts, durs[i]);
+        ts += durs[i];
+    }
+}
+
+/**
+ * Where ping latency goes: GET /health once on a fresh curl handle (DNS,
+ * TCP and TLS all paid) and once more on a warm keep-alive handle (server
+ * time only). The SDK keeps its curl handles private, so this probes the
+ * same host directly rather than timing ping() itself.
+ */
+static CheckResult check_transport_phases(const drip::Config& config, std::ostream& out = std::cout) {
+    auto start = now_ms();
+    std::string url = health_url(config);
+    HttpProbe cold_probe(false, config.api_key);
+    ProbeResult cold = cold_probe.get(url);
+    trace_phases("GET /health (cold)", TraceRecorder::instance().now_us(), cold.phases);
+
+    HttpProbe warm_probe(true, config.api_key);
+    warm_probe.get(url);
+    ProbeResult warm = warm_probe.get(url);
+    trace_phases("GET /health (warm)", TraceRecorder::instance().now_us(), warm.phases);
+    int dur = static_cast<int>(now_ms() - start);
+
+    out << "        cold: " << format_phases(cold.phases) << std::endl;
+    out << "        warm: " << format_phases(warm.phases) << std::endl;
+
+    if (!cold.ok || !warm.ok) {
+        return {"Transport Phases", false, dur, "Probe failed: " + (cold.ok ? warm.error : cold.error), ""};
+    }
+    int64_t setup_us = cold.phases.dns_us + cold.phases.connect_us + cold.phases.tls_us;
+    return {"Transport Phases", true, dur,
+            "Cold " + fmt_ms(cold.phases.total_us) + "ms (" + fmt_ms(setup_us) + "ms setup), warm " +
+                fmt_ms(warm.phases.total_us) + "ms (" + fmt_ms(warm.phases.server_us) + "ms server)",
+            ""};
+}
+
+/** Ping, then resolve (or create) the customer that race/bench load runs against. */
+static bool prepare_load_run(drip::Client& client, const std::string& test_customer_id,
+                             std::string& customer_id, const char* what) {
+    if (!check_connectivity(client).success) {
+        std::cerr << RED << "API unreachable. Skipping " << what << "." << RESET << std::endl;
+        return false;
+    }
+    if (test_customer_id.empty() || test_customer_id == "seed-customer-1") {
+        CheckResult cr = check_customer_create(client, customer_id);
+        if (!cr.success) {
+            std::cerr << RED << "Cannot run " << what << " without a customer." << RESET << std::endl;
+            return false;
+        }
+    } else {
+        customer_id = test_customer_id;
+    }
+    std::cout << "Using customer: " << customer_id << std::endl << std::endl;
+    return true;
+}
+
+// =============================================================================
+// Check scheduling
+// =============================================================================
+
+/** Values checks hand to later checks. Each field has exactly one writer. */
+struct CheckContext {
+    std::string customer_id;
+    std::string workflow_id;
+    std::string run_id;
+};
+
+/**
+ * One entry in the check plan. `after` holds plan indices that must have
+ * finished first; `ready` (optional) then looks at what they produced and
+ * decides whether the check can run at all. A check that is not ready is
+ * skipped, as are checks waiting on it — the same shape as the sequential
+ * if-chains this replaces.
+ */
+struct CheckTask {
+    std::vector<size_t> after;
+    std::function<bool(const CheckContext&)> ready;
+    std::function<CheckResult(CheckContext&, std::ostream&)> run;
+};
+
+/**
+ * Run a check plan and return the results of the checks that ran, in plan
+ * order. Sequentially each check streams its details straight to stdout; in
+ * parallel every check whose dependencies are done starts on its own thread,
+ * its details are buffered, and the buffers are printed in plan order at the
+ * end so the output does not depend on scheduling.
+ */
+static std::vector<CheckResult> run_check_plan(const std::vector<CheckTask>& plan, CheckContext& ctx,
+                                               bool parallel) {
+    std::vector<CheckResult> results;
+    if (!parallel) {
+        for (size_t i = 0; i < plan.size(); ++i) {
+            if (plan[i].ready && !plan[i].ready(ctx)) continue;
+            results.push_back(plan[i].run(ctx, std::cout));
+        }
+        return results;
+    }
+
+    enum TaskState { TASK_PENDING, TASK_RUNNING, TASK_DONE };
+    std::vector<TaskState> state(plan.size(), TASK_PENDING);
+    std::vector<bool> ran(plan.size(), false);
+    std::vector<CheckResult> outcome(plan.size());
+    std::vector<std::string> output(plan.size());
+    std::vector<std::thread> threads;
+    size_t done = 0;
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    std::unique_lock<std::mutex> lock(mtx);
+    while (done < plan.size()) {
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            for (size_t i = 0; i < plan.size(); ++i) {
+                if (state[i] != TASK_PENDING) continue;
+                bool deps_done = true;
+                for (size_t d : plan[i].after) deps_done = deps_done && state[d] == TASK_DONE;
+                if (!deps_done) continue;
+
+                // Dependencies are done, so the context fields `ready` reads are settled
+                if (plan[i].ready && !plan[i].ready(ctx)) {
+                    state[i] = TASK_DONE;
+                    ++done;
+                    progress = true;
+                    continue;
+                }
+                state[i] = TASK_RUNNING;
+                threads.emplace_back([&, i] {
+                    std::ostringstream buf;
+                    CheckResult r;
+                    try {
+                        r = plan[i].run(ctx, buf);
+                    } catch (const std::exception& e) {
+                        r = {"Check " + std::to_string(i + 1), false, 0, std::string("Failed: ") + e.what(), ""};
+                    }
+                    std::lock_guard<std::mutex> guard(mtx);
+                    outcome[i] = r;
+                    output[i] = buf.str();
+                    ran[i] = true;
+                    state[i] = TASK_DONE;
+                    ++done;
+                    cv.notify_one();
+                });
+            }
+        }
+        if (done < plan.size()) cv.wait(lock);
+    }
+    lock.unlock();
+    for (auto& t : threads) t.join();
+
+    for (size_t i = 0; i < plan.size(); ++i) {
+        if (!ran[i]) continue;
+        std::cout << output[i];
+        results.push_back(outcome[i]);
+    }
+    return results;
+}
+
 // =============================================================================
 // Race condition tests (production-like concurrency scenarios)
 // =============================================================================
@@ -389,14 +713,24 @@ struct RaceTestResult {
     std::vector<std::string> errors;
 };
 
+/** Error bucket for breakdowns: http_<status>, network (status 0) or exception. */
+static std::string error_kind(const std::exception& e) {
+    if (const drip::DripError* de = dynamic_cast<const drip::DripError*>(&e)) {
+        return de->status_code() == 0 ? "network" : "http_" + std::to_string(de->status_code());
+    }
+    return "exception";
+}
+
 /** Thread-safe collector for exception messages from concurrent workers. */
 struct ErrorCollector {
     std::mutex mtx;
     std::vector<std::string> messages;
+    std::map<std::string, uint64_t> counts;  // Every error by error_kind(), not just the captured ones
     static const size_t max_capture = 5;
 
     void add(const std::exception& e) {
         std::lock_guard<std::mutex> lock(mtx);
+        ++counts[error_kind(e)];
         if (messages.size() >= max_capture) return;
         std::string msg = e.what();
         if (const drip::DripError* de = dynamic_cast<const drip::DripError*>(&e)) {
@@ -406,48 +740,13 @@ struct ErrorCollector {
     }
 };
 
-static void run_race_concurrent_track_usage(drip::Client& client, const std::string& customer_id,
-        int num_threads, std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
-    const int calls_per_thread = 3;
-    auto worker = [&]() {
-        for (int i = 0; i < calls_per_thread; ++i) {
-            try {
-                drip::TrackUsageParams params;
-                params.customer_id = customer_id;
-                params.meter = "race_concurrent";
-                params.quantity = static_cast<double>(1 + (i % 10));  // Vary quantity to avoid idem collision
-                params.units = "calls";
-                params.metadata["thread"] = std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) % 1000);
-                client.trackUsage(params);
-                ok++;
-            } catch (const std::exception& e) {
-                fail++;
-                errs.add(e);
-            } catch (...) {
-                fail++;
-                errs.add(std::runtime_error("unknown exception"));
-            }
-        }
-    };
-    std::vector<std::thread> threads;
-    for (int t = 0; t < num_threads; ++t) {
-        threads.emplace_back(worker);
-    }
-    for (auto& th : threads) th.join();
-}
-
-static void run_race_idempotency_collision(drip::Client& client, const std::string& customer_id,
-        int num_threads, std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
-    std::string idem_key = "race_idem_" + std::to_string(now_ms());
-    auto worker = [&]() {
+/** Wait for every future, counting successes and collecting failures. */
+template <typename T>
+static void collect_race_results(std::vector<std::future<T> >& futures,
+        std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
+    for (auto& f : futures) {
         try {
-            drip::TrackUsageParams params;
-            params.customer_id = customer_id;
-            params.meter = "race_idempotency";
-            params.quantity = 1;
-            params.idempotency_key = idem_key;  // Same key from all threads - tests idempotency
-            params.units = "collision_test";
-            client.trackUsage(params);
+            f.get();
             ok++;
         } catch (const std::exception& e) {
             fail++;
@@ -456,166 +755,342 @@ static void run_race_idempotency_collision(drip::Client& client, const std::stri
             fail++;
             errs.add(std::runtime_error("unknown exception"));
         }
-    };
-    std::vector<std::thread> threads;
-    for (int t = 0; t < num_threads; ++t) {
-        threads.emplace_back(worker);
     }
-    for (auto& th : threads) th.join();
 }
 
-static void run_race_duplicate_create_customer(drip::Client& client,
+static void run_race_concurrent_track_usage(AsyncClient& client, const std::string& customer_id,
+        int num_workers, std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
+    const int calls_per_worker = 3;
+    std::vector<std::future<AsyncClient::TrackUsageResult> > futures;
+    for (int t = 0; t < num_workers; ++t) {
+        for (int i = 0; i < calls_per_worker; ++i) {
+            drip::TrackUsageParams params;
+            params.customer_id = customer_id;
+            params.meter = "race_concurrent";
+            params.quantity = static_cast<double>(1 + (i % 10));  // Vary quantity to avoid idem collision
+            params.units = "calls";
+            params.metadata["thread"] = std::to_string(t);
+            futures.push_back(client.trackUsageAsync(params));
+        }
+    }
+    collect_race_results(futures, ok, fail, errs);
+}
+
+static void run_race_idempotency_collision(AsyncClient& client, const std::string& customer_id,
+        int num_requests, std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
+    std::string idem_key = "race_idem_" + std::to_string(now_ms());
+    std::vector<std::future<AsyncClient::TrackUsageResult> > futures;
+    for (int t = 0; t < num_requests; ++t) {
+        drip::TrackUsageParams params;
+        params.customer_id = customer_id;
+        params.meter = "race_idempotency";
+        params.quantity = 1;
+        params.idempotency_key = idem_key;  // Same key from all requests - tests idempotency
+        params.units = "collision_test";
+        futures.push_back(client.trackUsageAsync(params));
+    }
+    collect_race_results(futures, ok, fail, errs);
+}
+
+static void run_race_duplicate_create_customer(AsyncClient& client,
         const std::string& ext_id, std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
-    auto worker = [&]() {
+    std::vector<std::future<AsyncClient::CustomerResult> > futures;
+    for (int i = 0; i < 4; ++i) {
+        drip::CreateCustomerParams params;
+        params.external_customer_id = ext_id;  // Same from all requests - race to create
+        params.metadata["race_test"] = "true";
+        futures.push_back(client.createCustomerAsync(params));
+    }
+    collect_race_results(futures, ok, fail, errs);  // Expected: one succeeds, others may conflict
+}
+
+static void run_race_mixed_load(AsyncClient& client, const std::string& customer_id,
+        int num_requests, std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
+    std::vector<std::future<AsyncClient::PingResult> > pings;
+    std::vector<std::future<AsyncClient::TrackUsageResult> > tracks;
+    std::vector<std::future<AsyncClient::ListCustomersResult> > lists;
+    std::vector<std::future<AsyncClient::BalanceResult> > balances;
+    for (int i = 0; i < num_requests; ++i) {
+        if (i % 4 == 0) {
+            pings.push_back(client.pingAsync());
+        } else if (i % 4 == 1) {
+            drip::TrackUsageParams params;
+            params.customer_id = customer_id;
+            params.meter = "race_mixed";
+            params.quantity = i;
+            params.idempotency_key = "race_mixed_" + std::to_string(i);
+            tracks.push_back(client.trackUsageAsync(params));
+        } else if (i % 4 == 2) {
+            lists.push_back(client.listCustomersAsync(drip::ListCustomersOptions()));
+        } else {
+            balances.push_back(client.getBalanceAsync(customer_id));
+        }
+    }
+    collect_race_results(pings, ok, fail, errs);
+    collect_race_results(tracks, ok, fail, errs);
+    collect_race_results(lists, ok, fail, errs);
+    collect_race_results(balances, ok, fail, errs);
+}
+
+static void run_race_concurrent_record_run(AsyncClient& client, WorkflowCache& workflows,
+        const std::string& customer_id, const std::string& workflow, int num_requests,
+        std::atomic<int>& ok, std::atomic<int>& fail, std::atomic<int>& calls, ErrorCollector& errs) {
+    std::vector<std::future<AsyncClient::RecordRunResult> > futures;
+    for (int idx = 0; idx < num_requests; ++idx) {
+        drip::RecordRunParams params;
+        params.customer_id = customer_id;
+        params.workflow = workflow;
+        params.status = drip::RUN_COMPLETED;
+        params.external_run_id = "race_run_" + std::to_string(now_ms()) + "_" + std::to_string(idx);
+
+        drip::RecordRunEvent e;
+        e.event_type = "race.event";
+        e.quantity = idx;
+        params.events.push_back(e);
+
+        // Resolve through the single-flight cache first: one caller creates the
+        // workflow, the others wait for it rather than racing their own creations.
+        // recordRun() takes a slug, not an ID, so every run still resolves it
+        // server-side: the seed is one extra call per slug, not a saving.
+        futures.push_back(client.callAsync([&workflows, &calls, params](drip::Client& c) {
+            workflows.get(params.workflow, [&] {
+                ++calls;
+                return resolve_workflow_via_record_run(c, params.customer_id, params.workflow);
+            });
+            ++calls;
+            return metered(Endpoint::RECORD_RUN, [&] { return c.recordRun(params); });
+        }));
+    }
+    collect_race_results(futures, ok, fail, errs);
+}
+
+/** Alternate getBalance/getCustomer reads, each once plain and once hedged, timing both. */
+static void run_race_hedged_reads(AsyncClient& client, Hedger& hedger, const std::string& customer_id,
+        int num_reads, LatencyHistogram& plain, LatencyHistogram& hedged,
+        std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
+    for (int i = 0; i < num_reads; ++i) {
+        bool balance = (i % 2 == 0);
         try {
-            drip::CreateCustomerParams params;
-            params.external_customer_id = ext_id;  // Same from all threads - race to create
-            params.metadata["race_test"] = "true";
-            client.createCustomer(params);
+            int64_t t0 = now_us();
+            if (balance) client.getBalanceAsync(customer_id).get();
+            else client.getCustomerAsync(customer_id).get();
+            plain.record(now_us() - t0);
             ok++;
         } catch (const std::exception& e) {
-            fail++;  // Expected: one succeeds, others may conflict
-            errs.add(e);
-        } catch (...) {
             fail++;
-            errs.add(std::runtime_error("unknown exception"));
+            errs.add(e);
         }
-    };
-    std::vector<std::thread> threads;
-    for (int i = 0; i < 4; ++i) threads.emplace_back(worker);
-    for (auto& th : threads) th.join();
-}
-
-static void run_race_mixed_load(drip::Client& client, const std::string& customer_id,
-        int num_threads, std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
-    auto worker = [&](int i) {
         try {
-            if (i % 4 == 0) {
-                client.ping();
-            } else if (i % 4 == 1) {
-                drip::TrackUsageParams params;
-                params.customer_id = customer_id;
-                params.meter = "race_mixed";
-                params.quantity = i;
-                params.idempotency_key = "race_mixed_" + std::to_string(i);
-                client.trackUsage(params);
-            } else if (i % 4 == 2) {
-                client.listCustomers(drip::ListCustomersOptions());
+            int64_t t0 = now_us();
+            if (balance) {
+                hedger.read([customer_id](drip::Client& c) {
+                    return metered(Endpoint::GET_BALANCE, [&] { return c.getBalance(customer_id); });
+                });
             } else {
-                client.getBalance(customer_id);
+                hedger.read([customer_id](drip::Client& c) {
+                    return metered(Endpoint::GET_CUSTOMER, [&] { return c.getCustomer(customer_id); });
+                });
             }
+            hedged.record(now_us() - t0);
             ok++;
         } catch (const std::exception& e) {
             fail++;
             errs.add(e);
-        } catch (...) {
-            fail++;
-            errs.add(std::runtime_error("unknown exception"));
         }
-    };
-    std::vector<std::thread> threads;
-    for (int t = 0; t < num_threads; ++t) {
-        threads.emplace_back(worker, t);
     }
-    for (auto& th : threads) th.join();
 }
 
-static void run_race_concurrent_record_run(drip::Client& client, const std::string& customer_id,
-        const std::string& workflow, int num_threads, std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
-    auto worker = [&](int idx) {
-        try {
-            drip::RecordRunParams params;
-            params.customer_id = customer_id;
-            params.workflow = workflow;
-            params.status = drip::RUN_COMPLETED;
-            params.external_run_id = "race_run_" + std::to_string(now_ms()) + "_" + std::to_string(idx);
-
-            drip::RecordRunEvent e;
-            e.event_type = "race.event";
-            e.quantity = idx;
-            params.events.push_back(e);
-
-            client.recordRun(params);
-            ok++;
-        } catch (const std::exception& e) {
-            fail++;
-            errs.add(e);
-        } catch (...) {
-            fail++;
-            errs.add(std::runtime_error("unknown exception"));
-        }
-    };
-    std::vector<std::thread> threads;
-    for (int t = 0; t < num_threads; ++t) {
-        threads.emplace_back(worker, t);
+/**
+ * Balance gating: every job checks the customer's balance before doing
+ * work, as a training loop's "may I continue?" check would. Jobs run on the
+ * pool, so the checks hit the cache from RACE_WORKERS threads at once, and
+ * all three write-through paths race them: every tenth job charges the
+ * cached balance locally with adjust(), and once per write_every jobs one
+ * records a run (on_record_run()) and one tracks usage and invalidates.
+ */
+static void run_race_balance_gate(AsyncClient& client, BalanceCache& cache, const std::string& customer_id,
+        int num_checks, int write_every, std::atomic<int>& ok, std::atomic<int>& fail, ErrorCollector& errs) {
+    std::vector<std::future<void> > futures;
+    for (int i = 0; i < num_checks; ++i) {
+        int slot = i % write_every;
+        futures.push_back(client.callAsync([&cache, customer_id, write_every, slot, i](drip::Client& c) {
+            cache.get(c, customer_id);
+            if (slot % 10 == 3) {
+                cache.adjust(customer_id, -0.01);
+            } else if (slot == write_every / 2) {
+                drip::RecordRunParams params;
+                params.customer_id = customer_id;
+                params.workflow = "cpp-race-test";
+                params.status = drip::RUN_COMPLETED;
+                params.external_run_id = "race_gate_run_" + std::to_string(now_ms()) + "_" + std::to_string(i);
+                drip::RecordRunEvent e;
+                e.event_type = "race.gate";
+                e.quantity = 1;
+                params.events.push_back(e);
+                // Nominal rate: the write path is under test, not the amount
+                cache.on_record_run(customer_id,
+                                    metered(Endpoint::RECORD_RUN, [&] { return c.recordRun(params); }), 0.0001);
+            } else if (slot == write_every - 1) {
+                drip::TrackUsageParams params;
+                params.customer_id = customer_id;
+                params.meter = "race_balance_gate";
+                params.quantity = 1;
+                params.idempotency_key = "race_gate_" + std::to_string(now_ms()) + "_" + std::to_string(i);
+                metered(Endpoint::TRACK_USAGE, params, [&] { return c.trackUsage(params); });
+                cache.invalidate(customer_id);
+            }
+        }));
     }
-    for (auto& th : threads) th.join();
+    collect_race_results(futures, ok, fail, errs);
+}
+
+/** Retries the shared Retrier made between two snapshots, for a race result's details. */
+static std::string retry_note(const RetryStats& before, const RetryStats& after) {
+    std::string note = ", " + std::to_string(after.retries - before.retries) + " retries";
+    uint64_t refused = after.budget_exhausted - before.budget_exhausted;
+    if (refused > 0) note += " (" + std::to_string(refused) + " refused by retry budget)";
+    return note;
 }
 
-static std::vector<RaceTestResult> run_race_tests(drip::Client& client, const std::string& customer_id) {
+/**
+ * All race requests go through one AsyncClient: they are queued up front and
+ * run by RACE_WORKERS threads sharing the same drip::Client, so up to that
+ * many calls hit the shared client at once. Repeatable calls retry 429/5xx
+ * and network errors through one Retrier, and each result reports how many
+ * retries it took.
+ */
+static const int RACE_WORKERS = 12;
+
+static std::vector<RaceTestResult> run_race_tests(drip::Client& sync_client, const std::string& customer_id) {
     std::vector<RaceTestResult> results;
     const int threads = 6;
+    Retrier retrier;
+    AsyncClient client(sync_client, RACE_WORKERS, &retrier);
 
     // 1. Concurrent trackUsage - shared client, same customer
     {
+        TraceSpan span("race: Concurrent trackUsage", "race");
         std::atomic<int> ok{0}, fail{0};
         ErrorCollector errs;
+        RetryStats before = retrier.stats();
         run_race_concurrent_track_usage(client, customer_id, threads, ok, fail, errs);
         int total = threads * 3;  // 3 calls per thread
         RaceTestResult r{"Concurrent trackUsage (shared client)", fail == 0,
             total, static_cast<int>(ok), static_cast<int>(fail),
-            std::to_string(ok) + "/" + std::to_string(total) + " succeeded", errs.messages};
+            std::to_string(ok) + "/" + std::to_string(total) + " succeeded" + retry_note(before, retrier.stats()),
+            errs.messages};
         results.push_back(r);
     }
 
     // 2. Idempotency collision - same idempotency key from multiple threads
     {
+        TraceSpan span("race: Idempotency collision", "race");
         std::atomic<int> ok{0}, fail{0};
         ErrorCollector errs;
+        RetryStats before = retrier.stats();
         run_race_idempotency_collision(client, customer_id, 4, ok, fail, errs);
         int total = 4;
         bool pass = (ok >= 1 && ok <= total);  // At least one success, duplicates handled gracefully
         RaceTestResult r{"Idempotency key collision (same key, 4 threads)", pass,
             total, static_cast<int>(ok), static_cast<int>(fail),
-            std::to_string(ok) + " accepted (duplicates expected to be deduped)", errs.messages};
+            std::to_string(ok) + " accepted (duplicates expected to be deduped)" + retry_note(before, retrier.stats()),
+            errs.messages};
         results.push_back(r);
     }
 
     // 3. Duplicate createCustomer - race to create same external_id
     {
+        TraceSpan span("race: Duplicate createCustomer", "race");
         std::atomic<int> ok{0}, fail{0};
         ErrorCollector errs;
+        RetryStats before = retrier.stats();
         std::string ext_id = "race_dup_create_" + std::to_string(now_ms());
         run_race_duplicate_create_customer(client, ext_id, ok, fail, errs);
         int total = 4;
         bool pass = (ok >= 1);  // At least one should succeed
         RaceTestResult r{"Duplicate createCustomer (same ext_id, 4 threads)", pass,
             total, static_cast<int>(ok), static_cast<int>(fail),
-            std::to_string(ok) + " succeeded, " + std::to_string(fail) + " failed (conflicts expected)", errs.messages};
+            std::to_string(ok) + " succeeded, " + std::to_string(fail) + " failed (conflicts expected)" + retry_note(before, retrier.stats()),
+            errs.messages};
         results.push_back(r);
     }
 
     // 4. Mixed load - ping, trackUsage, listCustomers, getBalance interleaved
     {
+        TraceSpan span("race: Mixed load", "race");
         std::atomic<int> ok{0}, fail{0};
         ErrorCollector errs;
+        RetryStats before = retrier.stats();
         run_race_mixed_load(client, customer_id, 12, ok, fail, errs);
         int total = 12;
         RaceTestResult r{"Mixed load (ping/track/list/balance, 12 threads)", fail == 0,
             total, static_cast<int>(ok), static_cast<int>(fail),
-            std::to_string(ok) + "/" + std::to_string(total) + " succeeded", errs.messages};
+            std::to_string(ok) + "/" + std::to_string(total) + " succeeded" + retry_note(before, retrier.stats()),
+            errs.messages};
         results.push_back(r);
     }
 
     // 5. Concurrent recordRun
     {
+        TraceSpan span("race: Concurrent recordRun", "race");
         std::atomic<int> ok{0}, fail{0};
         ErrorCollector errs;
-        run_race_concurrent_record_run(client, customer_id, "cpp-race-test", 4, ok, fail, errs);
+        RetryStats before = retrier.stats();
+        WorkflowCache workflows;
+        std::atomic<int> calls{0};
+        run_race_concurrent_record_run(client, workflows, customer_id, "cpp-race-test", 4, ok, fail, calls, errs);
         int total = 4;
         RaceTestResult r{"Concurrent recordRun (4 threads)", fail == 0,
             total, static_cast<int>(ok), static_cast<int>(fail),
-            std::to_string(ok) + "/" + std::to_string(total) + " succeeded", errs.messages};
+            std::to_string(ok) + "/" + std::to_string(total) + " succeeded, " + std::to_string(calls) +
+                " recordRun calls (" + std::to_string(workflows.stats().resolves) + " workflow seed)" +
+                retry_note(before, retrier.stats()),
+            errs.messages};
+        results.push_back(r);
+    }
+
+    // 6. Hedged reads - the same reads with and without a hedge after p95
+    {
+        TraceSpan span("race: Hedged reads", "race");
+        std::atomic<int> ok{0}, fail{0};
+        ErrorCollector errs;
+        RetryStats before = retrier.stats();
+        LatencyHistogram plain, hedged;
+        Hedger hedger(client);
+        const int reads = 60;
+        run_race_hedged_reads(client, hedger, customer_id, reads, plain, hedged, ok, fail, errs);
+        HedgeStats hs = hedger.stats();
+        int total = reads * 2;
+        std::string details = "p99 " + fmt_ms(plain.percentile(0.99)) + "ms plain, " +
+            fmt_ms(hedged.percentile(0.99)) + "ms hedged (" + std::to_string(hs.hedges) + " hedges, " +
+            std::to_string(hs.hedge_wins) + " won)" + retry_note(before, retrier.stats());
+        RaceTestResult r{"Hedged reads (getBalance/getCustomer, p99 with hedging)", fail == 0,
+            total, static_cast<int>(ok), static_cast<int>(fail), details, errs.messages};
+        results.push_back(r);
+    }
+
+    // 7. Balance gate - cached getBalance checks with write-through invalidation
+    {
+        TraceSpan span("race: Balance gate", "race");
+        std::atomic<int> ok{0}, fail{0};
+        ErrorCollector errs;
+        // Long staleness, so every fetch past the first is one a write forced
+        BalanceCacheOptions cache_opts;
+        cache_opts.max_staleness = std::chrono::milliseconds(60000);
+        BalanceCache cache(cache_opts);
+        const int checks = 400;
+        run_race_balance_gate(client, cache, customer_id, checks, 50, ok, fail, errs);
+        BalanceCacheStats cs = cache.stats();
+        // Single-flight: a fetch is only refused storage, and so repeated, when a write overlapped it
+        bool coalesced = cs.misses <= 1 + cs.invalidations + cs.adjustments;
+        std::ostringstream details;
+        details << ok << "/" << checks << " gate checks, hit ratio " << std::fixed << std::setprecision(1)
+                << (cs.hit_ratio() * 100) << "% (hit p50 " << cs.hit_ns.percentile(0.50) << "ns, miss p50 "
+                << fmt_ms(cs.miss_us.percentile(0.50)) << "ms), " << cs.misses << " fetches, " << cs.coalesced
+                << " coalesced, " << cs.adjustments << " adjustments, " << cs.invalidations << " invalidations";
+        if (!coalesced) details << " (more fetches than writes could force)";
+        RaceTestResult r{"Balance gate (cached getBalance, 12 threads)", fail == 0 && cs.hits > 0 && coalesced,
+            checks, static_cast<int>(ok), static_cast<int>(fail), details.str(), errs.messages};
         results.push_back(r);
     }
 
@@ -623,96 +1098,1614 @@ static std::vector<RaceTestResult> run_race_tests(drip::Client& client, const st
 }
 
 // =============================================================================
-// Reporter
+// Benchmark mode (sustained load, per-operation latency histograms)
 // =============================================================================
 
-static void print_result(const CheckResult& r, bool verbose) {
-    const char* icon = r.success ? GREEN : RED;
-    const char* status = r.success ? "PASS" : "FAIL";
+struct BenchOptions {
+    int concurrency = 8;
+    int duration_s = 10;
+    double target_rps = 0;  // 0 = unthrottled
+    bool open_loop = false;
+    bool poisson = true;    // Open-loop arrivals: Poisson (true) or uniform spacing
+    std::string tag_prefix = "bench";  // Idempotency keys / run IDs; distinct per distributed worker
+};
 
-    std::cout << "  " << icon << "[" << status << "]" << RESET
-              << " " << r.name
-              << DIM << " (" << r.duration_ms << "ms)" << RESET
-              << std::endl;
+typedef std::function<void(drip::Client&, const std::string& customer_id, const std::string& tag)> BenchCall;
 
-    if (!r.message.empty()) {
-        std::cout << "        " << r.message << std::endl;
-    }
+struct BenchOp {
+    std::string name;
+    BenchCall call;
+};
 
-    if (verbose && !r.details.empty()) {
-        std::cout << "        " << DIM << r.details << RESET << std::endl;
-    }
+enum BenchClientMode {
+    CLIENTS_SHARED,  // Every request uses the one main client
+    CLIENTS_POOLED,  // Requests lease a warm client from a ClientPool
+    CLIENTS_FRESH,   // Every request constructs its own client (no reuse)
+    CLIENTS_SHARDED  // Each worker thread has its own client (ShardedClient)
+};
+
+static BenchClientMode parse_client_mode(const std::string& name) {
+    if (name == "pooled") return CLIENTS_POOLED;
+    if (name == "fresh") return CLIENTS_FRESH;
+    if (name == "sharded") return CLIENTS_SHARDED;
+    return CLIENTS_SHARED;
 }
 
-// =============================================================================
-// Main
-// =============================================================================
+static const char* client_mode_name(BenchClientMode mode) {
+    if (mode == CLIENTS_POOLED) return "pooled";
+    if (mode == CLIENTS_FRESH) return "fresh";
+    if (mode == CLIENTS_SHARDED) return "sharded";
+    return "shared";
+}
 
-int main(int argc, char** argv) {
-    bool quick = false;
-    bool verbose = false;
-    bool race = false;
+/** Which client each bench request runs on. */
+struct BenchTarget {
+    drip::Client& shared;
+    ClientPool* pool;  // Required for POOLED and FRESH
+    BenchClientMode mode;
+    std::atomic<uint64_t> fresh_created;
+    ClientGovernor* governor;  // Optional: every request waits for its token and slot
+    ShardedClient* sharded;    // Required for SHARDED
+
+    BenchTarget(drip::Client& c, ClientPool* p, BenchClientMode m, ClientGovernor* g = nullptr,
+                ShardedClient* s = nullptr)
+        : shared(c), pool(p), mode(m), fresh_created(0), governor(g), sharded(s) {}
+
+    /** Called by bench worker `index` before its first request. */
+    void bind_worker(size_t index) {
+        if (mode == CLIENTS_SHARDED) sharded->bind(index);
+    }
 
-    for (int i = 1; i < argc; ++i) {
-        if (std::strcmp(argv[i], "--quick") == 0) quick = true;
-        else if (std::strcmp(argv[i], "--verbose") == 0 || std::strcmp(argv[i], "-v") == 0) verbose = true;
-        else if (std::strcmp(argv[i], "--race") == 0) race = true;
-        else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
-            std::cout << "Usage: drip-health [OPTIONS]\n\n"
-                      << "Options:\n"
-                      << "  --quick      Run connectivity checks only\n"
-                      << "  --race       Run concurrent race-condition tests\n"
-                      << "  --verbose    Show extra details\n"
-                      << "  --help       Show this help\n";
-            return 0;
+    void call(const BenchOp& op, const std::string& customer_id, const std::string& tag) {
+        if (governor) {
+            governor->call([&] { dispatch(op, customer_id, tag); });
+        } else {
+            dispatch(op, customer_id, tag);
         }
     }
 
-    std::string test_customer_id = env_or("TEST_CUSTOMER_ID", "");
-    std::string customer_id;
-
-    std::cout << std::endl;
-    std::cout << "Drip C++ SDK Health Check v" << DRIP_SDK_VERSION << std::endl;
-    std::cout << "==========================================" << std::endl;
-
-    // Initialize client
-    drip::Config config;
-    config.api_key = env_or("DRIP_API_KEY", "");
-    std::string api_url = env_or("DRIP_API_URL", "");
-    if (!api_url.empty()) {
-        // Ensure /v1 suffix
-        if (api_url.size() < 3 || api_url.substr(api_url.size() - 3) != "/v1") {
-            api_url += "/v1";
+    void dispatch(const BenchOp& op, const std::string& customer_id, const std::string& tag) {
+        if (mode == CLIENTS_POOLED) {
+            ClientPool::Lease lease = pool->acquire();
+            op.call(*lease, customer_id, tag);
+        } else if (mode == CLIENTS_FRESH) {
+            ++fresh_created;
+            drip::Client fresh(pool->config());
+            op.call(fresh, customer_id, tag);
+        } else if (mode == CLIENTS_SHARDED) {
+            sharded->call([&](drip::Client& c) { op.call(c, customer_id, tag); });
+        } else {
+            op.call(shared, customer_id, tag);
         }
-        config.base_url = api_url;
     }
 
-    try {
-        drip::Client client(config);
+    uint64_t clients_used() const {
+        if (mode == CLIENTS_POOLED) return pool->created();
+        if (mode == CLIENTS_FRESH) return fresh_created;
+        if (mode == CLIENTS_SHARDED) return sharded->created();
+        return 1;
+    }
+};
 
-        if (verbose) {
-            std::cout << DIM << "  API URL: " << (config.base_url.empty() ? "(default)" : config.base_url) << RESET << std::endl;
-            std::cout << DIM << "  Customer: " << (!test_customer_id.empty() && test_customer_id != "seed-customer-1" ? test_customer_id : "will create") << RESET << std::endl;
+struct BenchOpStats {
+    LatencyHistogram latency;  // Open loop: measured from the intended send time
+    LatencyHistogram service;  // Open loop only: measured from the actual send time
+    uint64_t errors = 0;
+};
+
+struct BenchReport {
+    std::vector<std::string> op_names;
+    std::vector<BenchOpStats> ops;
+    double elapsed_s = 0;
+    bool open_loop = false;
+    uint64_t scheduled = 0;   // Open loop: arrivals due within the run
+    uint64_t late = 0;        // Open loop: sends that started >1ms after their slot
+    uint64_t clients = 0;     // drip::Client instances the run went through
+    bool governed = false;
+    GovernorStats governor{};
+    std::vector<std::string> errors;
+    std::map<std::string, uint64_t> error_counts;  // By error_kind()
+};
+
+static bool make_bench_op(const std::string& name, BenchOp& out) {
+    out.name = name;
+    if (name == "track") {
+        out.call = [](drip::Client& c, const std::string& customer_id, const std::string& tag) {
+            drip::TrackUsageParams params;
+            params.customer_id = customer_id;
+            params.meter = "bench_track";
+            params.quantity = 1;
+            params.units = "calls";
+            params.idempotency_key = tag;  // Unique per request so nothing is deduped
+            metered(Endpoint::TRACK_USAGE, params, [&] { return c.trackUsage(params); });
+        };
+    } else if (name == "balance") {
+        out.call = [](drip::Client& c, const std::string& customer_id, const std::string&) {
+            metered(Endpoint::GET_BALANCE, [&] { return c.getBalance(customer_id); });
+        };
+    } else if (name == "list") {
+        out.call = [](drip::Client& c, const std::string&, const std::string&) {
+            drip::ListCustomersOptions opts;
+            opts.limit = 5;
+            metered(Endpoint::LIST_CUSTOMERS, [&] { return c.listCustomers(opts); });
+        };
+    } else if (name == "run") {
+        out.call = [](drip::Client& c, const std::string& customer_id, const std::string& tag) {
+            drip::RecordRunParams params;
+            params.customer_id = customer_id;
+            params.workflow = "cpp-bench";
+            params.status = drip::RUN_COMPLETED;
+            params.external_run_id = tag;
+
+            drip::RecordRunEvent e;
+            e.event_type = "bench.event";
+            e.quantity = 1;
+            params.events.push_back(e);
+            metered(Endpoint::RECORD_RUN, [&] { return c.recordRun(params); });
+        };
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Closed-loop load: each worker issues the configured operations round-robin
+ * until the duration elapses. With a target rate, each worker paces itself to
+ * its share (target_rps / concurrency), so stalls lower the offered load.
+ */
+static BenchReport run_bench(BenchTarget& target, const std::string& customer_id,
+                             const BenchOptions& opts, const std::vector<BenchOp>& ops) {
+    const int n = opts.concurrency;
+    std::vector<std::vector<BenchOpStats> > per_thread(n, std::vector<BenchOpStats>(ops.size()));
+    ErrorCollector errs;
+    std::string run_tag = opts.tag_prefix + "_" + std::to_string(now_ms());
+
+    const int64_t start_us = now_us();
+    const int64_t end_us = start_us + static_cast<int64_t>(opts.duration_s) * 1000000;
+    const int64_t interval_us = opts.target_rps > 0
+        ? static_cast<int64_t>(1e6 * n / opts.target_rps) : 0;
+
+    auto worker = [&](int t) {
+        TraceRecorder& trace = TraceRecorder::instance();
+        if (trace.enabled()) trace.set_thread_name("bench worker " + std::to_string(t));
+        target.bind_worker(static_cast<size_t>(t));
+        std::vector<BenchOpStats>& stats = per_thread[t];
+        int64_t next_us = start_us + (interval_us * t) / n;  // Stagger workers across one interval
+        for (int64_t seq = 0; ; ++seq) {
+            if (interval_us > 0) {
+                int64_t wait = next_us - now_us();
+                if (wait > 0) std::this_thread::sleep_for(std::chrono::microseconds(wait));
+                next_us += interval_us;
+            }
+            int64_t t0 = now_us();
+            if (t0 >= end_us) break;
+
+            size_t op = static_cast<size_t>(t + seq) % ops.size();
+            std::string tag = run_tag + "_" + std::to_string(t) + "_" + std::to_string(seq);
+            try {
+                target.call(ops[op], customer_id, tag);
+            } catch (const std::exception& e) {
+                ++stats[op].errors;
+                errs.add(e);
+            } catch (...) {
+                ++stats[op].errors;
+                errs.add(std::runtime_error("unknown exception"));
+            }
+            stats[op].latency.record(now_us() - t0);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n; ++t) threads.emplace_back(worker, t);
+    for (auto& th : threads) th.join();
+
+    BenchReport report;
+    report.elapsed_s = (now_us() - start_us) / 1e6;
+    report.clients = target.clients_used();
+    report.ops.resize(ops.size());
+    for (size_t i = 0; i < ops.size(); ++i) {
+        report.op_names.push_back(ops[i].name);
+        for (int t = 0; t < n; ++t) {
+            report.ops[i].latency.merge(per_thread[t][i].latency);
+            report.ops[i].errors += per_thread[t][i].errors;
+        }
+    }
+    report.errors = errs.messages;
+    report.error_counts = errs.counts;
+    return report;
+}
+
+/**
+ * Hands out send times on a fixed arrival schedule that does not depend on
+ * how fast earlier requests complete. Poisson arrivals draw exponential gaps
+ * with mean 1/rps; uniform arrivals space requests exactly 1/rps apart.
+ */
+class ArrivalSchedule {
+public:
+    ArrivalSchedule(int64_t start_us, double rps, bool poisson)
+        : next_us_(static_cast<double>(start_us)), mean_gap_us_(1e6 / rps),
+          poisson_(poisson), gap_(1.0 / mean_gap_us_), rng_(std::random_device()()), seq_(0) {}
+
+    /** Next intended send time; seq_out receives its position in the schedule. */
+    int64_t next(int64_t& seq_out) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        int64_t t = static_cast<int64_t>(next_us_);
+        next_us_ += poisson_ ? gap_(rng_) : mean_gap_us_;
+        seq_out = seq_++;
+        return t;
+    }
+
+private:
+    std::mutex mtx_;
+    double next_us_;
+    double mean_gap_us_;
+    bool poisson_;
+    std::exponential_distribution<double> gap_;
+    std::mt19937_64 rng_;
+    int64_t seq_;
+};
+
+/**
+ * Open-loop load: requests are issued at target_rps regardless of response
+ * time, and latency is measured from each request's intended send time so a
+ * backend stall shows up as queueing delay instead of silently lowering the
+ * offered load (coordinated omission). --concurrency caps requests in flight;
+ * if every worker is busy when a slot comes due, the request starts late and
+ * the delay is charged to its latency.
+ */
+static BenchReport run_bench_open_loop(BenchTarget& target, const std::string& customer_id,
+                                       const BenchOptions& opts, const std::vector<BenchOp>& ops) {
+    const int n = opts.concurrency;
+    std::vector<std::vector<BenchOpStats> > per_thread(n, std::vector<BenchOpStats>(ops.size()));
+    std::vector<uint64_t> late(n, 0);
+    ErrorCollector errs;
+    std::string run_tag = opts.tag_prefix + "_" + std::to_string(now_ms());
+
+    const int64_t start_us = now_us();
+    const int64_t end_us = start_us + static_cast<int64_t>(opts.duration_s) * 1000000;
+    ArrivalSchedule schedule(start_us, opts.target_rps, opts.poisson);
+    std::atomic<uint64_t> scheduled{0};
+
+    auto worker = [&](int t) {
+        TraceRecorder& trace = TraceRecorder::instance();
+        if (trace.enabled()) trace.set_thread_name("bench worker " + std::to_string(t));
+        target.bind_worker(static_cast<size_t>(t));
+        std::vector<BenchOpStats>& stats = per_thread[t];
+        for (;;) {
+            int64_t seq = 0;
+            int64_t intended_us = schedule.next(seq);
+            if (intended_us >= end_us) break;
+            ++scheduled;
+
+            int64_t wait = intended_us - now_us();
+            if (wait > 0) std::this_thread::sleep_for(std::chrono::microseconds(wait));
+            int64_t sent_us = now_us();
+            if (sent_us - intended_us > 1000) ++late[t];
+
+            size_t op = static_cast<size_t>(seq) % ops.size();
+            std::string tag = run_tag + "_" + std::to_string(seq);
+            try {
+                target.call(ops[op], customer_id, tag);
+            } catch (const std::exception& e) {
+                ++stats[op].errors;
+                errs.add(e);
+            } catch (...) {
+                ++stats[op].errors;
+                errs.add(std::runtime_error("unknown exception"));
+            }
+            int64_t done_us = now_us();
+            stats[op].latency.record(done_us - intended_us);
+            stats[op].service.record(done_us - sent_us);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n; ++t) threads.emplace_back(worker, t);
+    for (auto& th : threads) th.join();
+
+    BenchReport report;
+    report.elapsed_s = (now_us() - start_us) / 1e6;
+    report.open_loop = true;
+    report.scheduled = scheduled;
+    report.clients = target.clients_used();
+    report.ops.resize(ops.size());
+    for (size_t i = 0; i < ops.size(); ++i) {
+        report.op_names.push_back(ops[i].name);
+        for (int t = 0; t < n; ++t) {
+            report.ops[i].latency.merge(per_thread[t][i].latency);
+            report.ops[i].service.merge(per_thread[t][i].service);
+            report.ops[i].errors += per_thread[t][i].errors;
+        }
+    }
+    for (int t = 0; t < n; ++t) report.late += late[t];
+    report.errors = errs.messages;
+    report.error_counts = errs.counts;
+    return report;
+}
+
+static void print_bench_row(const std::string& name, const LatencyHistogram& h,
+                            uint64_t errors, double elapsed_s) {
+    std::cout << "  " << std::left << std::setw(10) << name << std::right
+              << std::setw(9) << h.count()
+              << std::setw(8) << errors
+              << std::setw(10) << std::fixed << std::setprecision(1)
+              << (elapsed_s > 0 ? h.count() / elapsed_s : 0.0)
+              << std::setw(9) << fmt_ms(h.percentile(0.50))
+              << std::setw(9) << fmt_ms(h.percentile(0.90))
+              << std::setw(9) << fmt_ms(h.percentile(0.99))
+              << std::setw(9) << fmt_ms(h.percentile(0.999))
+              << std::setw(9) << fmt_ms(h.max())
+              << std::endl;
+}
+
+static void print_bench_table(const BenchReport& r, bool service) {
+    std::cout << "  " << std::left << std::setw(10) << "op" << std::right
+              << std::setw(9) << "count" << std::setw(8) << "errors" << std::setw(10) << "req/s"
+              << std::setw(9) << "p50" << std::setw(9) << "p90" << std::setw(9) << "p99"
+              << std::setw(9) << "p999" << std::setw(9) << "max" << std::endl;
+
+    LatencyHistogram all;
+    uint64_t all_errors = 0;
+    for (size_t i = 0; i < r.ops.size(); ++i) {
+        const LatencyHistogram& h = service ? r.ops[i].service : r.ops[i].latency;
+        print_bench_row(r.op_names[i], h, r.ops[i].errors, r.elapsed_s);
+        all.merge(h);
+        all_errors += r.ops[i].errors;
+    }
+    if (r.ops.size() > 1) print_bench_row("total", all, all_errors, r.elapsed_s);
+}
+
+/**
+ * --governor: one shared token bucket at opts' --rps plus an adaptive limit on
+ * requests in flight. A closed-loop run's rate moves from per-worker pacing
+ * (cleared in run_opts) into the bucket; open loop keeps its schedule.
+ */
+static std::unique_ptr<ClientGovernor> make_bench_governor(const BenchOptions& opts, BenchOptions& run_opts) {
+    ConcurrencyLimitOptions limits;
+    limits.max_limit = opts.concurrency;
+    limits.initial_limit = std::min(opts.concurrency, 8);
+    double rate = opts.open_loop ? 0 : opts.target_rps;
+    run_opts.target_rps = opts.open_loop ? opts.target_rps : 0;
+    return std::unique_ptr<ClientGovernor>(new ClientGovernor(rate, std::max(1.0, rate / 10), limits));
+}
+
+static void print_bench_report(const BenchReport& r) {
+    if (r.open_loop) {
+        std::cout << "  Latency from intended send time (includes queueing):" << std::endl;
+    }
+    print_bench_table(r, false);
+
+    if (r.open_loop) {
+        std::cout << std::endl << "  Service time (from actual send):" << std::endl;
+        print_bench_table(r, true);
+        std::cout << "        " << r.scheduled << " arrivals scheduled, " << r.late
+                  << " started >1ms late" << std::endl;
+        if (r.scheduled > 0 && r.late * 10 > r.scheduled) {
+            std::cout << "        " << RED << "Over 10% of sends were late: the API could not keep up"
+                      << " or --concurrency is too low for this --rps." << RESET << std::endl;
+        }
+    }
+    std::cout << "        " << DIM << "latencies in ms, " << std::fixed << std::setprecision(1)
+              << r.elapsed_s << "s elapsed, " << r.clients << " client(s)" << RESET << std::endl;
+    if (r.governed) {
+        const GovernorStats& g = r.governor;
+        std::cout << "        Governor: concurrency limit " << g.limit << " (range " << g.min_limit_seen
+                  << "-" << g.max_limit_seen << "), peak queue " << g.peak_queue_depth << ", "
+                  << g.throttled << " throttled, " << g.decreases << " limit cuts" << std::endl;
+    }
+
+    for (const auto& err : r.errors) {
+        std::cout << "        " << RED << "ERROR: " << err << RESET << std::endl;
+    }
+}
+
+/** Per-phase percentiles of the side probe that ran during a bench. */
+static void print_phase_table(const PhaseHistograms& p, const std::string& url) {
+    std::cout << std::endl << "  " << std::left << std::setw(10) << "phase" << std::right
+              << std::setw(9) << "samples" << std::setw(9) << "p50" << std::setw(9) << "p90"
+              << std::setw(9) << "p99" << std::endl;
+    const char* names[] = {"dns", "tcp", "tls", "server", "transfer", "total"};
+    const LatencyHistogram* hists[] = {&p.dns, &p.connect, &p.tls, &p.server, &p.transfer, &p.total};
+    for (int i = 0; i < 6; ++i) {
+        std::cout << "  " << std::left << std::setw(10) << names[i] << std::right
+                  << std::setw(9) << hists[i]->count()
+                  << std::setw(9) << fmt_ms(hists[i]->percentile(0.50))
+                  << std::setw(9) << fmt_ms(hists[i]->percentile(0.90))
+                  << std::setw(9) << fmt_ms(hists[i]->percentile(0.99)) << std::endl;
+    }
+    std::cout << "        " << DIM << "phases of GET " << url << " on a keep-alive side connection"
+              << " during the run, in ms" << RESET << std::endl;
+}
+
+/**
+ * --profile: the per-stage breakdown of every sampled SDK call, then ping's
+ * "sdk" stage against a raw keep-alive libcurl GET of the same /health URL,
+ * which is the closest the harness gets to separating curl from the SDK's
+ * own serialization and parsing.
+ */
+static void print_profile_report(const drip::Config& config) {
+    RequestProfiler& prof = RequestProfiler::instance();
+    const char* names[ENDPOINT_COUNT];
+    for (size_t i = 0; i < ENDPOINT_COUNT; ++i) names[i] = endpoint_name(static_cast<Endpoint>(i));
+
+    std::cout << "--- Request Profile (1 in " << prof.every() << " calls sampled) ---" << std::endl << std::endl;
+    prof.write_report(std::cout, names, ENDPOINT_COUNT);
+
+    LatencyHistogram sdk_ping = prof.stages(static_cast<size_t>(Endpoint::PING))[static_cast<size_t>(ProfileStage::SDK)];
+    if (sdk_ping.count() > 0) {
+        HttpProbe probe(true, config.api_key);
+        std::string url = health_url(config);
+        probe.get(url);  // Open the connection; only warm requests are compared
+        LatencyHistogram raw;
+        for (int i = 0; i < 5; ++i) {
+            ProbeResult r = probe.get(url);
+            if (r.ok) raw.record(r.total_us);
+        }
+        if (raw.count() > 0) {
+            double sdk_us = sdk_ping.percentile(0.50) * prof.ns_per_tick() / 1000.0;
+            double curl_us = static_cast<double>(raw.percentile(0.50));
+            std::cout << std::endl << "  ping: sdk p50 " << fmt_ms(static_cast<int64_t>(sdk_us)) << "ms vs raw libcurl p50 "
+                      << fmt_ms(static_cast<int64_t>(curl_us)) << "ms, ~" << fmt_ms(static_cast<int64_t>(std::max(0.0, sdk_us - curl_us)))
+                      << "ms spent in the SDK around the transfer" << std::endl;
+        }
+    }
+    std::cout << "        " << DIM << "harness encode = the harness sizing a request body (not the SDK's own encoding)"
+              << RESET << std::endl << "        " << DIM << "sdk = the drip::Client call, "
+              << "error = DripError construct+throw+catch" << RESET << std::endl << std::endl;
+}
+
+static LatencyHistogram merged_latency(const BenchReport& r, uint64_t& errors) {
+    LatencyHistogram all;
+    errors = 0;
+    for (const auto& op : r.ops) {
+        all.merge(op.latency);
+        errors += op.errors;
+    }
+    return all;
+}
+
+/** --warm: open `n` of the pool's connections in parallel before the run starts. */
+static void warm_pool(ClientPool& pool, BenchClientMode mode, int n) {
+    if (n <= 0) return;
+    if (mode != CLIENTS_POOLED) {
+        std::cout << DIM << "--warm only applies to --clients pooled; skipping" << RESET << std::endl << std::endl;
+        return;
+    }
+    PoolWarmStats w = pool.warm(static_cast<size_t>(n));
+    std::cout << "Warmed " << w.warmed << " connection" << (w.warmed == 1 ? "" : "s") << " in "
+              << fmt_ms(w.elapsed_us) << "ms (slowest " << fmt_ms(w.slowest_us) << "ms)";
+    if (w.failed > 0) std::cout << RED << ", " << w.failed << " failed" << RESET;
+    if (w.unbuilt > 0) std::cout << RED << ", " << w.unbuilt << " could not be built" << RESET;
+    if (w.failed + w.unbuilt > 0) std::cout << RED << ": " << w.last_error << RESET;
+    std::cout << std::endl << std::endl;
+}
+
+/**
+ * Pooling off vs on: the same closed-loop bench with a fresh client per
+ * request and with clients leased from a pool, followed by a direct libcurl
+ * probe of /health that counts the connections each mode had to open.
+ */
+static uint64_t run_pool_compare(drip::Client& client, const drip::Config& config,
+                                 const std::string& customer_id, const BenchOptions& opts,
+                                 const std::vector<BenchOp>& ops) {
+    ClientPool pool(config, static_cast<size_t>(opts.concurrency));
+    BenchTarget fresh(client, &pool, CLIENTS_FRESH);
+    BenchTarget pooled(client, &pool, CLIENTS_POOLED);
+
+    std::cout << "  Pooling off (new client per request):" << std::endl;
+    BenchReport off = run_bench(fresh, customer_id, opts, ops);
+    print_bench_report(off);
+    std::cout << std::endl << "  Pooling on (" << opts.concurrency << " pooled clients):" << std::endl;
+    BenchReport on = run_bench(pooled, customer_id, opts, ops);
+    print_bench_report(on);
+
+    const int probes = 20;
+    std::string url = health_url(config);
+    LatencyHistogram probe_lat[2];
+    long handshakes[2] = {0, 0};
+    int probe_fail[2] = {0, 0};
+    std::string probe_err;
+    for (int mode = 0; mode < 2; ++mode) {
+        HttpProbe probe(mode == 1, config.api_key);
+        for (int i = 0; i < probes; ++i) {
+            ProbeResult r = probe.get(url);
+            if (!r.ok) {
+                ++probe_fail[mode];
+                probe_err = r.error;
+                continue;
+            }
+            handshakes[mode] += r.new_connections;
+            probe_lat[mode].record(r.total_us);
+        }
+    }
+
+    uint64_t off_err = 0, on_err = 0;
+    LatencyHistogram off_all = merged_latency(off, off_err);
+    LatencyHistogram on_all = merged_latency(on, on_err);
+
+    std::cout << std::endl << "  Comparison:" << std::endl;
+    std::cout << "  " << std::left << std::setw(26) << "mode" << std::right
+              << std::setw(10) << "clients" << std::setw(10) << "req/s"
+              << std::setw(9) << "p50" << std::setw(9) << "p99" << std::endl;
+    const BenchReport* reps[2] = {&off, &on};
+    const LatencyHistogram* hs[2] = {&off_all, &on_all};
+    const char* names[2] = {"sdk, pooling off", "sdk, pooling on"};
+    for (int m = 0; m < 2; ++m) {
+        std::cout << "  " << std::left << std::setw(26) << names[m] << std::right
+                  << std::setw(10) << reps[m]->clients
+                  << std::setw(10) << std::fixed << std::setprecision(1)
+                  << (reps[m]->elapsed_s > 0 ? hs[m]->count() / reps[m]->elapsed_s : 0.0)
+                  << std::setw(9) << fmt_ms(hs[m]->percentile(0.50))
+                  << std::setw(9) << fmt_ms(hs[m]->percentile(0.99)) << std::endl;
+    }
+
+    std::cout << std::endl << "  " << std::left << std::setw(26) << "transport probe" << std::right
+              << std::setw(10) << "connects" << std::setw(10) << "requests"
+              << std::setw(9) << "p50" << std::setw(9) << "p99" << std::endl;
+    const char* probe_names[2] = {"curl, new handle each", "curl, keep-alive + share"};
+    for (int m = 0; m < 2; ++m) {
+        std::cout << "  " << std::left << std::setw(26) << probe_names[m] << std::right
+                  << std::setw(10) << handshakes[m]
+                  << std::setw(10) << probe_lat[m].count()
+                  << std::setw(9) << fmt_ms(probe_lat[m].percentile(0.50))
+                  << std::setw(9) << fmt_ms(probe_lat[m].percentile(0.99)) << std::endl;
+    }
+    std::cout << "        " << DIM << "probe: " << probes << " sequential GET " << url
+              << ", connects = TCP+TLS handshakes reported by curl" << RESET << std::endl;
+    if (probe_fail[0] + probe_fail[1] > 0) {
+        std::cout << "        " << RED << "probe failures: " << (probe_fail[0] + probe_fail[1])
+                  << " (" << probe_err << ")" << RESET << std::endl;
+    }
+    return off_err + on_err;
+}
+
+static const char* curl_version_name(long v) {
+    switch (v) {
+        case CURL_HTTP_VERSION_1_0: return "1.0";
+        case CURL_HTTP_VERSION_1_1: return "1.1";
+        case CURL_HTTP_VERSION_2_0: return "2";
+        default: return "?";
+    }
+}
+
+/**
+ * Throughput at increasing numbers of concurrent logical requests. The SDK
+ * has no multiplexed transport to switch on, so each level is measured two
+ * ways: through the SDK with pooled clients capped at max_connections (so
+ * logical requests queue for a connection instead of each opening a socket),
+ * and directly with libcurl, putting the same number of GETs in flight over
+ * HTTP/1.1 (capped connections) and over multiplexed HTTP/2.
+ */
+static uint64_t run_concurrency_sweep(drip::Client& client, const drip::Config& config,
+                                      const std::string& customer_id, const BenchOptions& opts,
+                                      const std::vector<BenchOp>& ops, const std::vector<int>& levels,
+                                      int max_connections) {
+    uint64_t total_errors = 0;
+    std::cout << "  SDK, pooled clients capped at " << max_connections << " connections:" << std::endl;
+    std::cout << "  " << std::left << std::setw(12) << "in-flight" << std::right
+              << std::setw(10) << "req/s" << std::setw(9) << "p50" << std::setw(9) << "p99"
+              << std::setw(9) << "max" << std::setw(8) << "errors" << std::endl;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        BenchOptions level_opts = opts;
+        level_opts.concurrency = levels[i];
+        ClientPool pool(config, static_cast<size_t>(max_connections));
+        BenchTarget target(client, &pool, CLIENTS_POOLED);
+        BenchReport r = run_bench(target, customer_id, level_opts, ops);
+
+        uint64_t errors = 0;
+        LatencyHistogram all = merged_latency(r, errors);
+        total_errors += errors;
+        std::cout << "  " << std::left << std::setw(12) << levels[i] << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(1)
+                  << (r.elapsed_s > 0 ? all.count() / r.elapsed_s : 0.0)
+                  << std::setw(9) << fmt_ms(all.percentile(0.50))
+                  << std::setw(9) << fmt_ms(all.percentile(0.99))
+                  << std::setw(9) << fmt_ms(all.max())
+                  << std::setw(8) << errors << std::endl;
+        for (const auto& err : r.errors) {
+            std::cout << "        " << RED << "ERROR: " << err << RESET << std::endl;
+        }
+    }
+
+    std::string url = health_url(config);
+    std::cout << std::endl << "  Transport probe, GET " << url << " with all requests in flight:" << std::endl;
+    std::cout << "  " << std::left << std::setw(12) << "in-flight" << std::right
+              << std::setw(8) << "proto" << std::setw(8) << "conns" << std::setw(10) << "req/s"
+              << std::setw(9) << "p50" << std::setw(9) << "p99" << std::setw(8) << "failed" << std::endl;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        for (int h2 = 0; h2 < 2; ++h2) {
+            ConcurrentProbeResult p = probe_concurrent(url, config.api_key, levels[i], h2 == 1, max_connections);
+            std::cout << "  " << std::left << std::setw(12) << levels[i] << std::right
+                      << std::setw(8) << (p.ok ? curl_version_name(p.http_version) : (h2 ? "2" : "1.1"))
+                      << std::setw(8) << p.connections
+                      << std::setw(10) << std::fixed << std::setprecision(1)
+                      << (p.wall_us > 0 ? p.ok * 1e6 / p.wall_us : 0.0)
+                      << std::setw(9) << fmt_ms(p.latency.percentile(0.50))
+                      << std::setw(9) << fmt_ms(p.latency.percentile(0.99))
+                      << std::setw(8) << p.failed << std::endl;
+            if (p.failed > 0) {
+                std::cout << "        " << RED << "ERROR: " << p.error << RESET << std::endl;
+            }
+        }
+    }
+    return total_errors;
+}
+
+/**
+ * trackUsage throughput at 1..N threads, once with every thread on the one
+ * shared client and once with a ShardedClient (a client per thread). If the
+ * shared client's internals serialize callers, its column flattens while
+ * the sharded one keeps climbing; efficiency is sharded req/s divided by
+ * threads x the single-thread rate, so 100% is perfectly linear.
+ */
+static uint64_t run_scaling_bench(drip::Client& client, const drip::Config& config,
+                                  const std::string& customer_id, const BenchOptions& opts,
+                                  const std::vector<int>& levels, bool pin_threads) {
+    BenchOp track;
+    make_bench_op("track", track);
+    std::vector<BenchOp> ops(1, track);
+    uint64_t total_errors = 0;
+    double base_rps = 0;
+
+    std::cout << "  trackUsage, " << opts.duration_s << "s per level"
+              << (pin_threads ? ", sharded threads pinned to CPUs" : "") << ":" << std::endl;
+    std::cout << "  " << std::left << std::setw(9) << "threads" << std::right
+              << std::setw(12) << "shared/s" << std::setw(9) << "p99"
+              << std::setw(12) << "sharded/s" << std::setw(9) << "p99"
+              << std::setw(9) << "speedup" << std::setw(11) << "efficiency"
+              << std::setw(8) << "errors" << std::endl;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        BenchOptions level_opts = opts;
+        level_opts.concurrency = levels[i];
+
+        BenchTarget shared(client, nullptr, CLIENTS_SHARED);
+        BenchReport s = run_bench(shared, customer_id, level_opts, ops);
+        ShardedClient sharded_clients(config, static_cast<size_t>(levels[i]), pin_threads);
+        BenchTarget sharded(client, nullptr, CLIENTS_SHARDED, nullptr, &sharded_clients);
+        BenchReport p = run_bench(sharded, customer_id, level_opts, ops);
+
+        uint64_t s_err = 0, p_err = 0;
+        LatencyHistogram s_all = merged_latency(s, s_err);
+        LatencyHistogram p_all = merged_latency(p, p_err);
+        total_errors += s_err + p_err;
+        double s_rps = s.elapsed_s > 0 ? s_all.count() / s.elapsed_s : 0.0;
+        double p_rps = p.elapsed_s > 0 ? p_all.count() / p.elapsed_s : 0.0;
+        if (i == 0) base_rps = p_rps / levels[0];
+
+        std::cout << "  " << std::left << std::setw(9) << levels[i] << std::right
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << s_rps << std::setw(9) << fmt_ms(s_all.percentile(0.99))
+                  << std::setw(12) << p_rps << std::setw(9) << fmt_ms(p_all.percentile(0.99))
+                  << std::setw(8) << (s_rps > 0 ? p_rps / s_rps : 0.0) << "x"
+                  << std::setw(10) << (base_rps > 0 ? 100.0 * p_rps / (base_rps * levels[i]) : 0.0) << "%"
+                  << std::setw(8) << (s_err + p_err) << std::endl;
+        for (const auto& err : s.errors) std::cout << "        " << RED << "ERROR (shared): " << err << RESET << std::endl;
+        for (const auto& err : p.errors) std::cout << "        " << RED << "ERROR (sharded): " << err << RESET << std::endl;
+    }
+    std::cout << "        " << DIM << "speedup = sharded vs shared at the same thread count; efficiency vs "
+              << levels[0] << " thread(s) scaled linearly" << RESET << std::endl;
+    return total_errors;
+}
+
+/**
+ * Tenant onboarding: provision `count` customers through BulkCustomers and
+ * compare customers/s against the one-call-at-a-time loop the checks use
+ * (timed on a sample, so a 50k run doesn't spend an hour on the baseline).
+ * Then re-provision a slice to confirm the bulk path is idempotent on
+ * external_customer_id, and fetch everything back with getCustomers().
+ */
+static int run_bulk_customer_bench(drip::Client& client, const drip::Config& config, int count,
+                                   const BulkCustomerOptions& opts, PerfReport& perf) {
+    const int sample = std::min(count, 200);
+    std::string prefix = "cpp_bulk_" + std::to_string(now_ms()) + "_";
+    std::vector<drip::CreateCustomerParams> params(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        params[i].external_customer_id = prefix + std::to_string(i);
+        params[i].metadata["source"] = "cpp_bulk_bench";
+    }
+
+    std::cout << "  " << count << " customers, chunks of " << opts.chunk_size << " on "
+              << opts.parallelism << " threads (single-call loop timed on " << sample << "):" << std::endl;
+    std::cout << "  " << std::left << std::setw(26) << "operation" << std::right << std::setw(10) << "customers"
+              << std::setw(10) << "seconds" << std::setw(13) << "customers/s" << std::setw(9) << "speedup"
+              << std::setw(8) << "errors" << std::endl;
+    auto row = [&](const std::string& name, size_t n, int64_t us, size_t errors, double baseline_rate) {
+        double rate = us > 0 ? n * 1e6 / us : 0.0;
+        std::cout << "  " << std::left << std::setw(26) << name << std::right << std::setw(10) << n
+                  << std::fixed << std::setprecision(2) << std::setw(10) << us / 1e6
+                  << std::setprecision(1) << std::setw(13) << rate;
+        if (baseline_rate > 0) std::cout << std::setw(8) << rate / baseline_rate << "x";
+        else std::cout << std::setw(9) << "-";
+        std::cout << std::setw(8) << errors << std::endl;
+        PerfEntry e = perf_entry("bulk", name, us / 1000.0, errors == 0);
+        e.count = n;
+        e.errors = errors;
+        e.throughput_rps = rate;
+        perf.add(e);
+        return rate;
+    };
+
+    // Baseline: the sequential loop, sample-sized, under its own external IDs
+    size_t loop_errors = 0;
+    std::vector<std::string> loop_ids;
+    int64_t t0 = now_us();
+    for (int i = 0; i < sample; ++i) {
+        drip::CreateCustomerParams p = params[i];
+        p.external_customer_id = prefix + "loop_" + std::to_string(i);
+        try {
+            loop_ids.push_back(metered(Endpoint::CREATE_CUSTOMER, [&] { return client.createCustomer(p); }).id);
+        } catch (const drip::DripError&) {
+            ++loop_errors;
+        }
+    }
+    double create_base = row("createCustomer loop", static_cast<size_t>(sample), now_us() - t0, loop_errors, 0);
+
+    ClientPool pool(config, opts.parallelism);
+    Retrier retrier;
+    BulkCustomers bulk(pool, opts, &retrier);
+    BulkCustomerStats created;
+    std::vector<BulkCustomerOutcome> first = bulk.createCustomers(params, &created);
+    row("createCustomers (bulk)", created.requested, created.elapsed_us, created.failed, create_base);
+
+    // Idempotency: the same external IDs again must come back as the same customers
+    std::vector<drip::CreateCustomerParams> again(params.begin(), params.begin() + std::min(count, 500));
+    BulkCustomerStats rerun;
+    std::vector<BulkCustomerOutcome> second = bulk.createCustomers(again, &rerun);
+    size_t mismatched = 0;
+    for (size_t i = 0; i < second.size(); ++i) {
+        if (!second[i].ok || !first[i].ok || second[i].customer.id != first[i].customer.id) ++mismatched;
+    }
+    row("createCustomers (re-run)", rerun.requested, rerun.elapsed_us, mismatched, create_base);
+
+    size_t get_errors = 0;
+    t0 = now_us();
+    for (size_t i = 0; i < loop_ids.size(); ++i) {
+        try {
+            metered(Endpoint::GET_CUSTOMER, [&] { return client.getCustomer(loop_ids[i]); });
+        } catch (const drip::DripError&) {
+            ++get_errors;
+        }
+    }
+    double get_base = row("getCustomer loop", loop_ids.size(), now_us() - t0, get_errors, 0);
+
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < first.size(); ++i) {
+        if (first[i].ok) ids.push_back(first[i].customer.id);
+    }
+    BulkCustomerStats fetched;
+    bulk.getCustomers(ids, &fetched);
+    row("getCustomers (bulk)", fetched.requested, fetched.elapsed_us, fetched.failed, get_base);
+
+    std::cout << "        " << DIM << created.calls << " create calls in " << created.chunks << " chunks, "
+              << rerun.existing << "/" << rerun.requested << " re-run entries already existed, "
+              << retrier.stats().retries << " retries" << RESET << std::endl;
+    for (size_t i = 0; i < first.size(); ++i) {
+        if (first[i].ok) continue;
+        std::cout << "        " << RED << "ERROR: " << params[i].external_customer_id << ": "
+                  << first[i].error << RESET << std::endl;
+        break;
+    }
+    if (mismatched > 0) {
+        std::cout << "        " << RED << mismatched << " re-provisioned customers came back with a different ID"
+                  << RESET << std::endl;
+    }
+    return loop_errors + created.failed + mismatched + get_errors + fetched.failed > 0 ? 1 : 0;
+}
+
+// =============================================================================
+// Machine-readable results (--json) and regression gate (--baseline)
+// =============================================================================
+
+/** One "bench" entry per op plus a "total" entry carrying the error breakdown. */
+static void add_bench_entries(PerfReport& perf, const BenchReport& r) {
+    LatencyHistogram all;
+    uint64_t all_errors = 0;
+    for (size_t i = 0; i < r.ops.size(); ++i) {
+        perf.add(perf_entry("bench", r.op_names[i], r.ops[i].latency, r.ops[i].errors, r.elapsed_s));
+        all.merge(r.ops[i].latency);
+        all_errors += r.ops[i].errors;
+    }
+    PerfEntry total = perf_entry("bench", "total", all, all_errors, r.elapsed_s);
+    total.errors_by_kind = r.error_counts;
+    perf.add(total);
+}
+
+// =============================================================================
+// Distributed bench (one coordinator, N worker processes)
+// =============================================================================
+
+/*
+ * One drip-health process can't push past its host's NIC, CPU or ephemeral
+ * ports, so --coordinator hands the bench plan to N --worker processes,
+ * starts them together and merges their histograms into one report. The
+ * protocol is one text line per message over a single TCP connection:
+ *
+ *   worker -> HELLO <host>
+ *   coord  -> PLAN worker=<i> ops=<list> concurrency=<n> duration=<s> rps=<r>
+ *             open_loop=<0|1> poisson=<0|1> clients=<mode> governor=<0|1>
+ *             connections=<n> pin=<0|1>
+ *   worker -> READY                 (customer resolved)  or  FAILED <reason>
+ *   coord  -> START <delay_ms>      (to every worker once all are READY)
+ *   worker -> REPORT <elapsed_s> <open_loop> <scheduled> <late> <clients>
+ *             OP <errors> <name>, LATENCY <hist>, SERVICE <hist>  (per op)
+ *             ERROR <message>  (up to ErrorCollector::max_capture)
+ *             ERRKIND <count> <kind>  (per error_kind())
+ *             END
+ *
+ * START carries a delay rather than a wall-clock time so workers need no
+ * synchronised clocks: they begin within one network hop of each other.
+ * --rps is the total across workers; each worker gets an equal share, and
+ * with --governor each worker's token bucket runs at that share. --warm and
+ * --faults are the worker's own options; modes that replace the plain bench
+ * (--sweep, --scaling, --pool-compare, --bulk-customers) are rejected.
+ */
+
+struct DistributedPlan {
+    int worker_index = 0;
+    std::string ops;
+    BenchOptions opts;
+    BenchClientMode clients = CLIENTS_SHARED;
+    bool governor = false;
+    int connections = 0;  // Pooled client cap; 0 = one per worker thread
+    bool pin = false;
+};
+
+static const int DISTRIBUTED_START_DELAY_MS = 500;
+
+static std::string format_plan(const DistributedPlan& p) {
+    std::ostringstream out;
+    out << "PLAN worker=" << p.worker_index << " ops=" << p.ops
+        << " concurrency=" << p.opts.concurrency << " duration=" << p.opts.duration_s
+        << " rps=" << p.opts.target_rps << " open_loop=" << (p.opts.open_loop ? 1 : 0)
+        << " poisson=" << (p.opts.poisson ? 1 : 0) << " clients=" << client_mode_name(p.clients)
+        << " governor=" << (p.governor ? 1 : 0) << " connections=" << p.connections << " pin=" << (p.pin ? 1 : 0);
+    return out.str();
+}
+
+static bool parse_plan(const std::string& line, DistributedPlan& p) {
+    std::istringstream in(line);
+    std::string word;
+    if (!(in >> word) || word != "PLAN") return false;
+    while (in >> word) {
+        size_t eq = word.find('=');
+        if (eq == std::string::npos) return false;
+        std::string key = word.substr(0, eq);
+        std::string value = word.substr(eq + 1);
+        if (key == "worker") p.worker_index = std::atoi(value.c_str());
+        else if (key == "ops") p.ops = value;
+        else if (key == "concurrency") p.opts.concurrency = std::atoi(value.c_str());
+        else if (key == "duration") p.opts.duration_s = std::atoi(value.c_str());
+        else if (key == "rps") p.opts.target_rps = std::atof(value.c_str());
+        else if (key == "open_loop") p.opts.open_loop = value == "1";
+        else if (key == "poisson") p.opts.poisson = value == "1";
+        else if (key == "clients") p.clients = parse_client_mode(value);
+        else if (key == "governor") p.governor = value == "1";
+        else if (key == "connections") p.connections = std::atoi(value.c_str());
+        else if (key == "pin") p.pin = value == "1";
+    }
+    return !p.ops.empty() && p.opts.concurrency >= 1 && p.opts.duration_s >= 1;
+}
+
+static bool send_bench_report(LineSocket& sock, const BenchReport& r) {
+    std::ostringstream out;
+    out << "REPORT " << r.elapsed_s << " " << (r.open_loop ? 1 : 0) << " " << r.scheduled
+        << " " << r.late << " " << r.clients << "\n";
+    for (size_t i = 0; i < r.ops.size(); ++i) {
+        out << "OP " << r.ops[i].errors << " " << r.op_names[i] << "\n"
+            << "LATENCY " << r.ops[i].latency.serialize() << "\n"
+            << "SERVICE " << r.ops[i].service.serialize() << "\n";
+    }
+    for (std::string err : r.errors) {
+        std::replace(err.begin(), err.end(), '\n', ' ');
+        out << "ERROR " << err << "\n";
+    }
+    for (const auto& kv : r.error_counts) out << "ERRKIND " << kv.second << " " << kv.first << "\n";
+    out << "END\n";
+    return sock.send_all(out.str());
+}
+
+static bool read_bench_report(LineSocket& sock, BenchReport& r, std::string& error) {
+    std::string line;
+    if (!sock.read_line(line)) {
+        error = sock.error();
+        return false;
+    }
+    std::istringstream head(line);
+    std::string word;
+    int open_loop = 0;
+    if (!(head >> word >> r.elapsed_s >> open_loop >> r.scheduled >> r.late >> r.clients) || word != "REPORT") {
+        error = "unexpected reply: " + line.substr(0, 80);
+        return false;
+    }
+    r.open_loop = open_loop != 0;
+    while (sock.read_line(line)) {
+        if (line == "END") return true;
+        if (line.compare(0, 3, "OP ") == 0) {
+            std::istringstream op(line.substr(3));
+            BenchOpStats stats;
+            std::string name;
+            op >> stats.errors >> name;
+            r.op_names.push_back(name);
+            r.ops.push_back(stats);
+        } else if (line.compare(0, 8, "LATENCY ") == 0 && !r.ops.empty()) {
+            if (!r.ops.back().latency.deserialize(line.substr(8))) break;
+        } else if (line.compare(0, 8, "SERVICE ") == 0 && !r.ops.empty()) {
+            if (!r.ops.back().service.deserialize(line.substr(8))) break;
+        } else if (line.compare(0, 6, "ERROR ") == 0) {
+            r.errors.push_back(line.substr(6));
+        } else if (line.compare(0, 8, "ERRKIND ") == 0) {
+            std::istringstream kind(line.substr(8));
+            uint64_t n = 0;
+            std::string name;
+            if (kind >> n >> name) r.error_counts[name] += n;
+        } else {
+            break;
+        }
+    }
+    error = "malformed report (" + (sock.error().empty() ? line.substr(0, 80) : sock.error()) + ")";
+    return false;
+}
+
+/** Fold one worker's report into the combined one; workers ran side by side, so elapsed is the longest. */
+static void merge_bench_report(BenchReport& into, const BenchReport& from) {
+    for (size_t i = 0; i < from.ops.size(); ++i) {
+        size_t j = std::find(into.op_names.begin(), into.op_names.end(), from.op_names[i]) - into.op_names.begin();
+        if (j == into.op_names.size()) {
+            into.op_names.push_back(from.op_names[i]);
+            into.ops.push_back(BenchOpStats());
+        }
+        into.ops[j].latency.merge(from.ops[i].latency);
+        into.ops[j].service.merge(from.ops[i].service);
+        into.ops[j].errors += from.ops[i].errors;
+    }
+    into.elapsed_s = std::max(into.elapsed_s, from.elapsed_s);
+    into.open_loop = into.open_loop || from.open_loop;
+    into.scheduled += from.scheduled;
+    into.late += from.late;
+    into.clients += from.clients;
+    for (const auto& err : from.errors) {
+        if (into.errors.size() >= ErrorCollector::max_capture) break;
+        into.errors.push_back(err);
+    }
+    for (const auto& kv : from.error_counts) into.error_counts[kv.first] += kv.second;
+}
+
+/** --coordinator: hand out the plan, start every worker together, merge what they report. */
+static int run_coordinator(int port, int workers, const DistributedPlan& base, PerfReport& perf) {
+    const std::string& ops = base.ops;
+    const BenchOptions& opts = base.opts;
+    LineListener listener(port);
+    if (!listener.valid()) {
+        std::cerr << RED << listener.error() << RESET << std::endl;
+        return 1;
+    }
+    std::cout << "\n--- Distributed Benchmark ---\n" << std::endl;
+    std::cout << "Waiting for " << workers << " worker(s) on port " << port << "..." << std::endl;
+
+    struct Peer {
+        LineSocket sock;
+        std::string name;
+    };
+    std::vector<Peer> peers;
+    while (static_cast<int>(peers.size()) < workers) {
+        std::string addr;
+        LineSocket sock = listener.accept(addr);
+        if (!sock.valid()) continue;
+        sock.set_receive_timeout(10000);
+        std::string line;
+        if (!sock.read_line(line) || line.compare(0, 6, "HELLO ") != 0) {
+            std::cerr << RED << "Ignoring connection from " << addr << " (no HELLO)" << RESET << std::endl;
+            continue;
+        }
+        DistributedPlan plan = base;
+        plan.worker_index = static_cast<int>(peers.size());
+        plan.opts.target_rps = opts.target_rps / workers;
+        if (!sock.send_line(format_plan(plan))) continue;
+        Peer peer{std::move(sock), line.substr(6) + " (" + addr + ")"};
+        std::cout << "  worker " << peers.size() << ": " << peer.name << std::endl;
+        peers.push_back(std::move(peer));
+    }
+
+    // Workers resolve their customer before READY, which can take a few round trips.
+    for (auto& peer : peers) {
+        peer.sock.set_receive_timeout(120000);
+        std::string line;
+        if (!peer.sock.read_line(line) || line != "READY") {
+            std::cerr << RED << "Worker " << peer.name << " is not ready: "
+                      << (line.empty() ? peer.sock.error() : line) << RESET << std::endl;
+            for (auto& p : peers) p.sock.send_line("ABORT");
+            return 1;
+        }
+    }
+    for (auto& peer : peers) peer.sock.send_line("START " + std::to_string(DISTRIBUTED_START_DELAY_MS));
+
+    std::cout << std::endl << "Running " << workers << " x " << opts.concurrency << " workers for "
+              << opts.duration_s << "s";
+    if (opts.target_rps > 0) std::cout << " at " << opts.target_rps << " req/s total";
+    if (opts.open_loop) std::cout << ", open loop (" << (opts.poisson ? "poisson" : "uniform") << " arrivals)";
+    std::cout << " (ops: " << ops << ")" << std::endl << std::endl;
+
+    BenchReport merged;
+    std::vector<BenchReport> reports(peers.size());
+    std::vector<std::string> failures(peers.size());
+    for (size_t i = 0; i < peers.size(); ++i) {
+        peers[i].sock.set_receive_timeout((opts.duration_s + 120) * 1000);
+        if (read_bench_report(peers[i].sock, reports[i], failures[i])) merge_bench_report(merged, reports[i]);
+    }
+    print_bench_report(merged);
+    add_bench_entries(perf, merged);
+
+    std::cout << std::endl << "  " << std::left << std::setw(36) << "worker" << std::right
+              << std::setw(9) << "count" << std::setw(8) << "errors" << std::setw(10) << "req/s"
+              << std::setw(9) << "p50" << std::setw(9) << "p99" << std::endl;
+    uint64_t errors = 0;
+    int failed = 0;
+    for (size_t i = 0; i < peers.size(); ++i) {
+        std::cout << "  " << std::left << std::setw(36) << peers[i].name.substr(0, 35) << std::right;
+        if (!failures[i].empty()) {
+            std::cout << RED << "  no report: " << failures[i] << RESET << std::endl;
+            ++failed;
+            continue;
+        }
+        uint64_t worker_errors = 0;
+        LatencyHistogram all = merged_latency(reports[i], worker_errors);
+        errors += worker_errors;
+        std::cout << std::setw(9) << all.count() << std::setw(8) << worker_errors
+                  << std::setw(10) << std::fixed << std::setprecision(1)
+                  << (reports[i].elapsed_s > 0 ? all.count() / reports[i].elapsed_s : 0.0)
+                  << std::setw(9) << fmt_ms(all.percentile(0.50))
+                  << std::setw(9) << fmt_ms(all.percentile(0.99)) << std::endl;
+    }
+    std::cout << std::endl;
+    return errors > 0 || failed > 0 ? 1 : 0;
+}
+
+/** --worker: fetch the plan from the coordinator, run it when told to, send the report back. */
+static int run_bench_worker(drip::Client& client, const drip::Config& config,
+                            const std::string& test_customer_id, const std::string& address, int warm,
+                            const FaultOptions& faults) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon == 0) {
+        std::cerr << RED << "--worker needs HOST:PORT, got " << address << RESET << std::endl;
+        return 1;
+    }
+    std::string host = address.substr(0, colon);
+    int port = std::atoi(address.c_str() + colon + 1);
+
+    // Workers are often launched before the coordinator is listening.
+    LineSocket sock;
+    for (int attempt = 0; attempt < 30; ++attempt) {
+        sock = LineSocket::connect(host, port);
+        if (sock.valid()) break;
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    if (!sock.valid()) {
+        std::cerr << RED << sock.error() << RESET << std::endl;
+        return 1;
+    }
+
+    sock.set_receive_timeout(10000);
+    std::string line;
+    DistributedPlan plan;
+    if (!sock.send_line("HELLO " + local_hostname()) || !sock.read_line(line) || !parse_plan(line, plan)) {
+        std::cerr << RED << "No plan from coordinator at " << address << ": "
+                  << (line.empty() ? sock.error() : line) << RESET << std::endl;
+        return 1;
+    }
+    std::cout << "\n--- Distributed Benchmark (worker " << plan.worker_index << ") ---\n" << std::endl;
+
+    std::vector<BenchOp> ops;
+    for (const auto& name : split_csv(plan.ops)) {
+        BenchOp op;
+        if (!make_bench_op(name, op)) {
+            sock.send_line("FAILED unknown op " + name);
+            return 1;
+        }
+        ops.push_back(op);
+    }
+    std::string customer_id;
+    if (!prepare_load_run(client, test_customer_id, customer_id, "distributed benchmark")) {
+        sock.send_line("FAILED no customer");
+        return 1;
+    }
+    plan.opts.tag_prefix = "bench_w" + std::to_string(plan.worker_index);
+    ClientPool pool(config, static_cast<size_t>(plan.connections > 0 ? plan.connections : plan.opts.concurrency));
+    warm_pool(pool, plan.clients, warm);  // Before READY, so START finds every connection open
+    BenchOptions run_opts = plan.opts;
+    std::unique_ptr<ClientGovernor> governor;
+    if (plan.governor) governor = make_bench_governor(plan.opts, run_opts);
+    FaultInjector::instance().configure(faults);
+
+    sock.send_line("READY");
+    sock.set_receive_timeout(0);  // Other workers may still be joining
+    if (!sock.read_line(line) || line.compare(0, 6, "START ") != 0) {
+        std::cerr << RED << "Coordinator did not start the run: " << (line.empty() ? sock.error() : line)
+                  << RESET << std::endl;
+        return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(std::atoi(line.c_str() + 6)));
+
+    std::cout << "Running " << plan.opts.concurrency << " workers for " << plan.opts.duration_s << "s";
+    if (plan.opts.target_rps > 0) std::cout << " at " << plan.opts.target_rps << " req/s";
+    std::cout << " (ops: " << plan.ops << ")" << std::endl << std::endl;
+    ShardedClient sharded(config, static_cast<size_t>(plan.opts.concurrency), plan.pin);
+    BenchTarget target(client, &pool, plan.clients, governor.get(), &sharded);
+    BenchReport report = run_opts.open_loop
+        ? run_bench_open_loop(target, customer_id, run_opts, ops)
+        : run_bench(target, customer_id, run_opts, ops);
+    if (governor) {
+        report.governed = true;
+        report.governor = governor->stats();
+    }
+    print_bench_report(report);
+    std::cout << std::endl;
+
+    if (!send_bench_report(sock, report)) {
+        std::cerr << RED << "Could not send the report: " << sock.error() << RESET << std::endl;
+        return 1;
+    }
+    uint64_t errors = 0;
+    merged_latency(report, errors);
+    return errors > 0 ? 1 : 0;
+}
+
+// =============================================================================
+// Reporter
+// =============================================================================
+
+/** Writes the ClientMetrics dump when main() returns, whichever mode ran. */
+struct MetricsDump {
+    bool enabled;
+    std::string path;  // Empty = stdout
+
+    ~MetricsDump() {
+        if (!enabled) return;
+        if (path.empty()) {
             std::cout << std::endl;
+            ClientMetrics::instance().write_prometheus(std::cout);
+            return;
         }
+        std::ofstream out(path.c_str());
+        if (out) ClientMetrics::instance().write_prometheus(out);
+        else std::cerr << RED << "Could not write metrics to " << path << RESET << std::endl;
+    }
+};
 
-        // --race: Run concurrent race-condition tests only
-        if (race) {
-            std::cout << "\n--- Race Condition Tests ---\n" << std::endl;
+/** Prints what --faults / --offline injected when main() returns, if anything. */
+struct FaultSummary {
+    ~FaultSummary() {
+        FaultInjector& faults = FaultInjector::instance();
+        if (!faults.active()) return;
+        std::cout << DIM;
+        faults.write_summary(std::cout);
+        std::cout << RESET << std::endl << std::endl;
+    }
+};
+
+/** Writes the Chrome trace to `path` (if set) when main() returns. */
+struct TraceDump {
+    std::string path;
+
+    ~TraceDump() {
+        if (path.empty()) return;
+        std::ofstream out(path.c_str());
+        if (out) TraceRecorder::instance().write_json(out);
+        else std::cerr << RED << "Could not write trace to " << path << RESET << std::endl;
+    }
+};
+
+static void print_result(const CheckResult& r, bool verbose) {
+    const char* icon = r.success ? GREEN : RED;
+    const char* status = r.success ? "PASS" : "FAIL";
+
+    std::cout << "  " << icon << "[" << status << "]" << RESET
+              << " " << r.name
+              << DIM << " (" << r.duration_ms << "ms)" << RESET
+              << std::endl;
+
+    if (!r.message.empty()) {
+        std::cout << "        " << r.message << std::endl;
+    }
+
+    if (verbose && !r.details.empty()) {
+        std::cout << "        " << DIM << r.details << RESET << std::endl;
+    }
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    bool verbose = false;
+    bool race = false;
+    bool parallel = false;
+    bool bench = false;
+    bool pool_compare = false;
+    BenchOptions bench_opts;
+    BenchClientMode client_mode = CLIENTS_SHARED;
+    int max_connections = 0;  // 0 = one pooled client per worker
+    bool use_governor = false;
+    bool metrics = false;
+    std::string trace_out;
+    std::string metrics_out;  // Empty = stdout
+    std::vector<int> sweep_levels;
+    std::vector<int> scaling_levels;
+    bool pin_threads = false;
+    std::string bench_ops = "track,balance,list,run";
+    int coordinator_port = 0;
+    int distributed_workers = 1;
+    std::string worker_address;  // HOST:PORT of a coordinator
+    PerfOutput perf_out;
+    std::string max_regress;
+    int bulk_customers = 0;
+    int bulk_chunk = 100;
+    int scan_pages = 5;  // 0 = every page
+    int warm_connections = 0;
+    int profile_every = 0;  // 0 = off
+    FaultOptions faults;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) quick = true;
+        else if (std::strcmp(argv[i], "--verbose") == 0 || std::strcmp(argv[i], "-v") == 0) verbose = true;
+        else if (std::strcmp(argv[i], "--race") == 0) race = true;
+        else if (std::strcmp(argv[i], "--parallel") == 0) parallel = true;
+        else if (std::strcmp(argv[i], "--bench") == 0) bench = true;
+        else if (std::strcmp(argv[i], "--concurrency") == 0 && i + 1 < argc) bench_opts.concurrency = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--duration") == 0 && i + 1 < argc) bench_opts.duration_s = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--rps") == 0 && i + 1 < argc) bench_opts.target_rps = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--ops") == 0 && i + 1 < argc) bench_ops = argv[++i];
+        else if (std::strcmp(argv[i], "--open-loop") == 0) bench_opts.open_loop = true;
+        else if (std::strcmp(argv[i], "--arrivals") == 0 && i + 1 < argc) {
+            const char* kind = argv[++i];
+            if (std::strcmp(kind, "poisson") != 0 && std::strcmp(kind, "uniform") != 0) {
+                std::cerr << RED << "--arrivals: expected poisson or uniform, got " << kind << RESET << std::endl;
+                return 1;
+            }
+            bench_opts.poisson = std::strcmp(kind, "poisson") == 0;
+        }
+        else if (std::strcmp(argv[i], "--clients") == 0 && i + 1 < argc) client_mode = parse_client_mode(argv[++i]);
+        else if (std::strcmp(argv[i], "--pool-compare") == 0) { bench = true; pool_compare = true; }
+        else if (std::strcmp(argv[i], "--connections") == 0 && i + 1 < argc) max_connections = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--warm") == 0 && i + 1 < argc) warm_connections = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--governor") == 0) use_governor = true;
+        else if (std::strcmp(argv[i], "--metrics") == 0) metrics = true;
+        else if (std::strcmp(argv[i], "--scan-pages") == 0 && i + 1 < argc) scan_pages = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) trace_out = argv[++i];
+        else if (std::strcmp(argv[i], "--profile") == 0) { if (profile_every == 0) profile_every = 1; }
+        else if (std::strcmp(argv[i], "--profile-sample") == 0 && i + 1 < argc) profile_every = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--metrics-out") == 0 && i + 1 < argc) { metrics = true; metrics_out = argv[++i]; }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) perf_out.json_path = argv[++i];
+        else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) perf_out.baseline_path = argv[++i];
+        else if (std::strcmp(argv[i], "--max-regress") == 0 && i + 1 < argc) max_regress = argv[++i];
+        else if (std::strcmp(argv[i], "--coordinator") == 0 && i + 1 < argc) { bench = true; coordinator_port = std::atoi(argv[++i]); }
+        else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) distributed_workers = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--worker") == 0 && i + 1 < argc) worker_address = argv[++i];
+        else if (std::strcmp(argv[i], "--scaling") == 0) { bench = true; if (scaling_levels.empty()) scaling_levels = {1, 2, 4, 8, 16, 32, 64}; }
+        else if (std::strcmp(argv[i], "--scaling-threads") == 0 && i + 1 < argc) {
+            bench = true;
+            scaling_levels.clear();
+            for (const auto& level : split_csv(argv[++i])) scaling_levels.push_back(std::atoi(level.c_str()));
+        }
+        else if (std::strcmp(argv[i], "--pin") == 0) pin_threads = true;
+        else if (std::strcmp(argv[i], "--bulk-customers") == 0 && i + 1 < argc) bulk_customers = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--bulk-chunk") == 0 && i + 1 < argc) bulk_chunk = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--faults") == 0 && i + 1 < argc) {
+            std::string error;
+            if (!faults.parse(argv[++i], error)) {
+                std::cerr << RED << "--faults: " << error << RESET << std::endl;
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--offline") == 0) faults.offline = true;
+        else if (std::strcmp(argv[i], "--sweep") == 0 && i + 1 < argc) {
+            bench = true;
+            for (const auto& level : split_csv(argv[++i])) sweep_levels.push_back(std::atoi(level.c_str()));
+        }
+        else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            std::cout << "Usage: drip-health [OPTIONS]\n\n"
+                      << "Options:\n"
+                      << "  --quick      Run connectivity checks only\n"
+                      << "  --race       Run concurrent race-condition tests\n"
+                      << "  --parallel   Run independent checks concurrently\n"
+                      << "  --bench      Run sustained-load benchmark\n"
+                      << "  --verbose    Show extra details\n"
+                      << "  --metrics    Print per-endpoint SDK metrics (Prometheus text) on exit\n"
+                      << "  --metrics-out FILE  Write them to FILE instead\n"
+                      << "  --scan-pages N      Pages the customer scan check walks (default: 5, 0 = all)\n"
+                      << "  --trace FILE        Write a Chrome trace-event JSON of every SDK call\n"
+                      << "  --profile           Per-endpoint encode/sdk/error time of sampled calls\n"
+                      << "                      (needs a DRIP_PROFILE=1 build: make PROFILE=1)\n"
+                      << "  --profile-sample N  Profile 1 in N calls per thread (default: 1; implies --profile)\n"
+                      << "  --json FILE         Write check/bench latency, throughput and errors as JSON\n"
+                      << "  --baseline FILE     Fail if p99, throughput or error rate regressed vs an\n"
+                      << "                      earlier --json\n"
+                      << "  --max-regress PCT   Tolerance for --baseline, e.g. 10% (default: 10%)\n"
+                      << "  --faults SPEC       Inject faults into every SDK call once setup is done, e.g.\n"
+                      << "                      latency=lognormal:20:0.5,drop=0.01,429=0.05,503=0.01,bw=512\n"
+                      << "                      (latency: MS, LO-HI, normal:M:SD, lognormal:MED:SIGMA,\n"
+                      << "                      exp:MEAN; drop_ms=MS, req_bytes/resp_bytes=N, seed=N)\n"
+                      << "  --offline           Don't contact the API: synthetic responses, so race/bench\n"
+                      << "                      measure only the harness and its retry/back-pressure\n"
+                      << "  --help       Show this help\n\n"
+                      << "Benchmark options:\n"
+                      << "  --concurrency N   Worker threads (default: 8)\n"
+                      << "  --duration S      Seconds to run (default: 10)\n"
+                      << "  --rps N           Target total request rate (default: unthrottled)\n"
+                      << "  --ops LIST        Operations to mix: track,balance,list,run\n"
+                      << "  --open-loop       Issue requests on a fixed schedule (requires --rps)\n"
+                      << "  --arrivals KIND   Open-loop arrivals: poisson (default) or uniform\n"
+                      << "  --clients MODE    shared (default), pooled, fresh per request, or sharded\n"
+                      << "                    (one client per worker thread)\n"
+                      << "  --pool-compare    Compare pooling off vs on, incl. handshake counts\n"
+                      << "  --connections N   Cap pooled clients (default: one per worker; sweep: 64)\n"
+                      << "  --warm N          Open N pooled connections in parallel before the run\n"
+                      << "                    (--clients pooled; also applies to --worker)\n"
+                      << "  --sweep LIST      Throughput at each concurrency, e.g. 64,256,1024\n"
+                      << "  --scaling         trackUsage req/s at 1..64 threads, shared vs sharded client\n"
+                      << "  --scaling-threads LIST  Thread counts for --scaling (default: 1,2,4,...,64)\n"
+                      << "  --pin             Pin sharded worker threads to CPUs (Linux)\n"
+                      << "  --governor        Shared token bucket at --rps plus an adaptive limit\n"
+                      << "                    on requests in flight (up to --concurrency)\n\n"
+                      << "Distributed benchmark:\n"
+                      << "  --coordinator PORT  Serve the benchmark options above to --workers N\n"
+                      << "                      workers, start them together and merge their results\n"
+                      << "  --workers N         Workers to wait for (default: 1); --rps is split between them\n"
+                      << "  --worker HOST:PORT  Run the plan a coordinator hands out and report back\n\n"
+                      << "Bulk provisioning:\n"
+                      << "  --bulk-customers N  Create N customers in bulk (and fetch them back), vs the\n"
+                      << "                      single-call loop; parallelism is --concurrency\n"
+                      << "  --bulk-chunk N      Customers per chunk, one leased client each (default: 100)\n";
+            return 0;
+        }
+    }
+
+    std::vector<BenchOp> ops;
+    if (bench) {
+        for (const auto& name : split_csv(bench_ops)) {
+            BenchOp op;
+            if (!make_bench_op(name, op)) {
+                std::cerr << RED << "Unknown --ops entry: " << name << RESET << std::endl;
+                return 1;
+            }
+            ops.push_back(op);
+        }
+        if (ops.empty() || bench_opts.concurrency < 1 || bench_opts.duration_s < 1) {
+            std::cerr << RED << "Benchmark needs at least one op, --concurrency >= 1 and --duration >= 1." << RESET << std::endl;
+            return 1;
+        }
+        if (bench_opts.open_loop && bench_opts.target_rps <= 0) {
+            std::cerr << RED << "--open-loop needs a target rate (--rps N)." << RESET << std::endl;
+            return 1;
+        }
+    }
+
+    if (profile_every > 0 && !RequestProfiler::compiled_in()) {
+        std::cerr << RED << "--profile needs a build with DRIP_PROFILE=1 (make PROFILE=1, or cmake -DDRIP_PROFILE=ON)."
+                  << RESET << std::endl;
+        return 1;
+    }
+
+    if (!max_regress.empty()) {
+        perf_out.gate.max_regress = parse_regress_fraction(max_regress);
+        if (perf_out.gate.max_regress < 0) {
+            std::cerr << RED << "--max-regress needs a percentage, e.g. 10%." << RESET << std::endl;
+            return 1;
+        }
+    }
+    if (!perf_out.baseline_path.empty()) {
+        std::string error;
+        if (!perf_out.baseline.load(perf_out.baseline_path, error)) {
+            std::cerr << RED << "Cannot read --baseline: " << error << RESET << std::endl;
+            return 1;
+        }
+    }
+    PerfReport perf;
+    perf.tool = "drip-health";
+    perf.version = DRIP_SDK_VERSION;
+
+    std::string test_customer_id = env_or("TEST_CUSTOMER_ID", "");
+    std::string customer_id;
+
+    std::cout << std::endl;
+    std::cout << "Drip C++ SDK Health Check v" << DRIP_SDK_VERSION << std::endl;
+    std::cout << "==========================================" << std::endl;
+
+    // --coordinator: makes no API calls of its own, so it needs no client or key
+    if (coordinator_port > 0) {
+        if (distributed_workers < 1) {
+            std::cerr << RED << "--workers must be >= 1." << RESET << std::endl;
+            return 1;
+        }
+        if (!sweep_levels.empty() || !scaling_levels.empty() || pool_compare || bulk_customers > 0) {
+            std::cerr << RED << "--coordinator runs the plain benchmark; --sweep, --scaling, --pool-compare and "
+                      << "--bulk-customers can't be distributed." << RESET << std::endl;
+            return 1;
+        }
+        DistributedPlan plan;
+        plan.ops = bench_ops;
+        plan.opts = bench_opts;
+        plan.clients = client_mode;
+        plan.governor = use_governor;
+        plan.connections = max_connections;
+        plan.pin = pin_threads;
+        int status = run_coordinator(coordinator_port, distributed_workers, plan, perf);
+        return finish_perf_report(perf, perf_out, status);
+    }
+
+    // Initialize client
+    drip::Config config;
+    config.api_key = env_or("DRIP_API_KEY", "");
+    std::string api_url = env_or("DRIP_API_URL", "");
+    if (!api_url.empty()) {
+        // Ensure /v1 suffix
+        if (api_url.size() < 3 || api_url.substr(api_url.size() - 3) != "/v1") {
+            api_url += "/v1";
+        }
+        config.base_url = api_url;
+    }
+    if (faults.offline && config.api_key.empty()) {
+        config.api_key = "sk_test_offline";  // Never sent; the client just needs one to construct
+    }
+    StartupTimeline startup;
+    startup.config_us = StartupTimeline::mark();
+
+    MetricsDump metrics_dump{metrics, metrics_out};
+    ClientMetrics::instance().enable(metrics);
+    TraceDump trace_dump{trace_out};
+    FaultSummary fault_summary;
+    FaultInjector::instance().configure(faults.setup_only());
+    if (profile_every > 0) RequestProfiler::instance().enable(profile_every);
+    if (!trace_out.empty()) {
+        TraceRecorder::instance().enable();
+        TraceRecorder::instance().set_thread_name("main");
+    }
+
+    try {
+        drip::Client client(config);
+        startup.client_us = StartupTimeline::mark();
+
+        if (verbose) {
+            std::cout << DIM << "  API URL: " << (config.base_url.empty() ? "(default)" : config.base_url) << RESET << std::endl;
+            std::cout << DIM << "  Customer: " << (!test_customer_id.empty() && test_customer_id != "seed-customer-1" ? test_customer_id : "will create") << RESET << std::endl;
+            std::cout << std::endl;
+        }
+
+        // --worker: one slice of a distributed benchmark
+        if (!worker_address.empty()) {
+            return run_bench_worker(client, config, test_customer_id, worker_address, warm_connections, faults);
+        }
+
+        // --bulk-customers: tenant onboarding throughput
+        if (bulk_customers > 0) {
+            std::cout << "\n--- Bulk Customer Provisioning ---\n" << std::endl;
+            if (bench_opts.concurrency < 1 || bulk_chunk < 1) {
+                std::cerr << RED << "--bulk-customers needs --concurrency >= 1 and --bulk-chunk >= 1." << RESET << std::endl;
+                return 1;
+            }
             if (!check_connectivity(client).success) {
-                std::cerr << RED << "API unreachable. Skipping race tests." << RESET << std::endl;
+                std::cerr << RED << "API unreachable. Skipping bulk provisioning." << RESET << std::endl;
                 return 1;
             }
-            if (test_customer_id.empty() || test_customer_id == "seed-customer-1") {
-                CheckResult cr = check_customer_create(client, customer_id);
-                if (!cr.success) {
-                    std::cerr << RED << "Cannot run race tests without a customer." << RESET << std::endl;
-                    return 1;
+            FaultInjector::instance().configure(faults);
+            BulkCustomerOptions bulk_opts;
+            bulk_opts.chunk_size = static_cast<size_t>(bulk_chunk);
+            bulk_opts.parallelism = static_cast<size_t>(bench_opts.concurrency);
+            int status = run_bulk_customer_bench(client, config, bulk_customers, bulk_opts, perf);
+            std::cout << std::endl;
+            return finish_perf_report(perf, perf_out, status);
+        }
+
+        // --bench: Sustained load with latency percentiles
+        if (bench) {
+            std::cout << "\n--- Benchmark ---\n" << std::endl;
+            if (!prepare_load_run(client, test_customer_id, customer_id, "benchmark")) return 1;
+            FaultInjector::instance().configure(faults);
+
+            std::cout << "Running " << bench_opts.concurrency << " workers for " << bench_opts.duration_s << "s";
+            if (bench_opts.target_rps > 0) std::cout << " at " << bench_opts.target_rps << " req/s";
+            if (bench_opts.open_loop) std::cout << ", open loop (" << (bench_opts.poisson ? "poisson" : "uniform") << " arrivals)";
+            std::cout << " (ops: " << bench_ops << ")" << std::endl << std::endl;
+
+            if (!sweep_levels.empty()) {
+                for (size_t i = 0; i < sweep_levels.size(); ++i) {
+                    if (sweep_levels[i] < 1) {
+                        std::cerr << RED << "--sweep levels must be >= 1." << RESET << std::endl;
+                        return 1;
+                    }
+                }
+                uint64_t errors = run_concurrency_sweep(client, config, customer_id, bench_opts, ops,
+                                                        sweep_levels, max_connections > 0 ? max_connections : 64);
+                std::cout << std::endl;
+                return errors > 0 ? 1 : 0;
+            }
+
+            if (!scaling_levels.empty()) {
+                for (size_t i = 0; i < scaling_levels.size(); ++i) {
+                    if (scaling_levels[i] < 1) {
+                        std::cerr << RED << "--scaling-threads levels must be >= 1." << RESET << std::endl;
+                        return 1;
+                    }
                 }
-            } else {
-                customer_id = test_customer_id;
+                uint64_t errors = run_scaling_bench(client, config, customer_id, bench_opts, scaling_levels, pin_threads);
+                std::cout << std::endl;
+                return errors > 0 ? 1 : 0;
             }
-            std::cout << "Using customer: " << customer_id << std::endl << std::endl;
+
+            if (pool_compare) {
+                uint64_t errors = run_pool_compare(client, config, customer_id, bench_opts, ops);
+                std::cout << std::endl;
+                return errors > 0 ? 1 : 0;
+            }
+
+            ClientPool pool(config, static_cast<size_t>(max_connections > 0 ? max_connections : bench_opts.concurrency));
+            warm_pool(pool, client_mode, warm_connections);
+            std::unique_ptr<ClientGovernor> governor;
+            BenchOptions run_opts = bench_opts;
+            if (use_governor) governor = make_bench_governor(bench_opts, run_opts);
+
+            std::atomic<bool> done{false};
+            std::thread monitor;
+            if (governor && verbose) {
+                monitor = std::thread([&] {
+                    while (!done) {
+                        std::this_thread::sleep_for(std::chrono::seconds(1));
+                        std::cout << "        " << DIM << "governor: limit " << governor->limit()
+                                  << ", in flight " << governor->in_flight() << ", queued "
+                                  << governor->queue_depth() << RESET << std::endl;
+                    }
+                });
+            }
+
+            // --verbose: sample /health phase timings on a side connection
+            // while the load runs, to split latency into network vs server.
+            PhaseHistograms phases;
+            std::thread sampler;
+            if (verbose) {
+                sampler = std::thread([&] {
+                    HttpProbe probe(true, config.api_key);
+                    std::string url = health_url(config);
+                    while (!done) {
+                        ProbeResult r = probe.get(url);
+                        if (r.ok) phases.record(r.phases);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+                    }
+                });
+            }
+
+            ShardedClient sharded(config, static_cast<size_t>(bench_opts.concurrency), pin_threads);
+            BenchTarget target(client, &pool, client_mode, governor.get(), &sharded);
+            BenchReport report = run_opts.open_loop
+                ? run_bench_open_loop(target, customer_id, run_opts, ops)
+                : run_bench(target, customer_id, run_opts, ops);
+            done = true;
+            if (monitor.joinable()) monitor.join();
+            if (sampler.joinable()) sampler.join();
+            if (governor) {
+                report.governed = true;
+                report.governor = governor->stats();
+            }
+            print_bench_report(report);
+            if (verbose) print_phase_table(phases, health_url(config));
+            if (profile_every > 0) {
+                std::cout << std::endl;
+                print_profile_report(config);
+            }
+
+            uint64_t errors = 0;
+            for (const auto& op : report.ops) errors += op.errors;
+            std::cout << std::endl;
+            add_bench_entries(perf, report);
+            return finish_perf_report(perf, perf_out, errors > 0 ? 1 : 0);
+        }
+
+        // --race: Run concurrent race-condition tests only
+        if (race) {
+            std::cout << "\n--- Race Condition Tests ---\n" << std::endl;
+            if (!prepare_load_run(client, test_customer_id, customer_id, "race tests")) return 1;
+            FaultInjector::instance().configure(faults);
 
             auto race_results = run_race_tests(client, customer_id);
             int race_passed = 0, race_failed = 0;
@@ -736,45 +2729,98 @@ int main(int argc, char** argv) {
             return race_failed > 0 ? 1 : 0;
         }
 
-        // Run checks
-        std::vector<CheckResult> results;
-        std::string workflow_id;
-        std::string run_id;
-
-        // Always run connectivity + auth
-        results.push_back(check_connectivity(client));
-        results.push_back(check_authentication(client));
+        // Run checks. Each check lists the checks it waits for; with
+        // --parallel anything whose inputs are ready runs at the same time.
+        // They have no setup of their own, so --faults applies from the first ping.
+        FaultInjector::instance().configure(faults);
+        if (warm_connections > 0) {
+            // The checks share one client, whose first ping is the connection setup being timed
+            std::cout << DIM << "--warm only applies to pooled bench clients; skipping" << RESET << std::endl
+                      << std::endl;
+        }
+        CheckContext ctx;
+        std::vector<CheckTask> plan;
+        auto add_check = [&plan](std::vector<size_t> after, std::function<bool(const CheckContext&)> ready,
+                                 std::function<CheckResult(CheckContext&, std::ostream&)> run) -> size_t {
+            plan.push_back({after, ready, run});
+            return plan.size() - 1;
+        };
+
+        // Always run connectivity + auth. Both ping, and ping() rewrites the
+        // client's base URL while in flight (RACE_TEST_REPORT.md #1), so they
+        // run one after the other and everything else waits for both.
+        size_t ping_check = add_check({}, nullptr, [&client, &startup](CheckContext&, std::ostream& out) {
+            CheckResult r = check_connectivity(client, out);
+            if (r.success) startup.first_ping_us = StartupTimeline::mark();
+            return r;
+        });
+        size_t auth_check = add_check({ping_check}, nullptr, [&client](CheckContext&, std::ostream& out) {
+            return check_authentication(client, out);
+        });
+        if (verbose) {
+            add_check({}, nullptr, [&config](CheckContext&, std::ostream& out) {
+                return check_transport_phases(config, out);
+            });
+        }
 
         if (!quick) {
+            std::vector<size_t> pinged = {ping_check, auth_check};
+            auto has_customer = [](const CheckContext& c) { return !c.customer_id.empty(); };
+
             // List customers (doesn't require a specific customer)
-            results.push_back(check_list_customers(client));
+            add_check(pinged, nullptr, [&client](CheckContext&, std::ostream& out) {
+                return check_list_customers(client, out);
+            });
+            add_check(pinged, nullptr, [&client, scan_pages](CheckContext&, std::ostream& out) {
+                return check_scan_customers(client, scan_pages, out);
+            });
 
             // Get customer: use TEST_CUSTOMER_ID if set, otherwise create one
+            std::vector<size_t> customer_deps = pinged;
             if (!test_customer_id.empty() && test_customer_id != "seed-customer-1") {
-                customer_id = test_customer_id;
+                ctx.customer_id = test_customer_id;
             } else {
-                CheckResult cr = check_customer_create(client, customer_id);
-                results.push_back(cr);
-                if (!cr.success) {
-                    std::cerr << RED << "Cannot run remaining checks without a customer." << RESET << std::endl;
-                }
-            }
-            if (!customer_id.empty()) {
-                results.push_back(check_get_customer(client, customer_id));
-                results.push_back(check_get_balance(client, customer_id));
-                results.push_back(check_track_usage(client, customer_id));
-                results.push_back(check_record_run(client, customer_id, workflow_id));
-                if (!workflow_id.empty()) {
-                    CheckResult sr = check_start_run(client, customer_id, workflow_id, run_id);
-                    results.push_back(sr);
-                    if (sr.success && !run_id.empty()) {
-                        results.push_back(check_emit_event(client, run_id));
-                        results.push_back(check_end_run(client, run_id));
+                customer_deps.push_back(add_check(pinged, nullptr, [&client](CheckContext& c, std::ostream& out) {
+                    CheckResult cr = check_customer_create(client, c.customer_id, out);
+                    if (!cr.success) {
+                        std::cerr << RED << "Cannot run remaining checks without a customer." << RESET << std::endl;
                     }
-                }
+                    return cr;
+                }));
             }
+
+            add_check(customer_deps, has_customer, [&client](CheckContext& c, std::ostream& out) {
+                return check_get_customer(client, c.customer_id, out);
+            });
+            add_check(customer_deps, has_customer, [&client](CheckContext& c, std::ostream& out) {
+                return check_get_balance(client, c.customer_id, out);
+            });
+            add_check(customer_deps, has_customer, [&client](CheckContext& c, std::ostream& out) {
+                return check_track_usage(client, c.customer_id, out);
+            });
+            size_t record_check = add_check(customer_deps, has_customer, [&client](CheckContext& c, std::ostream& out) {
+                return check_record_run(client, c.customer_id, c.workflow_id, out);
+            });
+            size_t start_check = add_check({record_check},
+                [](const CheckContext& c) { return !c.workflow_id.empty(); },
+                [&client](CheckContext& c, std::ostream& out) {
+                    CheckResult sr = check_start_run(client, c.customer_id, c.workflow_id, c.run_id, out);
+                    if (!sr.success) c.run_id.clear();
+                    return sr;
+                });
+            auto has_run = [](const CheckContext& c) { return !c.run_id.empty(); };
+            size_t emit_check = add_check({start_check}, has_run, [&client](CheckContext& c, std::ostream& out) {
+                return check_emit_event(client, c.run_id, out);
+            });
+            add_check({emit_check}, has_run, [&client](CheckContext& c, std::ostream& out) {
+                return check_end_run(client, c.run_id, out);
+            });
         }
 
+        auto checks_start = now_ms();
+        std::vector<CheckResult> results = run_check_plan(plan, ctx, parallel);
+        int checks_ms = static_cast<int>(now_ms() - checks_start);
+
         // Print results
         std::cout << std::endl;
         for (size_t i = 0; i < results.size(); ++i) {
@@ -796,9 +2842,20 @@ int main(int argc, char** argv) {
         } else {
             std::cout << RED << failed << " of " << (passed + failed) << " checks failed." << RESET << std::endl;
         }
+        std::cout << DIM << "Checks took " << checks_ms << "ms" << (parallel ? " (parallel)" : "") << RESET << std::endl;
+        if (startup.first_ping_us > 0) {
+            std::cout << DIM << "Startup: first ping answered " << fmt_ms(startup.first_ping_us) << "ms after launch (config "
+                      << fmt_ms(startup.config_us) << "ms, client +" << fmt_ms(startup.client_us - startup.config_us)
+                      << "ms, ping +" << fmt_ms(startup.first_ping_us - startup.client_us) << "ms)" << RESET << std::endl;
+        }
 
         std::cout << std::endl;
-        return failed > 0 ? 1 : 0;
+        if (profile_every > 0) print_profile_report(config);
+        for (const auto& r : results) perf.add(perf_entry("check", r.name, r.duration_ms, r.success));
+        perf.add(perf_entry("suite", parallel ? "checks (parallel)" : "checks", checks_ms, failed == 0));
+        perf.add(perf_entry("startup", "client ready", startup.client_us / 1000.0, true));
+        if (startup.first_ping_us > 0) perf.add(perf_entry("startup", "first ping", startup.first_ping_us / 1000.0, true));
+        return finish_perf_report(perf, perf_out, failed > 0 ? 1 : 0);
 
     } catch (const drip::DripError& e) {
         std::cerr << RED << "FATAL: " << e.what() << RESET << std::endl;
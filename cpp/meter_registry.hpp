@@ -0,0 +1,380 @@
+/**
+ * Drip C++ SDK - Meter / event-type registry for the testdrip harness
+ *
+ * Meter names, event types and metadata keys are declared once in the tables
+ * below instead of as string literals at every call site. Each entry becomes
+ * an enum id plus compile-time data: the name, its length and a pre-escaped
+ * JSON fragment ("\"epoch\":") that JsonWriter can append with one memcpy.
+ * Every meter and event type also declares its metadata schema, and the typed
+ * builders check keys against it with static_assert, so a misspelled or
+ * unexpected key is a compile error rather than a silently different series.
+ *
+ *   Usage<Meter::ML_INFERENCE_TOKENS> u(customer_id, 187);
+ *   u.set<MetaKey::REQUEST_ID>("req-42");
+ *   client.trackUsage(u.to_params());     // or write_json(w) for the body
+ *
+ * Builders hold keys as ids and values in small inline strings (short values
+ * stay inside std::string's SSO buffer), so filling one costs no heap
+ * allocation for keys; names are copied only when the SDK params are built.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "json_writer.hpp"
+
+// =============================================================================
+// Tables
+// =============================================================================
+
+// X(id, "name")
+#define DRIP_META_KEYS(X)                     \
+    X(MODEL_NAME,      "model_name")          \
+    X(EPOCH,           "epoch")               \
+    X(LOSS,            "loss")                \
+    X(REQUEST_ID,      "request_id")          \
+    X(INPUT_TOKENS,    "input_tokens")        \
+    X(OUTPUT_TOKENS,   "output_tokens")       \
+    X(PLATFORM,        "platform")            \
+    X(PLATFORM_USER,   "platform_user")       \
+    X(SDK,             "sdk")                 \
+    X(ATTEMPT,         "attempt")             \
+    X(LEARNING_RATE,   "learning_rate")       \
+    X(BATCH_SIZE,      "batch_size")          \
+    X(BATCH_NUMBER,    "batch_number")        \
+    X(ITEMS_SCORED,    "items_scored")        \
+    X(ACCURACY,        "accuracy")            \
+    X(CHECKPOINT_PATH, "checkpoint_path")     \
+    X(LOSS_AT_SAVE,    "loss_at_save")        \
+    X(BATCHED_EVENTS,  "batched_events")
+
+#define DRIP_META_BIT(k) (uint64_t(1) << static_cast<unsigned>(MetaKey::k))
+
+// X(id, "name", "default units", schema)
+#define DRIP_METERS(X)                                                                          \
+    X(ML_TRAINING_TOKENS, "ml_training_tokens", "tokens",                                       \
+      DRIP_META_BIT(MODEL_NAME) | DRIP_META_BIT(EPOCH) | DRIP_META_BIT(LOSS) |                  \
+      DRIP_META_BIT(PLATFORM) | DRIP_META_BIT(PLATFORM_USER) | DRIP_META_BIT(SDK) |             \
+      DRIP_META_BIT(ATTEMPT) | DRIP_META_BIT(BATCHED_EVENTS))                                   \
+    X(ML_INFERENCE_TOKENS, "ml_inference_tokens", "tokens",                                     \
+      DRIP_META_BIT(MODEL_NAME) | DRIP_META_BIT(REQUEST_ID) | DRIP_META_BIT(INPUT_TOKENS) |     \
+      DRIP_META_BIT(OUTPUT_TOKENS) | DRIP_META_BIT(BATCHED_EVENTS))                             \
+    X(ML_INFERENCE_GPU_SECONDS, "ml_inference_gpu_seconds", "seconds",                          \
+      DRIP_META_BIT(MODEL_NAME) | DRIP_META_BIT(REQUEST_ID))
+
+// X(id, "name", schema)
+#define DRIP_EVENT_TYPES(X)                                                                     \
+    X(TRAINING_EPOCH, "training.epoch",                                                         \
+      DRIP_META_BIT(EPOCH) | DRIP_META_BIT(LOSS) | DRIP_META_BIT(LEARNING_RATE) |               \
+      DRIP_META_BIT(BATCH_SIZE))                                                                \
+    X(MODEL_CHECKPOINT, "model.checkpoint",                                                     \
+      DRIP_META_BIT(EPOCH) | DRIP_META_BIT(CHECKPOINT_PATH) | DRIP_META_BIT(LOSS_AT_SAVE))      \
+    X(INFERENCE_PREDICTION, "inference.prediction",                                             \
+      DRIP_META_BIT(REQUEST_ID) | DRIP_META_BIT(INPUT_TOKENS) | DRIP_META_BIT(OUTPUT_TOKENS))   \
+    X(INFERENCE_BATCH, "inference.batch",                                                       \
+      DRIP_META_BIT(BATCH_NUMBER) | DRIP_META_BIT(ITEMS_SCORED) | DRIP_META_BIT(ACCURACY))
+
+// =============================================================================
+// Ids and compile-time names
+// =============================================================================
+
+struct RegistryName {
+    const char* str;
+    size_t len;
+    const char* json;  // Pre-escaped: "\"name\":" for keys, "\"name\"" for values
+    size_t json_len;
+};
+
+#define DRIP_LIT_LEN(s) (sizeof(s) - 1)
+
+enum class MetaKey : uint8_t {
+#define X(id, name) id,
+    DRIP_META_KEYS(X)
+#undef X
+    COUNT
+};
+static_assert(static_cast<unsigned>(MetaKey::COUNT) <= 64, "metadata schemas are 64-bit masks");
+
+enum class Meter : uint8_t {
+#define X(id, name, units, schema) id,
+    DRIP_METERS(X)
+#undef X
+    COUNT
+};
+
+enum class EventType : uint8_t {
+#define X(id, name, schema) id,
+    DRIP_EVENT_TYPES(X)
+#undef X
+    COUNT
+};
+
+namespace registry_detail {
+
+constexpr RegistryName meta_keys[] = {
+#define X(id, name) {name, DRIP_LIT_LEN(name), "\"" name "\":", DRIP_LIT_LEN("\"" name "\":")},
+    DRIP_META_KEYS(X)
+#undef X
+};
+
+constexpr RegistryName meters[] = {
+#define X(id, name, units, schema) {name, DRIP_LIT_LEN(name), "\"" name "\"", DRIP_LIT_LEN("\"" name "\"")},
+    DRIP_METERS(X)
+#undef X
+};
+
+constexpr const char* meter_units[] = {
+#define X(id, name, units, schema) units,
+    DRIP_METERS(X)
+#undef X
+};
+
+constexpr uint64_t meter_schemas[] = {
+#define X(id, name, units, schema) schema,
+    DRIP_METERS(X)
+#undef X
+};
+
+constexpr RegistryName event_types[] = {
+#define X(id, name, schema) {name, DRIP_LIT_LEN(name), "\"" name "\"", DRIP_LIT_LEN("\"" name "\"")},
+    DRIP_EVENT_TYPES(X)
+#undef X
+};
+
+constexpr uint64_t event_schemas[] = {
+#define X(id, name, schema) schema,
+    DRIP_EVENT_TYPES(X)
+#undef X
+};
+
+}  // namespace registry_detail
+
+constexpr const RegistryName& name_of(MetaKey k) { return registry_detail::meta_keys[static_cast<size_t>(k)]; }
+constexpr const RegistryName& name_of(Meter m) { return registry_detail::meters[static_cast<size_t>(m)]; }
+constexpr const RegistryName& name_of(EventType e) { return registry_detail::event_types[static_cast<size_t>(e)]; }
+constexpr const char* units_of(Meter m) { return registry_detail::meter_units[static_cast<size_t>(m)]; }
+constexpr uint64_t schema_of(Meter m) { return registry_detail::meter_schemas[static_cast<size_t>(m)]; }
+constexpr uint64_t schema_of(EventType e) { return registry_detail::event_schemas[static_cast<size_t>(e)]; }
+constexpr bool schema_allows(uint64_t schema, MetaKey k) {
+    return (schema & (uint64_t(1) << static_cast<unsigned>(k))) != 0;
+}
+
+#undef DRIP_LIT_LEN
+
+// =============================================================================
+// Typed builders
+// =============================================================================
+
+/** Metadata restricted to `Schema`; keys are ids, values inline strings. */
+template <typename Derived, uint64_t Schema>
+class SchemaMetadata {
+public:
+    static const size_t MAX_FIELDS = 8;
+
+    template <MetaKey K>
+    Derived& set(const std::string& value) {
+        static_assert(schema_allows(Schema, K), "metadata key is not in this meter/event type's schema");
+        put(K, value.data(), value.size());
+        return static_cast<Derived&>(*this);
+    }
+
+    template <MetaKey K>
+    Derived& set(const char* value) {
+        static_assert(schema_allows(Schema, K), "metadata key is not in this meter/event type's schema");
+        put(K, value, std::char_traits<char>::length(value));
+        return static_cast<Derived&>(*this);
+    }
+
+    template <MetaKey K>
+    Derived& set(long long value) {
+        static_assert(schema_allows(Schema, K), "metadata key is not in this meter/event type's schema");
+        char buf[24];
+        int n = std::snprintf(buf, sizeof(buf), "%lld", value);
+        put(K, buf, static_cast<size_t>(n));
+        return static_cast<Derived&>(*this);
+    }
+
+    template <MetaKey K>
+    Derived& set(int value) {
+        return set<K>(static_cast<long long>(value));
+    }
+
+    /** Fixed-point with `precision` decimals (2 matches to_string_2f()). */
+    template <MetaKey K>
+    Derived& set(double value, int precision) {
+        static_assert(schema_allows(Schema, K), "metadata key is not in this meter/event type's schema");
+        char buf[32];
+        int n = std::snprintf(buf, sizeof(buf), "%.*f", precision, value);
+        put(K, buf, static_cast<size_t>(n));
+        return static_cast<Derived&>(*this);
+    }
+
+    size_t metadata_size() const { return count_; }
+
+protected:
+    SchemaMetadata() : count_(0) {}
+
+    void copy_metadata(drip::Metadata& out) const {
+        for (size_t i = 0; i < count_; ++i) out[name_of(fields_[i].key).str] = fields_[i].value;
+    }
+
+    /** Keys in name order, as drip::Metadata (a std::map) would write them. */
+    void write_metadata(JsonWriter& w) const {
+        if (count_ == 0) return;
+        size_t order[MAX_FIELDS];
+        for (size_t i = 0; i < count_; ++i) {
+            size_t j = i;
+            for (; j > 0 && std::strcmp(name_of(fields_[order[j - 1]].key).str, name_of(fields_[i].key).str) > 0; --j) {
+                order[j] = order[j - 1];
+            }
+            order[j] = i;
+        }
+        w.key("metadata");
+        w.raw("{", 1);
+        for (size_t i = 0; i < count_; ++i) {
+            if (i) w.raw(",", 1);
+            const Field& f = fields_[order[i]];
+            const RegistryName& n = name_of(f.key);
+            w.raw(n.json, n.json_len);
+            w.value(f.value);
+        }
+        w.raw("}", 1);
+    }
+
+private:
+    struct Field {
+        MetaKey key;
+        std::string value;
+    };
+
+    void put(MetaKey k, const char* v, size_t n) {
+        for (size_t i = 0; i < count_; ++i) {
+            if (fields_[i].key == k) {
+                fields_[i].value.assign(v, n);
+                return;
+            }
+        }
+        if (count_ == MAX_FIELDS) throw std::length_error("too many metadata fields");
+        fields_[count_].key = k;
+        fields_[count_].value.assign(v, n);
+        ++count_;
+    }
+
+    Field fields_[MAX_FIELDS];
+    size_t count_;
+};
+
+/** One trackUsage() call on meter M. */
+template <Meter M>
+class Usage : public SchemaMetadata<Usage<M>, schema_of(M)> {
+public:
+    Usage(const std::string& customer_id, double quantity) : customer_id_(customer_id), quantity_(quantity) {}
+
+    Usage& description(const std::string& d) {
+        description_ = d;
+        return *this;
+    }
+
+    Usage& idempotency_key(const std::string& k) {
+        idempotency_key_ = k;
+        return *this;
+    }
+
+    drip::TrackUsageParams to_params() const {
+        drip::TrackUsageParams p;
+        p.customer_id = customer_id_;
+        p.meter = name_of(M).str;
+        p.quantity = quantity_;
+        p.units = units_of(M);
+        p.description = description_;
+        p.idempotency_key = idempotency_key_;
+        this->copy_metadata(p.metadata);
+        return p;
+    }
+
+    /** Same body as write_json(JsonWriter&, const TrackUsageParams&), without building the params. */
+    void write_json(JsonWriter& w) const {
+        w.begin_object();
+        w.key("customerId");
+        w.value(customer_id_);
+        w.key("meter");
+        w.raw(name_of(M).json, name_of(M).json_len);
+        w.key("quantity");
+        w.value(quantity_);
+        if (units_of(M)[0] != '\0') {
+            w.key("units");
+            w.raw("\"", 1);
+            w.raw(units_of(M), std::char_traits<char>::length(units_of(M)));
+            w.raw("\"", 1);
+        }
+        w.optional("description", description_);
+        w.optional("idempotencyKey", idempotency_key_);
+        this->write_metadata(w);
+        w.end_object();
+    }
+
+private:
+    std::string customer_id_;
+    double quantity_;
+    std::string description_;
+    std::string idempotency_key_;
+};
+
+/** One run event of type E, for emitEvent() or a RecordRunParams event list. */
+template <EventType E>
+class Event : public SchemaMetadata<Event<E>, schema_of(E)> {
+public:
+    explicit Event(double quantity) : quantity_(quantity), cost_units_(0) {}
+
+    Event& units(const char* u) {
+        units_ = u;
+        return *this;
+    }
+
+    Event& cost_units(double c) {
+        cost_units_ = c;
+        return *this;
+    }
+
+    Event& description(const std::string& d) {
+        description_ = d;
+        return *this;
+    }
+
+    drip::EmitEventParams to_emit(const std::string& run_id, const std::string& idempotency_key = "") const {
+        drip::EmitEventParams p;
+        p.run_id = run_id;
+        p.event_type = name_of(E).str;
+        p.quantity = quantity_;
+        p.units = units_;
+        p.description = description_;
+        p.idempotency_key = idempotency_key;
+        p.cost_units = cost_units_;
+        this->copy_metadata(p.metadata);
+        return p;
+    }
+
+    drip::RecordRunEvent to_record() const {
+        drip::RecordRunEvent e;
+        e.event_type = name_of(E).str;
+        e.quantity = quantity_;
+        e.units = units_;
+        e.description = description_;
+        e.cost_units = cost_units_;
+        this->copy_metadata(e.metadata);
+        return e;
+    }
+
+private:
+    double quantity_;
+    double cost_units_;
+    std::string units_;
+    std::string description_;
+};
@@ -0,0 +1,432 @@
+/**
+ * Drip C++ SDK - Request-body microbenchmarks for testdrip
+ *
+ * Measures what it costs to turn one metering event into its JSON request
+ * body, per operation: wall time and heap allocations (counted by replacing
+ * the global operator new in this binary). No network; no API key needed.
+ *
+ *   mini-dom  DomNode tree built field by field (one heap node per field,
+ *             std::map children), then dumped: the intermediate-DOM approach,
+ *             always built so the comparison reproduces from this tree alone
+ *   dom       the same with nlohmann::json (only built when the SDK's
+ *             third_party nlohmann/json.hpp is on the include path)
+ *   writer    JsonWriter appending straight into this thread's reused buffer
+ *
+ * Build+body cases start from the raw values of one per-prediction event:
+ *
+ *   params  TrackUsageParams filled with string literals, then written
+ *   typed   Usage<Meter::...> with interned keys and pre-escaped fragments
+ *
+ * Run-build cases build and release a 10k-event batch-scoring run:
+ *
+ *   std     RecordRunParams filled the way drip-ml-test does (to_string and
+ *           ostringstream values, one std::map per event)
+ *   arena   ArenaRun, values formatted into one monotonic arena
+ *
+ * Usage:
+ *   ./drip-microbench                    # Default iteration count
+ *   ./drip-microbench --iterations N     # Operations per case
+ */
+
+#include <drip/drip.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__has_include)
+#if __has_include(<nlohmann/json.hpp>)
+#include <nlohmann/json.hpp>
+#define MICROBENCH_HAVE_DOM 1
+#endif
+#endif
+
+#include "json_writer.hpp"
+#include "meter_registry.hpp"
+#include "run_arena.hpp"
+
+// =============================================================================
+// Allocation counting
+// =============================================================================
+
+static std::atomic<uint64_t> g_allocs{0};
+static std::atomic<uint64_t> g_alloc_bytes{0};
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(n, std::memory_order_relaxed);
+    void* p = std::malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+// Out of line so GCC does not pair the inlined free() with a new-expression
+// and warn about mismatched allocation functions
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void operator delete(void* p) noexcept { std::free(p); }
+
+// =============================================================================
+// ANSI colors
+// =============================================================================
+
+static const char* BOLD  = "\033[1m";
+static const char* DIM   = "\033[2m";
+static const char* RESET = "\033[0m";
+
+// =============================================================================
+// Harness
+// =============================================================================
+
+struct MicroResult {
+    std::string name;
+    double ns_per_op;
+    double allocs_per_op;
+    double bytes_per_op;   // Heap bytes requested per op
+    size_t output_bytes;   // Size of one result (body bytes, events built)
+};
+
+/** Run `fn` (returning the result size) `iterations` times after `warmup` untimed runs. */
+template <typename F>
+static MicroResult run_case(const std::string& name, int iterations, F fn, int warmup = 1000) {
+    size_t out = 0;
+    for (int i = 0; i < warmup; ++i) out = fn();
+
+    uint64_t allocs0 = g_allocs.load();
+    uint64_t bytes0 = g_alloc_bytes.load();
+    auto t0 = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (int i = 0; i < iterations; ++i) sink += fn();
+    auto t1 = std::chrono::steady_clock::now();
+    uint64_t allocs = g_allocs.load() - allocs0;
+    uint64_t bytes = g_alloc_bytes.load() - bytes0;
+
+    // Keep the loop observable so it is not optimized away
+    if (sink == 1) std::cerr << "";
+
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    return {name, ns / iterations, static_cast<double>(allocs) / iterations,
+            static_cast<double>(bytes) / iterations, out};
+}
+
+static void print_results(const std::vector<MicroResult>& results, const char* size_label) {
+    std::cout << "  " << std::left << std::setw(30) << "case" << std::right
+              << std::setw(12) << "ns/op" << std::setw(12) << "allocs/op"
+              << std::setw(12) << "bytes/op" << std::setw(10) << size_label << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const MicroResult& r = results[i];
+        std::cout << "  " << std::left << std::setw(30) << r.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << r.ns_per_op
+                  << std::setprecision(2) << std::setw(12) << r.allocs_per_op
+                  << std::setprecision(1) << std::setw(12) << r.bytes_per_op
+                  << std::setw(10) << r.output_bytes << std::endl;
+    }
+}
+
+// =============================================================================
+// Sample events (same shapes as drip-ml-test's per-prediction metering)
+// =============================================================================
+
+static drip::TrackUsageParams sample_track_usage() {
+    drip::TrackUsageParams p;
+    p.customer_id = "cus_7f3a9c2e1b";
+    p.meter = "ml_inference_tokens";
+    p.quantity = 187;
+    p.units = "tokens";
+    p.idempotency_key = "pred-cus_7f3a9c2e1b-000042";
+    p.metadata["model_name"] = "play2train-ffn-v3";
+    p.metadata["request_id"] = "req-42";
+    p.metadata["latency_ms"] = "12";
+    return p;
+}
+
+static drip::EmitEventParams sample_emit_event() {
+    drip::EmitEventParams p;
+    p.run_id = "run_01hx9q8w7e6r5t4y3u2i";
+    p.event_type = "training.epoch";
+    p.quantity = 1536;
+    p.units = "tokens";
+    p.cost_units = 1536 * 0.00001;
+    p.description = "Epoch 3: 1536 tokens, loss=1.10";
+    p.idempotency_key = "incr-epoch-run_01hx9q8w7e6r5t4y3u2i-3";
+    p.metadata["epoch"] = "3";
+    p.metadata["loss"] = "1.10";
+    return p;
+}
+
+/**
+ * Minimal intermediate DOM: every value is its own heap node, objects keep
+ * their children in a std::map (as nlohmann::json's object_t does), and
+ * dump() walks the tree into a fresh string.
+ */
+struct DomNode {
+    enum Type { STRING, NUMBER, OBJECT };
+    Type type;
+    std::string text;
+    double number;
+    std::map<std::string, std::unique_ptr<DomNode> > fields;
+
+    DomNode() : type(OBJECT), number(0) {}
+    explicit DomNode(const std::string& s) : type(STRING), text(s), number(0) {}
+    explicit DomNode(double v) : type(NUMBER), number(v) {}
+    explicit DomNode(const drip::Metadata& m) : type(OBJECT), number(0) {
+        for (drip::Metadata::const_iterator it = m.begin(); it != m.end(); ++it) {
+            set(it->first, new DomNode(it->second));
+        }
+    }
+
+    void set(const std::string& key, DomNode* value) { fields[key].reset(value); }
+
+    std::string dump() const {
+        std::string out;
+        dump_to(out);
+        return out;
+    }
+
+private:
+    void dump_to(std::string& out) const {
+        if (type == STRING) {
+            append_string(out, text);
+        } else if (type == NUMBER) {
+            char num[32];
+            int n = std::isfinite(number) ? std::snprintf(num, sizeof(num), "%.17g", number)
+                                          : std::snprintf(num, sizeof(num), "null");
+            out.append(num, static_cast<size_t>(n));
+        } else {
+            out += '{';
+            for (std::map<std::string, std::unique_ptr<DomNode> >::const_iterator it = fields.begin();
+                 it != fields.end(); ++it) {
+                if (it != fields.begin()) out += ',';
+                append_string(out, it->first);
+                out += ':';
+                it->second->dump_to(out);
+            }
+            out += '}';
+        }
+    }
+
+    static void append_string(std::string& out, const std::string& s) {
+        out += '"';
+        for (size_t i = 0; i < s.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += static_cast<char>(c);
+            } else if (c < 0x20) {
+                char esc[8];
+                std::snprintf(esc, sizeof(esc), "\\u%04x", c);
+                out += esc;
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+        out += '"';
+    }
+};
+
+static std::string mini_dom_body(const drip::TrackUsageParams& p) {
+    DomNode j;
+    j.set("customerId", new DomNode(p.customer_id));
+    j.set("meter", new DomNode(p.meter));
+    j.set("quantity", new DomNode(p.quantity));
+    if (!p.units.empty()) j.set("units", new DomNode(p.units));
+    if (!p.description.empty()) j.set("description", new DomNode(p.description));
+    if (!p.idempotency_key.empty()) j.set("idempotencyKey", new DomNode(p.idempotency_key));
+    if (!p.metadata.empty()) j.set("metadata", new DomNode(p.metadata));
+    return j.dump();
+}
+
+static std::string mini_dom_body(const drip::EmitEventParams& p) {
+    DomNode j;
+    j.set("runId", new DomNode(p.run_id));
+    j.set("eventType", new DomNode(p.event_type));
+    j.set("quantity", new DomNode(p.quantity));
+    if (!p.units.empty()) j.set("units", new DomNode(p.units));
+    if (!p.description.empty()) j.set("description", new DomNode(p.description));
+    if (p.cost_units != 0) j.set("costUnits", new DomNode(p.cost_units));
+    if (!p.idempotency_key.empty()) j.set("idempotencyKey", new DomNode(p.idempotency_key));
+    if (!p.metadata.empty()) j.set("metadata", new DomNode(p.metadata));
+    return j.dump();
+}
+
+#ifdef MICROBENCH_HAVE_DOM
+static std::string dom_body(const drip::TrackUsageParams& p) {
+    nlohmann::json j;
+    j["customerId"] = p.customer_id;
+    j["meter"] = p.meter;
+    j["quantity"] = p.quantity;
+    if (!p.units.empty()) j["units"] = p.units;
+    if (!p.description.empty()) j["description"] = p.description;
+    if (!p.idempotency_key.empty()) j["idempotencyKey"] = p.idempotency_key;
+    if (!p.metadata.empty()) j["metadata"] = p.metadata;
+    return j.dump();
+}
+
+static std::string dom_body(const drip::EmitEventParams& p) {
+    nlohmann::json j;
+    j["runId"] = p.run_id;
+    j["eventType"] = p.event_type;
+    j["quantity"] = p.quantity;
+    if (!p.units.empty()) j["units"] = p.units;
+    if (!p.description.empty()) j["description"] = p.description;
+    if (p.cost_units != 0) j["costUnits"] = p.cost_units;
+    if (!p.idempotency_key.empty()) j["idempotencyKey"] = p.idempotency_key;
+    if (!p.metadata.empty()) j["metadata"] = p.metadata;
+    return j.dump();
+}
+#endif
+
+// =============================================================================
+// Run builders (scenario 10's batch-scoring events at 10k scale)
+// =============================================================================
+
+static const int RUN_EVENTS = 10000;
+
+static drip::RecordRunParams run_header() {
+    drip::RecordRunParams p;
+    p.customer_id = "cus_7f3a9c2e1b";
+    p.workflow = "glades-batch-inference";
+    p.status = drip::RUN_COMPLETED;
+    p.metadata["model_name"] = "play2train-ffn-v3.2";
+    return p;
+}
+
+static std::string to_string_2f(double v) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2) << v;
+    return ss.str();
+}
+
+static size_t build_std_run(const drip::RecordRunParams& header) {
+    drip::RecordRunParams params = header;
+    for (int batch = 1; batch <= RUN_EVENTS; ++batch) {
+        int tokens = 100 * 128;
+        drip::RecordRunEvent evt;
+        evt.event_type = "inference.batch";
+        evt.quantity = tokens;
+        evt.units = "tokens";
+        evt.cost_units = tokens * 0.000003;
+        evt.metadata["batch_number"] = std::to_string(batch);
+        evt.metadata["items_scored"] = std::to_string(100);
+        evt.metadata["accuracy"] = to_string_2f(0.89 + 0.00001 * batch);
+
+        std::ostringstream desc;
+        desc << "Batch " << batch << "/" << RUN_EVENTS << ": 100 items, " << tokens << " tokens";
+        evt.description = desc.str();
+        params.events.push_back(evt);
+    }
+    return params.events.size();
+}
+
+static size_t build_arena_run(const drip::RecordRunParams& header) {
+    ArenaRun run(header);
+    for (int batch = 1; batch <= RUN_EVENTS; ++batch) {
+        int tokens = 100 * 128;
+        run.add_event("inference.batch", tokens)
+            .units("tokens")
+            .cost_units(tokens * 0.000003)
+            .meta("batch_number", batch)
+            .meta("items_scored", 100)
+            .meta("accuracy", 0.89 + 0.00001 * batch, 2)
+            .description(run.arena().format("Batch %d/%d: 100 items, %d tokens", batch, RUN_EVENTS, tokens));
+    }
+    return run.size();
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+int main(int argc, char** argv) {
+    int iterations = 200000;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) iterations = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            std::cout << "Usage: drip-microbench [OPTIONS]\n\n"
+                      << "Options:\n"
+                      << "  --iterations N   Operations per case (default: 200000)\n"
+                      << "  --help           Show this help\n";
+            return 0;
+        }
+    }
+    if (iterations < 1) iterations = 1;
+
+    std::cout << std::endl;
+    std::cout << BOLD << "Drip C++ SDK Microbenchmarks v" << DRIP_SDK_VERSION << RESET << std::endl;
+    std::cout << "==========================================" << std::endl;
+    std::cout << DIM << "  " << iterations << " ops per case" << RESET << std::endl << std::endl;
+
+    const drip::TrackUsageParams usage = sample_track_usage();
+    const drip::EmitEventParams event = sample_emit_event();
+
+    std::vector<MicroResult> results;
+    results.push_back(run_case("trackUsage body, mini-dom", iterations, [&] { return mini_dom_body(usage).size(); }));
+#ifdef MICROBENCH_HAVE_DOM
+    results.push_back(run_case("trackUsage body, dom", iterations, [&] { return dom_body(usage).size(); }));
+#endif
+    results.push_back(run_case("trackUsage body, writer", iterations, [&] {
+        JsonWriter& w = thread_json_writer();
+        write_json(w, usage);
+        return w.str().size();
+    }));
+    results.push_back(run_case("emitEvent body, mini-dom", iterations, [&] { return mini_dom_body(event).size(); }));
+#ifdef MICROBENCH_HAVE_DOM
+    results.push_back(run_case("emitEvent body, dom", iterations, [&] { return dom_body(event).size(); }));
+#endif
+    results.push_back(run_case("emitEvent body, writer", iterations, [&] {
+        JsonWriter& w = thread_json_writer();
+        write_json(w, event);
+        return w.str().size();
+    }));
+
+    results.push_back(run_case("prediction build+body, params", iterations, [&] {
+        drip::TrackUsageParams p;
+        p.customer_id = usage.customer_id;
+        p.meter = "ml_inference_tokens";
+        p.quantity = 187;
+        p.units = "tokens";
+        p.metadata["model_name"] = "play2train-ffn-v3";
+        p.metadata["request_id"] = "req-42";
+        JsonWriter& w = thread_json_writer();
+        write_json(w, p);
+        return w.str().size();
+    }));
+    results.push_back(run_case("prediction build+body, typed", iterations, [&] {
+        Usage<Meter::ML_INFERENCE_TOKENS> u(usage.customer_id, 187);
+        u.set<MetaKey::MODEL_NAME>("play2train-ffn-v3").set<MetaKey::REQUEST_ID>("req-42");
+        JsonWriter& w = thread_json_writer();
+        u.write_json(w);
+        return w.str().size();
+    }));
+
+    print_results(results, "body");
+#ifndef MICROBENCH_HAVE_DOM
+    std::cout << std::endl << DIM << "  (nlohmann/json.hpp not found: dom cases skipped; mini-dom still compares)"
+              << RESET << std::endl;
+#endif
+
+    // One op = build and release a whole 10k-event run
+    const drip::RecordRunParams header = run_header();
+    int runs = iterations / RUN_EVENTS > 0 ? iterations / RUN_EVENTS : 1;
+    std::vector<MicroResult> run_results;
+    run_results.push_back(run_case("10k-event run, std", runs, [&] { return build_std_run(header); }, 2));
+    run_results.push_back(run_case("10k-event run, arena", runs, [&] { return build_arena_run(header); }, 2));
+    std::cout << std::endl;
+    print_results(run_results, "events");
+    std::cout << std::endl;
+    return 0;
+}
@@ -14,30 +14,59 @@
  *   8.  Idempotency / retry safety (duplicate detection)
  *   9.  Hyperparameter sweep (grid search cost comparison)
  *   10. Batch inference job (dataset scoring)
+ *   11. Batched inference metering (UsageBatcher vs per-call trackUsage)
+ *   12. Async event emission (lock-free queue feeding emitEvent)
+ *   13. Streaming batch scoring (1M items, paginated recordRun, peak RSS)
+ *   14. Outage resilience (on-disk spool, replay after recovery)
+ *   15. Pre-aggregated GPU-second metering (UsageAggregator, exact totals)
  *
  * Environment variables:
  *   DRIP_API_KEY       - Required
  *   DRIP_API_URL       - Optional (default: production)
  *   TEST_CUSTOMER_ID   - Optional (default: seed-customer-1)
+ *   DRIP_SPOOL_PATH    - Optional spool file for scenario 14 (default: ./drip-ml-test.spool)
  *
  * Usage:
  *   ./drip-ml-test                # Run all scenarios
- *   ./drip-ml-test --scenario 3   # Run a specific scenario (1-6)
+ *   ./drip-ml-test --scenario 3   # Run a specific scenario (1-15)
+ *   ./drip-ml-test --jobs 4       # Run scenarios on 4 worker threads
  *   ./drip-ml-test --verbose      # Show extra details
+ *   ./drip-ml-test --soak 12h     # Loop scenarios 6+7, tracking RSS/fds/sockets/latency drift
+ *   ./drip-ml-test --json F       # Per-scenario durations and pass/fail as JSON
+ *   ./drip-ml-test --baseline F   # Exit 1 if a scenario got slower than in F (--max-regress)
+ *   ./drip-ml-test --offline      # No API: synthetic responses (plus --faults SPEC)
  */
 
 #include <drip/drip.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <map>
 #include <string>
+#include <thread>
 #include <vector>
 #include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <sstream>
 #include <iomanip>
 #include <cmath>
 
+#include "client_metrics.hpp"
+#include "event_queue.hpp"
+#include "latency_histogram.hpp"
+#include "meter_registry.hpp"
+#include "perf_report.hpp"
+#include "process_stats.hpp"
+#include "run_stream.hpp"
+#include "soak_monitor.hpp"
+#include "spool.hpp"
+#include "usage_aggregator.hpp"
+#include "usage_batcher.hpp"
+#include "workflow_cache.hpp"
+
 // =============================================================================
 // ANSI colors
 // =============================================================================
@@ -78,12 +107,31 @@ static int64_t now_ms() {
     ).count();
 }
 
+static int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
 static std::string to_string_2f(double v) {
     std::ostringstream ss;
     ss << std::fixed << std::setprecision(2) << v;
     return ss.str();
 }
 
+/** Slug -> workflow ID for scenarios that call startRun, shared across scenarios and --jobs workers. */
+static std::string cached_workflow_id(drip::Client& client, const std::string& customer_id,
+                                      const std::string& slug) {
+    static WorkflowCache cache;
+    return cache.get(slug, [&] { return resolve_workflow_via_record_run(client, customer_id, slug); });
+}
+
 // =============================================================================
 // Scenario 1: Multi-Epoch Training Run
 //
@@ -143,7 +191,7 @@ static ScenarioResult scenario_training_run(drip::Client& client,
         summary.metadata["total_tokens"] = std::to_string(total_tokens);
         params.events.push_back(summary);
 
-        auto result = client.recordRun(params);
+        auto result = metered(Endpoint::RECORD_RUN, params, [&] { return client.recordRun(params); });
         int dur = static_cast<int>(now_ms() - start);
 
         std::ostringstream msg;
@@ -225,7 +273,7 @@ static ScenarioResult scenario_checkpoint_tracking(drip::Client& client,
             }
         }
 
-        auto result = client.recordRun(params);
+        auto result = metered(Endpoint::RECORD_RUN, params, [&] { return client.recordRun(params); });
         int dur = static_cast<int>(now_ms() - start);
 
         std::ostringstream msg;
@@ -293,7 +341,7 @@ static ScenarioResult scenario_per_user_attribution(drip::Client& client,
                  << ": " << users[i].tokens << " tokens on " << users[i].model;
             params.description = desc.str();
 
-            auto result = client.trackUsage(params);
+            auto result = metered(Endpoint::TRACK_USAGE, params, [&] { return client.trackUsage(params); });
             ++total_events;
 
             if (verbose) {
@@ -362,7 +410,7 @@ static ScenarioResult scenario_failed_training(drip::Client& client,
         fail_evt.metadata["cause"] = "learning_rate_too_high";
         params.events.push_back(fail_evt);
 
-        auto result = client.recordRun(params);
+        auto result = metered(Endpoint::RECORD_RUN, params, [&] { return client.recordRun(params); });
         int dur = static_cast<int>(now_ms() - start);
 
         std::ostringstream msg;
@@ -449,7 +497,7 @@ static ScenarioResult scenario_model_comparison(drip::Client& client,
             eval.metadata["total_tokens"] = std::to_string(total_tokens);
             params.events.push_back(eval);
 
-            auto result = client.recordRun(params);
+            auto result = metered(Endpoint::RECORD_RUN, params, [&] { return client.recordRun(params); });
             ++total_runs;
 
             if (verbose) {
@@ -488,40 +536,9 @@ static ScenarioResult scenario_incremental_run(drip::Client& client,
                                                bool verbose) {
     auto start = now_ms();
     try {
-        // Step 0: Ensure the workflow exists by doing a quick recordRun first.
-        // startRun requires an existing workflow ID, while recordRun auto-creates.
-        {
-            drip::RecordRunParams seed;
-            seed.customer_id = customer_id;
-            seed.workflow = "glades-realtime-training";
-            seed.status = drip::RUN_COMPLETED;
-
-            drip::RecordRunEvent evt;
-            evt.event_type = "workflow.init";
-            evt.quantity = 1;
-            evt.description = "Workflow bootstrap for incremental API test";
-            seed.events.push_back(evt);
-
-            client.recordRun(seed);
-        }
-
-        // Step 1: Start the run using the now-existing workflow slug
-        // We need the workflow ID — get it from a fresh recordRun result
-        std::string workflow_id;
-        {
-            drip::RecordRunParams probe;
-            probe.customer_id = customer_id;
-            probe.workflow = "glades-realtime-training";
-            probe.status = drip::RUN_COMPLETED;
-
-            drip::RecordRunEvent evt;
-            evt.event_type = "workflow.probe";
-            evt.quantity = 1;
-            probe.events.push_back(evt);
-
-            auto probe_result = client.recordRun(probe);
-            workflow_id = probe_result.run.workflow_id;
-        }
+        // Step 0: startRun requires an existing workflow ID, while recordRun
+        // auto-creates; the cache pays for that seed recordRun once per slug.
+        std::string workflow_id = cached_workflow_id(client, customer_id, "glades-realtime-training");
 
         drip::StartRunParams start_params;
         start_params.customer_id = customer_id;
@@ -530,7 +547,7 @@ static ScenarioResult scenario_incremental_run(drip::Client& client,
         start_params.metadata["framework"] = "glades-ml";
         start_params.metadata["mode"] = "incremental";
 
-        auto run = client.startRun(start_params);
+        auto run = metered(Endpoint::START_RUN, [&] { return client.startRun(start_params); });
         std::string run_id = run.id;
 
         std::ostringstream detail_ss;
@@ -541,27 +558,24 @@ static ScenarioResult scenario_incremental_run(drip::Client& client,
         // Step 2: Emit events as training progresses
         int events_emitted = 0;
         for (int epoch = 1; epoch <= 4; ++epoch) {
-            drip::EmitEventParams evt;
-            evt.run_id = run_id;
-            evt.event_type = "training.epoch";
-            evt.quantity = 1536;
-            evt.units = "tokens";
-            evt.cost_units = 1536 * 0.00001;
-            evt.metadata["epoch"] = std::to_string(epoch);
-
             double loss = 2.0 * std::exp(-0.2 * epoch);
-            evt.metadata["loss"] = to_string_2f(loss);
+
+            std::ostringstream desc;
+            desc << "Epoch " << epoch << ": 1536 tokens, loss=" << to_string_2f(loss);
+
+            Event<EventType::TRAINING_EPOCH> evt(1536);
+            evt.units("tokens")
+               .cost_units(1536 * 0.00001)
+               .description(desc.str())
+               .set<MetaKey::EPOCH>(epoch)
+               .set<MetaKey::LOSS>(loss, 2);
 
             // Unique idempotency key per epoch to avoid dedup
             std::ostringstream idem;
             idem << "incr-epoch-" << run_id << "-" << epoch;
-            evt.idempotency_key = idem.str();
 
-            std::ostringstream desc;
-            desc << "Epoch " << epoch << ": 1536 tokens, loss=" << to_string_2f(loss);
-            evt.description = desc.str();
-
-            auto result = client.emitEvent(evt);
+            drip::EmitEventParams emit = evt.to_emit(run_id, idem.str());
+            auto result = metered(Endpoint::EMIT_EVENT, emit, [&] { return client.emitEvent(emit); });
             ++events_emitted;
 
             if (verbose) {
@@ -580,7 +594,7 @@ static ScenarioResult scenario_incremental_run(drip::Client& client,
             ckpt.description = "Mid-training checkpoint";
             ckpt.metadata["checkpoint_path"] = "live/play2train-v1-mid.bin";
             ckpt.idempotency_key = "incr-ckpt-" + run_id;
-            client.emitEvent(ckpt);
+            metered(Endpoint::EMIT_EVENT, ckpt, [&] { return client.emitEvent(ckpt); });
             ++events_emitted;
         }
 
@@ -590,7 +604,7 @@ static ScenarioResult scenario_incremental_run(drip::Client& client,
         end_params.metadata["final_loss"] = "1.10";
         end_params.metadata["total_epochs"] = "4";
 
-        auto end_result = client.endRun(run_id, end_params);
+        auto end_result = metered(Endpoint::END_RUN, [&] { return client.endRun(run_id, end_params); });
 
         if (verbose) {
             detail_ss << "Run ended: duration=" << end_result.duration_ms
@@ -665,7 +679,7 @@ static ScenarioResult scenario_inference_metering(drip::Client& client,
         summary.description = "Batch of " + std::to_string(total_predictions) + " predictions";
         params.events.push_back(summary);
 
-        auto result = client.recordRun(params);
+        auto result = metered(Endpoint::RECORD_RUN, params, [&] { return client.recordRun(params); });
         int dur = static_cast<int>(now_ms() - start);
 
         std::ostringstream msg;
@@ -716,13 +730,13 @@ static ScenarioResult scenario_idempotency(drip::Client& client,
         params.description = "Idempotency test: first send";
         params.metadata["attempt"] = "1";
 
-        auto result1 = client.trackUsage(params);
+        auto result1 = metered(Endpoint::TRACK_USAGE, params, [&] { return client.trackUsage(params); });
 
         // Second call — same idempotency key, should be deduplicated
         params.metadata["attempt"] = "2";
         params.description = "Idempotency test: retry (should dedup)";
 
-        auto result2 = client.trackUsage(params);
+        auto result2 = metered(Endpoint::TRACK_USAGE, params, [&] { return client.trackUsage(params); });
 
         int dur = static_cast<int>(now_ms() - start);
 
@@ -803,7 +817,7 @@ static ScenarioResult scenario_hyperparam_sweep(drip::Client& client,
                     params.events.push_back(evt);
                 }
 
-                auto result = client.recordRun(params);
+                auto result = metered(Endpoint::RECORD_RUN, params, [&] { return client.recordRun(params); });
 
                 if (verbose) {
                     detail_ss << "  lr=" << to_string_2f(lr)
@@ -888,7 +902,7 @@ static ScenarioResult scenario_batch_inference(drip::Client& client,
         eval.metadata["throughput_items_per_sec"] = "250";
         params.events.push_back(eval);
 
-        auto result = client.recordRun(params);
+        auto result = metered(Endpoint::RECORD_RUN, params, [&] { return client.recordRun(params); });
         int dur = static_cast<int>(now_ms() - start);
 
         std::ostringstream msg;
@@ -912,6 +926,467 @@ static ScenarioResult scenario_batch_inference(drip::Client& client,
     }
 }
 
+// =============================================================================
+// Scenario 11: Batched Inference Metering
+//
+// Production meters every prediction. Scenario 7 shows the per-request cost
+// when each prediction is its own trackUsage() round-trip; here the same
+// traffic goes through a UsageBatcher, which coalesces events per
+// customer/meter on a background thread. Reports events/sec and p99 of the
+// producer-side call for both paths.
+// =============================================================================
+
+static drip::TrackUsageParams make_prediction_usage(const std::string& customer_id, int i) {
+    int req_tokens = (64 + (i * 13) % 200) + (32 + (i * 7) % 100);
+    return Usage<Meter::ML_INFERENCE_TOKENS>(customer_id, req_tokens)
+        .set<MetaKey::MODEL_NAME>("play2train-ffn-v3")
+        .set<MetaKey::REQUEST_ID>("req-" + std::to_string(i))
+        .to_params();
+}
+
+static ScenarioResult scenario_batched_inference(drip::Client& client,
+                                                 const std::string& customer_id,
+                                                 bool verbose) {
+    auto start = now_ms();
+    try {
+        const int per_call_events = 20;
+        const int batched_events = 1000;
+
+        // Per-call path: the producer waits for every round-trip
+        LatencyHistogram call_latency;
+        int64_t t0 = now_us();
+        for (int i = 1; i <= per_call_events; ++i) {
+            drip::TrackUsageParams params = make_prediction_usage(customer_id, i);
+            int64_t c0 = now_us();
+            metered(Endpoint::TRACK_USAGE, params, [&] { return client.trackUsage(params); });
+            call_latency.record(now_us() - c0);
+        }
+        double per_call_s = (now_us() - t0) / 1e6;
+
+        // Batched path: the producer only pays for the enqueue
+        UsageBatcherOptions opts;
+        opts.max_batch_size = 250;
+        opts.max_linger_ms = 20;
+        UsageBatcher batcher(client, opts);
+
+        LatencyHistogram enqueue_latency;
+        double quantity_total = 0;
+        t0 = now_us();
+        for (int i = 1; i <= batched_events; ++i) {
+            drip::TrackUsageParams params = make_prediction_usage(customer_id, i);
+            quantity_total += params.quantity;
+            int64_t c0 = now_us();
+            batcher.enqueue(params);
+            enqueue_latency.record(now_us() - c0);
+        }
+        batcher.flush();
+        double batched_s = (now_us() - t0) / 1e6;
+        UsageBatcherStats st = batcher.stats();
+
+        int dur = static_cast<int>(now_ms() - start);
+        bool ok = st.events_failed == 0 && st.events_sent == static_cast<uint64_t>(batched_events);
+
+        double per_call_rate = per_call_s > 0 ? per_call_events / per_call_s : 0;
+        double batched_rate = batched_s > 0 ? batched_events / batched_s : 0;
+
+        std::ostringstream msg;
+        msg << "per-call " << to_string_2f(per_call_rate) << " ev/s (p99 "
+            << to_string_2f(call_latency.percentile(0.99) / 1000.0) << "ms) vs batched "
+            << to_string_2f(batched_rate) << " ev/s (p99 enqueue "
+            << enqueue_latency.percentile(0.99) << "us)";
+        if (!ok) msg << " | " << st.events_failed << " events failed: " << st.last_error;
+
+        std::ostringstream ds;
+        if (verbose) {
+            ds << "Per-call: " << per_call_events << " trackUsage calls in "
+               << to_string_2f(per_call_s) << "s\n"
+               << "Batched: " << st.events_sent << " events in " << st.calls_sent
+               << " calls, " << to_string_2f(batched_s) << "s incl. final flush\n"
+               << "Batched quantity: " << to_string_2f(quantity_total) << " tokens\n"
+               << "Enqueue p50/p99/max: " << enqueue_latency.percentile(0.50) << "/"
+               << enqueue_latency.percentile(0.99) << "/" << enqueue_latency.max() << "us";
+        }
+
+        return {11, "Batched Inference Metering", ok, dur, msg.str(), ds.str()};
+    } catch (const drip::DripError& e) {
+        int dur = static_cast<int>(now_ms() - start);
+        return {11, "Batched Inference Metering", false, dur,
+                std::string("Failed: ") + e.what(), ""};
+    }
+}
+
+// =============================================================================
+// Scenario 12: Async Event Emission
+//
+// Same lifecycle as scenario 6, but the training loop hands each epoch event
+// to an AsyncEventSender instead of calling emitEvent() inline. The step only
+// pays for a lock-free enqueue; a sender thread delivers the events in order
+// and the run is closed after flush(). Reports producer-side cost per emit.
+// =============================================================================
+
+static ScenarioResult scenario_async_events(drip::Client& client,
+                                            const std::string& customer_id,
+                                            bool verbose) {
+    auto start = now_ms();
+    try {
+        // startRun needs a workflow ID; recordRun auto-creates the workflow
+        std::string workflow_id = cached_workflow_id(client, customer_id, "glades-async-training");
+
+        drip::StartRunParams start_params;
+        start_params.customer_id = customer_id;
+        start_params.workflow_id = workflow_id;
+        start_params.metadata["model_name"] = "play2train-live-v1";
+        start_params.metadata["mode"] = "async_emit";
+        std::string run_id = metered(Endpoint::START_RUN, [&] { return client.startRun(start_params); }).id;
+
+        const int epochs = 200;
+        LatencyHistogram emit_ns;
+        AsyncEventSender sender(client, 1024);
+
+        for (int epoch = 1; epoch <= epochs; ++epoch) {
+            // Build the event as the training step would, then time only the hand-off
+            drip::EmitEventParams evt = Event<EventType::TRAINING_EPOCH>(1536)
+                .units("tokens")
+                .cost_units(1536 * 0.00001)
+                .set<MetaKey::EPOCH>(epoch)
+                .set<MetaKey::LOSS>(2.0 * std::exp(-0.02 * epoch), 2)
+                .to_emit(run_id);
+
+            int64_t t0 = now_ns();
+            bool queued = sender.emit(std::move(evt));
+            int64_t elapsed = now_ns() - t0;
+            if (queued) {
+                emit_ns.record(elapsed);
+            } else {
+                // Queue full: this step waits for the sender, as a real loop would;
+                // the rejected attempt stays out of emit_ns so the retry isn't counted twice
+                sender.flush();
+                --epoch;
+            }
+        }
+
+        int64_t flush_start = now_ms();
+        sender.flush();
+        int flush_ms = static_cast<int>(now_ms() - flush_start);
+        AsyncEventSenderStats st = sender.stats();
+
+        drip::EndRunParams end_params;
+        end_params.status = drip::RUN_COMPLETED;
+        end_params.metadata["total_epochs"] = std::to_string(epochs);
+        auto end_result = metered(Endpoint::END_RUN, [&] { return client.endRun(run_id, end_params); });
+
+        int dur = static_cast<int>(now_ms() - start);
+        bool ok = st.failed == 0 && st.sent == static_cast<uint64_t>(epochs);
+
+        std::ostringstream msg;
+        msg << st.sent << "/" << epochs << " events, emit p50 " << emit_ns.percentile(0.50)
+            << "ns p99 " << emit_ns.percentile(0.99) << "ns (max " << emit_ns.max() << "ns)";
+        if (!ok) msg << " | " << st.failed << " failed: " << st.last_error;
+
+        std::ostringstream ds;
+        if (verbose) {
+            ds << "Run ID: " << run_id << "\n"
+               << "Queue-full stalls: " << st.rejected << ", retries: " << st.retries << "\n"
+               << "Drain after loop: " << flush_ms << "ms\n"
+               << "Run ended: events=" << end_result.event_count
+               << ", duration=" << end_result.duration_ms << "ms";
+        }
+
+        return {12, "Async Event Emission", ok, dur, msg.str(), ds.str()};
+    } catch (const drip::DripError& e) {
+        int dur = static_cast<int>(now_ms() - start);
+        return {12, "Async Event Emission", false, dur,
+                std::string("Failed: ") + e.what(), ""};
+    }
+}
+
+// =============================================================================
+// Scenario 13: Streaming Batch Scoring (1M items)
+//
+// Scenario 10 at production size. Scoring a million items in batches of 100
+// is 10,000 events; rather than building one RecordRunParams holding all of
+// them, events go through a RunStreamWriter that uploads them as paginated
+// recordRun() parts while scoring continues. Passes when every event was
+// created in the expected number of parts. Reports how far current RSS rose
+// above its starting value (sampled at each part boundary), which should
+// barely move; the process's peak RSS can't show this, since it never drops.
+// =============================================================================
+
+static ScenarioResult scenario_streaming_batch_scoring(drip::Client& client,
+                                                       const std::string& customer_id,
+                                                       bool verbose) {
+    auto start = now_ms();
+    try {
+        const int total_items = 1000000;
+        const int batch_size = 100;
+        const int batches = total_items / batch_size;
+        int64_t rss_before = sample_process().rss_bytes;
+        int64_t rss_peak = rss_before;
+
+        drip::RecordRunParams header;
+        header.customer_id = customer_id;
+        header.workflow = "glades-batch-inference";
+        header.status = drip::RUN_COMPLETED;
+        header.metadata["model_name"] = "play2train-ffn-v3.2";
+        header.metadata["dataset"] = "user-full-set-2024";
+        header.metadata["dataset_size"] = std::to_string(total_items);
+
+        RunStreamOptions opts;
+        opts.max_events_per_request = 500;
+        RunStreamWriter writer(client, header, opts);
+
+        int64_t total_tokens = 0;
+        int64_t first_send_ms = -1;
+        for (int batch = 1; batch <= batches; ++batch) {
+            int tokens = batch_size * 128; // 128 tokens avg per item
+            total_tokens += tokens;
+
+            drip::RecordRunEvent evt;
+            evt.event_type = "inference.batch";
+            evt.quantity = tokens;
+            evt.units = "tokens";
+            evt.cost_units = tokens * 0.000003; // bulk inference discount
+            evt.metadata["batch_number"] = std::to_string(batch);
+            evt.metadata["items_scored"] = std::to_string(batch_size);
+            evt.metadata["accuracy"] = to_string_2f(0.89 + 0.00001 * (batch % 1000));
+            evt.description = "Batch " + std::to_string(batch) + "/" + std::to_string(batches);
+            writer.add(std::move(evt));
+            if (batch % opts.max_events_per_request == 0) {
+                rss_peak = std::max(rss_peak, sample_process().rss_bytes);
+            }
+
+            if (first_send_ms < 0 && batch == static_cast<int>(opts.max_events_per_request)) {
+                first_send_ms = now_ms() - start;
+            }
+        }
+
+        drip::RecordRunEvent eval;
+        eval.event_type = "inference.evaluation";
+        eval.quantity = total_items;
+        eval.units = "predictions";
+        eval.description = "Dataset scoring complete";
+        eval.metadata["total_items"] = std::to_string(total_items);
+        eval.metadata["total_tokens"] = std::to_string(total_tokens);
+        writer.add(std::move(eval));
+
+        RunStreamStats st = writer.finish();
+        rss_peak = std::max(rss_peak, sample_process().rss_bytes);
+        int dur = static_cast<int>(now_ms() - start);
+
+        const uint64_t expected_events = static_cast<uint64_t>(batches) + 1;
+        const uint64_t expected_parts = (expected_events + opts.max_events_per_request - 1) /
+                                        opts.max_events_per_request;
+        bool ok = st.events == expected_events && st.requests == expected_parts &&
+                  st.events_created == st.events;
+
+        std::ostringstream msg;
+        msg << total_items << " items, " << st.events << " events in " << st.requests
+            << " recordRun parts, RSS ";
+        if (rss_before >= 0) {
+            msg << "+" << to_string_2f((rss_peak - rss_before) / 1048576.0) << " MB over "
+                << to_string_2f(rss_before / 1048576.0) << " MB";
+        } else {
+            msg << "n/a";
+        }
+        if (!ok) {
+            msg << " | expected " << expected_events << " events in " << expected_parts
+                << " parts, API created " << st.events_created;
+        }
+
+        std::string det;
+        if (verbose) {
+            std::ostringstream ds;
+            ds << "Stream ID: " << writer.stream_id() << "\n"
+               << "First part handed off at " << first_send_ms << "ms\n"
+               << "Events created: " << st.events_created
+               << ", cost=" << st.total_cost_units
+               << ", last run: " << st.last_run_id;
+            det = ds.str();
+        }
+
+        return {13, "Streaming Batch Scoring (1M items)", ok, dur, msg.str(), det};
+    } catch (const drip::DripError& e) {
+        int dur = static_cast<int>(now_ms() - start);
+        return {13, "Streaming Batch Scoring (1M items)", false, dur,
+                std::string("Failed: ") + e.what(), ""};
+    }
+}
+
+// =============================================================================
+// Scenario 14: Outage Resilience (spooled metering)
+//
+// Prediction usage goes to a UsageSpool file instead of straight to the API,
+// and a SpoolDrainer replays it. Mid-run the drainer is pointed at a client
+// whose API is unreachable (connection refused), so events pile up in the
+// spool while producers keep appending at memory speed. Connectivity is then
+// restored and the backlog replays with its spool-assigned idempotency keys.
+// Reports append latency during the outage and replay throughput afterwards.
+// =============================================================================
+
+static ScenarioResult scenario_outage_resilience(drip::Client& client,
+                                                 const std::string& customer_id,
+                                                 bool verbose) {
+    auto start = now_ms();
+    std::string path = env_or("DRIP_SPOOL_PATH", "drip-ml-test.spool");
+    std::remove(path.c_str());
+    try {
+        const int before_outage = 100;
+        const int during_outage = 1000;
+
+        drip::Config dead_config;
+        dead_config.api_key = env_or("DRIP_API_KEY", "");
+        dead_config.base_url = "http://127.0.0.1:9/v1";  // Discard port: connection refused
+        drip::Client dead_client(dead_config);
+
+        // Offline there is no endpoint to be unreachable, so the outage is injected
+        FaultInjector& faults = FaultInjector::instance();
+        bool injected_outage = faults.offline();
+
+        UsageSpool spool(path, 8 * 1024 * 1024);
+        SpoolDrainer drainer(spool, client);
+
+        // Healthy: appends drain as they arrive
+        for (int i = 0; i < before_outage; ++i) spool.append(make_prediction_usage(customer_id, i));
+        drainer.notify();
+        bool drained_before = drainer.wait_drained(std::chrono::milliseconds(60000));
+
+        // Outage: the drainer can't deliver, producers keep appending
+        if (injected_outage) faults.set_outage(true);
+        else drainer.set_client(dead_client);
+        LatencyHistogram append_ns;
+        int spooled = 0;
+        for (int i = 0; i < during_outage; ++i) {
+            drip::TrackUsageParams p = make_prediction_usage(customer_id, before_outage + i);
+            int64_t t0 = now_ns();
+            bool ok = spool.append(p);
+            append_ns.record(now_ns() - t0);
+            if (ok) ++spooled;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        size_t backlog_bytes = spool.pending_bytes();
+        SpoolDrainerStats outage_stats = drainer.stats();
+
+        // Recovery: replay the backlog
+        int64_t replay_start = now_us();
+        if (injected_outage) faults.set_outage(false);
+        drainer.set_client(client);
+        bool drained_after = drainer.wait_drained(std::chrono::milliseconds(300000));
+        int64_t replay_us = now_us() - replay_start;
+        SpoolDrainerStats st = drainer.stats();
+
+        int dur = static_cast<int>(now_ms() - start);
+        uint64_t expected = static_cast<uint64_t>(before_outage + spooled);
+        bool ok = drained_before && drained_after && spooled == during_outage &&
+                  st.dropped == 0 && st.replayed == expected && outage_stats.failed_attempts > 0;
+        double replay_rate = replay_us > 0 ? spooled * 1e6 / replay_us : 0;
+
+        std::ostringstream msg;
+        msg << spooled << " events spooled during outage (append p99 "
+            << append_ns.percentile(0.99) << "ns), replayed at "
+            << static_cast<int>(replay_rate) << " events/s";
+        if (!ok) {
+            msg << " | replayed " << st.replayed << "/" << expected << ", dropped " << st.dropped;
+            if (!st.last_error.empty()) msg << ": " << st.last_error;
+        }
+
+        std::ostringstream ds;
+        if (verbose) {
+            ds << "Spool: " << path << "\n"
+               << "Backlog at recovery: " << backlog_bytes << " bytes, "
+               << outage_stats.failed_attempts << " failed delivery attempts\n"
+               << "Append p50 " << append_ns.percentile(0.50) << "ns, max " << append_ns.max() << "ns\n"
+               << "Replay: " << (replay_us / 1000) << "ms for " << spooled << " events";
+        }
+
+        std::remove(path.c_str());
+        return {14, "Outage Resilience (spooled metering)", ok, dur, msg.str(), ds.str()};
+    } catch (const std::exception& e) {
+        if (FaultInjector::instance().outage()) FaultInjector::instance().set_outage(false);
+        std::remove(path.c_str());
+        int dur = static_cast<int>(now_ms() - start);
+        return {14, "Outage Resilience (spooled metering)", false, dur,
+                std::string("Failed: ") + e.what(), ""};
+    }
+}
+
+// =============================================================================
+// Scenario 15: Pre-aggregated GPU-Second Metering
+//
+// Every prediction bills fractional GPU-seconds on one of several models.
+// A UsageAggregator keyed on model_name rolls each model's events up into
+// one trackUsage() per window, so the API sees a handful of calls instead of
+// one per prediction. Billing must not drift: the quantities the API echoes
+// back have to sum to exactly what the unaggregated events add up to.
+// =============================================================================
+
+static ScenarioResult scenario_aggregated_gpu_metering(drip::Client& client,
+                                                       const std::string& customer_id,
+                                                       bool verbose) {
+    auto start = now_ms();
+    try {
+        const int events = 3000;
+        const char* models[] = {"play2train-ffn-v3", "play2train-cnn-v2", "glades-transformer-s"};
+        const int num_models = 3;
+
+        UsageAggregatorOptions opts;
+        opts.window_ms = 250;
+        opts.dimensions.push_back(name_of(MetaKey::MODEL_NAME).str);
+        UsageAggregator aggregator(client, opts);
+
+        // Whole milliseconds of GPU time, so every event is exact at the 1e-6 scale
+        int64_t expected_ms = 0;
+        double naive_sum = 0;
+        LatencyHistogram add_latency;
+        for (int i = 1; i <= events; ++i) {
+            int gpu_ms = 3 + (i * 37) % 180;
+            double gpu_s = gpu_ms / 1000.0;
+            expected_ms += gpu_ms;
+            naive_sum += gpu_s;
+            drip::TrackUsageParams params = Usage<Meter::ML_INFERENCE_GPU_SECONDS>(customer_id, gpu_s)
+                .set<MetaKey::MODEL_NAME>(models[i % num_models])
+                .set<MetaKey::REQUEST_ID>("req-" + std::to_string(i))
+                .to_params();
+            int64_t c0 = now_us();
+            aggregator.add(params, gpu_ms * 2 / 1e6);
+            add_latency.record(now_us() - c0);
+        }
+        aggregator.flush();
+        UsageAggregatorStats st = aggregator.stats();
+
+        int dur = static_cast<int>(now_ms() - start);
+        int64_t expected = expected_ms * 1000;  // ms -> 1e-6 s
+        bool ok = st.exact() && st.quantity_billed == expected && st.passthrough == 0 &&
+                  st.events_failed == 0 && st.events_sent == static_cast<uint64_t>(events);
+
+        std::ostringstream msg;
+        msg << events << " events -> " << st.calls_sent << " calls, billed "
+            << to_string_2f(aggregator.to_units(st.quantity_billed)) << " GPU-s (expected "
+            << to_string_2f(expected_ms / 1000.0) << ")";
+        if (!ok) {
+            msg << " | billed " << st.quantity_billed << " vs " << expected << " micro-s, "
+                << st.passthrough << " passed through, " << st.events_failed << " failed";
+            if (!st.last_error.empty()) msg << ": " << st.last_error;
+        }
+
+        std::ostringstream ds;
+        if (verbose) {
+            char drift[32];
+            std::snprintf(drift, sizeof(drift), "%.3g", naive_sum - expected_ms / 1000.0);
+            ds << "Models: " << num_models << ", window " << opts.window_ms << "ms\n"
+               << "Events per call: " << to_string_2f(st.calls_sent ? double(events) / st.calls_sent : 0) << "\n"
+               << "Naive double sum drift: " << drift << " GPU-s\n"
+               << "add() p50/p99/max: " << add_latency.percentile(0.50) << "/"
+               << add_latency.percentile(0.99) << "/" << add_latency.max() << "us";
+        }
+
+        return {15, "Pre-aggregated GPU-Second Metering", ok, dur, msg.str(), ds.str()};
+    } catch (const std::exception& e) {
+        int dur = static_cast<int>(now_ms() - start);
+        return {15, "Pre-aggregated GPU-Second Metering", false, dur,
+                std::string("Failed: ") + e.what(), ""};
+    }
+}
+
 // =============================================================================
 // Reporter
 // =============================================================================
@@ -942,6 +1417,243 @@ static void print_scenario(const ScenarioResult& r, bool verbose) {
     }
 }
 
+// =============================================================================
+// Scenario runner
+// =============================================================================
+
+typedef ScenarioResult (*ScenarioFn)(drip::Client&, const std::string&, bool);
+
+struct Scenario {
+    int number;
+    ScenarioFn fn;
+    bool exclusive;        // Measures its own throughput/latency; never shares the client with other scenarios
+    const char* workflow;  // Slug its recordRun() calls create on first use, or null
+};
+
+/**
+ * Run `scenarios` and return their results in the same order. With jobs > 1
+ * a pool of `jobs` threads pulls scenarios off a shared counter and runs them
+ * against the one client; exclusive scenarios run afterwards, one at a time,
+ * so their timings are not skewed by the rest of the suite. A workflow slug
+ * that two pooled scenarios share is resolved once before the pool starts:
+ * concurrent first recordRun()s of one slug race its creation and 404
+ * (RACE_TEST_REPORT.md #2).
+ */
+static std::vector<ScenarioResult> run_scenarios(const std::vector<Scenario>& scenarios, int jobs,
+                                                 drip::Client& client, const std::string& customer_id,
+                                                 bool verbose) {
+    std::vector<ScenarioResult> results(scenarios.size());
+    if (jobs <= 1) {
+        for (size_t i = 0; i < scenarios.size(); ++i) {
+            results[i] = scenarios[i].fn(client, customer_id, verbose);
+        }
+        return results;
+    }
+
+    std::vector<size_t> pooled, exclusive;
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        (scenarios[i].exclusive ? exclusive : pooled).push_back(i);
+    }
+
+    std::map<std::string, int> slug_users;
+    for (size_t k = 0; k < pooled.size(); ++k) {
+        if (scenarios[pooled[k]].workflow) ++slug_users[scenarios[pooled[k]].workflow];
+    }
+    for (std::map<std::string, int>::const_iterator it = slug_users.begin(); it != slug_users.end(); ++it) {
+        if (it->second < 2) continue;
+        try {
+            cached_workflow_id(client, customer_id, it->first);
+        } catch (const std::exception& e) {
+            std::cerr << DIM << "  Could not pre-resolve workflow " << it->first << ": " << e.what()
+                      << RESET << std::endl;
+        }
+    }
+
+    auto run_one = [&](size_t i) {
+        try {
+            results[i] = scenarios[i].fn(client, customer_id, verbose);
+        } catch (const std::exception& e) {
+            results[i] = {scenarios[i].number, "Scenario " + std::to_string(scenarios[i].number),
+                          false, 0, std::string("Failed: ") + e.what(), ""};
+        }
+    };
+
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    size_t threads = std::min(static_cast<size_t>(jobs), pooled.size());
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (size_t k; (k = next.fetch_add(1)) < pooled.size(); ) run_one(pooled[k]);
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    for (size_t k = 0; k < exclusive.size(); ++k) run_one(exclusive[k]);
+    return results;
+}
+
+// =============================================================================
+// Soak mode
+// =============================================================================
+
+/** "90", "90s", "30m", "12h" or "2d" as seconds; 0 if it doesn't parse. */
+static int64_t parse_duration_s(const std::string& text) {
+    char* end = nullptr;
+    double v = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || v <= 0) return 0;
+    std::string unit(end);
+    if (unit.empty() || unit == "s") return static_cast<int64_t>(v);
+    if (unit == "m") return static_cast<int64_t>(v * 60);
+    if (unit == "h") return static_cast<int64_t>(v * 3600);
+    if (unit == "d") return static_cast<int64_t>(v * 86400);
+    return 0;
+}
+
+static std::string format_elapsed(double seconds) {
+    int64_t s = static_cast<int64_t>(seconds);
+    char buf[32];
+    if (s >= 3600) std::snprintf(buf, sizeof(buf), "%lldh%02lldm%02llds", (long long)(s / 3600), (long long)(s / 60 % 60), (long long)(s % 60));
+    else std::snprintf(buf, sizeof(buf), "%lldm%02llds", (long long)(s / 60), (long long)(s % 60));
+    return buf;
+}
+
+static std::string format_reading(int64_t v) {
+    return v < 0 ? std::string("n/a") : std::to_string(v);
+}
+
+/**
+ * --soak: loop the incremental run lifecycle (scenario 6) and inference
+ * metering (scenario 7) for `duration_s`, sampling RSS, descriptors,
+ * sockets, threads and interval latency every `interval_s`. Fails if any
+ * iteration failed or SoakMonitor sees a series grow steadily.
+ */
+static int run_soak(drip::Client& client, const std::string& customer_id, int64_t duration_s,
+                    int64_t interval_s, PerfReport& perf) {
+    struct Workload {
+        const char* name;
+        ScenarioFn fn;
+        LatencyHistogram latency;  // Whole run, microseconds
+        uint64_t errors;
+    };
+    Workload workloads[] = {
+        {"incremental run", scenario_incremental_run, LatencyHistogram(), 0},
+        {"inference metering", scenario_inference_metering, LatencyHistogram(), 0}
+    };
+    const size_t num_workloads = 2;
+
+    std::cout << "  Soaking for " << format_elapsed(static_cast<double>(duration_s)) << ", sampling every "
+              << interval_s << "s (scenarios 6 and 7 in a loop)" << std::endl << std::endl;
+    std::cout << "  " << std::left << std::setw(11) << "elapsed" << std::right << std::setw(8) << "iters"
+              << std::setw(8) << "errors" << std::setw(11) << "rss MB" << std::setw(6) << "fds"
+              << std::setw(9) << "sockets" << std::setw(9) << "threads" << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p99 ms" << std::endl;
+
+    SoakMonitor monitor;
+    LatencyHistogram interval;
+    uint64_t iterations = 0, errors = 0;
+    std::vector<std::string> failures;
+    const int64_t start_us = now_us();
+    const int64_t end_us = start_us + duration_s * 1000000;
+    int64_t next_sample_us = start_us + interval_s * 1000000;
+
+    auto sample = [&](int64_t at_us) {
+        SoakSample s;
+        s.elapsed_s = (at_us - start_us) / 1e6;
+        s.iterations = iterations;
+        s.errors = errors;
+        s.process = sample_process();
+        s.p50_us = interval.percentile(0.50);
+        s.p99_us = interval.percentile(0.99);
+        monitor.add(s);
+        interval.reset();
+        std::cout << "  " << std::left << std::setw(11) << format_elapsed(s.elapsed_s) << std::right
+                  << std::setw(8) << s.iterations << std::setw(8) << s.errors
+                  << std::setw(11) << (s.process.rss_bytes < 0 ? std::string("n/a")
+                                                               : to_string_2f(s.process.rss_bytes / 1048576.0))
+                  << std::setw(6) << format_reading(s.process.open_fds)
+                  << std::setw(9) << format_reading(s.process.sockets)
+                  << std::setw(9) << format_reading(s.process.threads)
+                  << std::setw(10) << to_string_2f(s.p50_us / 1000.0)
+                  << std::setw(10) << to_string_2f(s.p99_us / 1000.0) << std::endl;
+    };
+
+    for (int64_t now = now_us(); now < end_us; now = now_us()) {
+        Workload& w = workloads[iterations % num_workloads];
+        bool ok = false;
+        std::string failure;
+        try {
+            ScenarioResult r = w.fn(client, customer_id, false);
+            ok = r.success;
+            if (!ok) failure = r.message;
+        } catch (const std::exception& e) {
+            failure = e.what();
+        }
+        int64_t us = now_us() - now;
+        w.latency.record(us);
+        interval.record(us);
+        ++iterations;
+        if (!ok) {
+            ++w.errors;
+            ++errors;
+            if (failures.size() < 5) failures.push_back(std::string(w.name) + ": " + failure);
+        }
+        int64_t done = now_us();
+        if (done >= next_sample_us) {
+            sample(done);
+            next_sample_us += interval_s * 1000000;
+        }
+    }
+    if (interval.count() > 0) sample(now_us());
+
+    std::cout << std::endl;
+    bool leaked = false;
+    std::vector<SoakVerdict> verdicts = monitor.verdicts();
+    for (size_t i = 0; i < verdicts.size(); ++i) {
+        const SoakVerdict& v = verdicts[i];
+        std::cout << "  ";
+        if (!v.judged) {
+            std::cout << DIM << "[SKIPPED]" << RESET << " " << std::left << std::setw(16) << v.metric
+                      << std::right << DIM << v.detail << RESET << std::endl;
+            continue;
+        }
+        std::string first = v.unit[0] ? to_string_2f(v.first * v.scale) : std::to_string(static_cast<int64_t>(v.first));
+        std::string last = v.unit[0] ? to_string_2f(v.last * v.scale) : std::to_string(static_cast<int64_t>(v.last));
+        std::cout << (v.flagged ? RED : GREEN) << (v.flagged ? "[GROWING]" : "[STABLE] ") << RESET << " "
+                  << std::left << std::setw(16) << v.metric << std::right
+                  << first << " -> " << last << (v.unit[0] ? " " : "") << v.unit
+                  << DIM << " (" << v.detail << ")" << RESET << std::endl;
+        leaked = leaked || v.flagged;
+    }
+    for (size_t i = 0; i < failures.size(); ++i) {
+        std::cout << "  " << RED << "ERROR: " << failures[i] << RESET << std::endl;
+    }
+
+    double elapsed_s = (now_us() - start_us) / 1e6;
+    for (size_t i = 0; i < num_workloads; ++i) {
+        perf.add(perf_entry("soak", workloads[i].name, workloads[i].latency, workloads[i].errors, elapsed_s));
+    }
+
+    std::cout << std::endl << "===========================================================" << std::endl;
+    if (!leaked && errors == 0) {
+        std::cout << GREEN << BOLD << "Soak passed: " << iterations << " iterations, no growth detected."
+                  << RESET << std::endl;
+    } else {
+        std::cout << RED << BOLD << "Soak failed: " << errors << " of " << iterations << " iterations failed"
+                  << (leaked ? ", resource or latency growth detected" : "") << "." << RESET << std::endl;
+    }
+    std::cout << std::endl;
+    return leaked || errors > 0 ? 1 : 0;
+}
+
+/** One DIM line of what --faults / --offline injected, if anything. */
+static void print_fault_summary() {
+    FaultInjector& faults = FaultInjector::instance();
+    if (!faults.active()) return;
+    std::cout << DIM << "  ";
+    faults.write_summary(std::cout);
+    std::cout << RESET << std::endl;
+}
+
 // =============================================================================
 // Main
 // =============================================================================
@@ -949,6 +1661,12 @@ static void print_scenario(const ScenarioResult& r, bool verbose) {
 int main(int argc, char** argv) {
     bool verbose = false;
     int specific_scenario = 0; // 0 = run all
+    int jobs = 1;
+    PerfOutput perf_out;
+    std::string max_regress;
+    int64_t soak_s = 0;
+    int64_t soak_interval_s = 0;  // 0 = pick from the soak duration
+    FaultOptions faults;
 
     for (int i = 1; i < argc; ++i) {
         if (std::strcmp(argv[i], "--verbose") == 0 || std::strcmp(argv[i], "-v") == 0) {
@@ -957,13 +1675,49 @@ int main(int argc, char** argv) {
             if (i + 1 < argc) {
                 specific_scenario = std::atoi(argv[++i]);
             }
+        } else if (std::strcmp(argv[i], "--jobs") == 0 || std::strcmp(argv[i], "-j") == 0) {
+            if (i + 1 < argc) {
+                jobs = std::atoi(argv[++i]);
+            }
+        } else if (std::strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            soak_s = parse_duration_s(argv[++i]);
+            if (soak_s <= 0) {
+                std::cerr << RED << "--soak needs a duration, e.g. 90s, 30m or 12h." << RESET << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--soak-interval") == 0 && i + 1 < argc) {
+            soak_interval_s = parse_duration_s(argv[++i]);
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            perf_out.json_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            perf_out.baseline_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--max-regress") == 0 && i + 1 < argc) {
+            max_regress = argv[++i];
+        } else if (std::strcmp(argv[i], "--faults") == 0 && i + 1 < argc) {
+            std::string error;
+            if (!faults.parse(argv[++i], error)) {
+                std::cerr << RED << "--faults: " << error << RESET << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--offline") == 0) {
+            faults.offline = true;
         } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
             std::cout << "Usage: drip-ml-test [OPTIONS]\n\n"
                       << "ML Training Integration Tests for Drip C++ SDK\n"
                       << "Simulates glades-ml / Play2Train training workflows.\n\n"
                       << "Options:\n"
-                      << "  --scenario N, -s N   Run a specific scenario (1-10)\n"
+                      << "  --scenario N, -s N   Run a specific scenario (1-15)\n"
+                      << "  --jobs N, -j N       Run up to N scenarios concurrently (11-15 still run alone)\n"
                       << "  --verbose, -v        Show extra details\n"
+                      << "  --soak DURATION      Loop scenarios 6 and 7 for DURATION (90s, 30m, 12h),\n"
+                      << "                       flagging RSS/fd/socket/thread growth and latency drift\n"
+                      << "  --soak-interval T    Sampling interval (default: 60s, or duration/20 if shorter)\n"
+                      << "  --json FILE          Write per-scenario durations and results as JSON\n"
+                      << "  --baseline FILE      Fail if any scenario regressed vs an earlier --json\n"
+                      << "  --max-regress PCT    Tolerance for --baseline, e.g. 10% (default: 10%)\n"
+                      << "  --faults SPEC        Inject latency/drops/429/503/bandwidth caps into every call,\n"
+                      << "                       e.g. latency=lognormal:20:0.5,drop=0.01,429=0.05,bw=512\n"
+                      << "  --offline            Don't contact the API; answer calls with synthetic results\n"
                       << "  --help, -h           Show this help\n\n"
                       << "Scenarios:\n"
                       << "  1   Multi-epoch training run with token metering\n"
@@ -975,11 +1729,31 @@ int main(int argc, char** argv) {
                       << "  7   Inference / prediction metering (20 requests)\n"
                       << "  8   Idempotency / retry safety (duplicate detection)\n"
                       << "  9   Hyperparameter sweep (6 configs, grid search)\n"
-                      << "  10  Batch inference job (1000 items scored)\n";
+                      << "  10  Batch inference job (1000 items scored)\n"
+                      << "  11  Batched inference metering (UsageBatcher vs per-call)\n"
+                      << "  12  Async event emission (non-blocking emitEvent)\n"
+                      << "  13  Streaming batch scoring (1M items, bounded memory)\n"
+                      << "  14  Outage resilience (spool during outage, replay after)\n"
+                      << "  15  Pre-aggregated GPU-second metering (exact rolled-up totals)\n";
             return 0;
         }
     }
 
+    if (!max_regress.empty()) {
+        perf_out.gate.max_regress = parse_regress_fraction(max_regress);
+        if (perf_out.gate.max_regress < 0) {
+            std::cerr << RED << "--max-regress needs a percentage, e.g. 10%." << RESET << std::endl;
+            return 1;
+        }
+    }
+    if (!perf_out.baseline_path.empty()) {
+        std::string error;
+        if (!perf_out.baseline.load(perf_out.baseline_path, error)) {
+            std::cerr << RED << "Cannot read --baseline: " << error << RESET << std::endl;
+            return 1;
+        }
+    }
+
     std::string customer_id = env_or("TEST_CUSTOMER_ID", "seed-customer-1");
 
     std::cout << std::endl;
@@ -1000,6 +1774,10 @@ int main(int argc, char** argv) {
         }
         config.base_url = api_url;
     }
+    if (faults.offline && env_or("DRIP_API_KEY", "").empty()) {
+        config.api_key = "sk_test_offline";  // Never sent; the client just needs one to construct
+    }
+    FaultInjector::instance().configure(faults.setup_only());  // The connectivity check isn't degraded
 
     try {
         drip::Client client(config);
@@ -1013,7 +1791,7 @@ int main(int argc, char** argv) {
         }
 
         // Verify connectivity first
-        auto health = client.ping();
+        auto health = metered(Endpoint::PING, [&] { return client.ping(); });
         if (!health.ok) {
             std::cerr << RED << "API not healthy, aborting tests." << RESET << std::endl;
             return 1;
@@ -1021,37 +1799,57 @@ int main(int argc, char** argv) {
         std::cout << DIM << "  API connected (" << health.latency_ms << "ms)"
                   << RESET << std::endl;
         std::cout << std::endl;
+        FaultInjector::instance().configure(faults);
+
+        if (soak_s > 0) {
+            int64_t interval = soak_interval_s > 0 ? soak_interval_s
+                                                   : std::max<int64_t>(1, std::min<int64_t>(60, soak_s / 20));
+            PerfReport perf;
+            perf.tool = "drip-ml-test";
+            perf.version = DRIP_SDK_VERSION;
+            int status = run_soak(client, customer_id, soak_s, interval, perf);
+            print_fault_summary();
+            return finish_perf_report(perf, perf_out, status);
+        }
 
         // Define all scenarios
-        typedef ScenarioResult (*ScenarioFn)(drip::Client&, const std::string&, bool);
-        struct Scenario {
-            int number;
-            ScenarioFn fn;
-        };
-
-        Scenario all_scenarios[] = {
-            {1, scenario_training_run},
-            {2, scenario_checkpoint_tracking},
-            {3, scenario_per_user_attribution},
-            {4, scenario_failed_training},
-            {5, scenario_model_comparison},
-            {6, scenario_incremental_run},
-            {7, scenario_inference_metering},
-            {8, scenario_idempotency},
-            {9, scenario_hyperparam_sweep},
-            {10, scenario_batch_inference}
+        const Scenario all_scenarios[] = {
+            {1, scenario_training_run, false, "glades-training"},
+            {2, scenario_checkpoint_tracking, false, "glades-checkpoint-training"},
+            {3, scenario_per_user_attribution, false, nullptr},
+            {4, scenario_failed_training, false, "glades-training"},
+            {5, scenario_model_comparison, false, "glades-arch-compare"},
+            {6, scenario_incremental_run, false, nullptr},
+            {7, scenario_inference_metering, false, "glades-inference"},
+            {8, scenario_idempotency, false, nullptr},
+            {9, scenario_hyperparam_sweep, false, "glades-hyperparam-sweep"},
+            {10, scenario_batch_inference, false, "glades-batch-inference"},
+            {11, scenario_batched_inference, true, nullptr},
+            {12, scenario_async_events, true, nullptr},
+            {13, scenario_streaming_batch_scoring, true, "glades-batch-inference"},
+            {14, scenario_outage_resilience, true, nullptr},
+            {15, scenario_aggregated_gpu_metering, true, nullptr}
         };
-        int num_scenarios = 10;
-
-        std::vector<ScenarioResult> results;
+        int num_scenarios = 15;
 
+        std::vector<Scenario> selected;
         for (int i = 0; i < num_scenarios; ++i) {
             if (specific_scenario > 0 && all_scenarios[i].number != specific_scenario) {
                 continue;
             }
-            results.push_back(all_scenarios[i].fn(client, customer_id, verbose));
+            selected.push_back(all_scenarios[i]);
         }
 
+        if (jobs > 1) {
+            std::cout << DIM << "  Running " << selected.size() << " scenarios on "
+                      << jobs << " workers" << RESET << std::endl;
+            std::cout << std::endl;
+        }
+
+        auto suite_start = now_ms();
+        std::vector<ScenarioResult> results = run_scenarios(selected, jobs, client, customer_id, verbose);
+        int64_t suite_ms = now_ms() - suite_start;
+
         // Print results
         for (size_t i = 0; i < results.size(); ++i) {
             print_scenario(results[i], verbose);
@@ -1079,8 +1877,27 @@ int main(int argc, char** argv) {
                       << " scenarios failed." << RESET << std::endl;
         }
 
+        int64_t scenario_ms = 0;
+        for (size_t i = 0; i < results.size(); ++i) scenario_ms += results[i].duration_ms;
+        std::cout << DIM << "  Wall time: " << suite_ms << "ms (scenarios sum: "
+                  << scenario_ms << "ms";
+        if (jobs > 1) std::cout << ", " << jobs << " jobs";
+        std::cout << ")" << RESET << std::endl;
+        print_fault_summary();
+
         std::cout << std::endl;
-        return failed > 0 ? 1 : 0;
+        PerfReport perf;
+        perf.tool = "drip-ml-test";
+        perf.version = DRIP_SDK_VERSION;
+        for (size_t i = 0; i < results.size(); ++i) {
+            perf.add(perf_entry("scenario", std::to_string(results[i].number) + ". " + results[i].name,
+                                results[i].duration_ms, results[i].success));
+        }
+        if (specific_scenario == 0) {
+            perf.add(perf_entry("suite", jobs > 1 ? "all (" + std::to_string(jobs) + " jobs)" : "all",
+                                static_cast<double>(suite_ms), failed == 0));
+        }
+        return finish_perf_report(perf, perf_out, failed > 0 ? 1 : 0);
 
     } catch (const drip::DripError& e) {
         std::cerr << RED << "FATAL: " << e.what() << RESET << std::endl;
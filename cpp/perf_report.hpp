@@ -0,0 +1,455 @@
+/**
+ * Drip C++ SDK - Machine-readable results and regression gate for testdrip
+ *
+ * PerfReport collects one PerfEntry per check, scenario or bench operation
+ * (latency percentiles in ms, throughput, errors by kind) and writes them as
+ * a single JSON document:
+ *
+ *   {"tool":"drip-health","version":"...","timestamp_ms":...,
+ *    "entries":[{"kind":"bench","name":"track","count":1200,"errors":0,
+ *                "throughput_rps":119.8,"p50_ms":4.1,...,"passed":true,
+ *                "errors_by_kind":{"http_429":2}}, ...]}
+ *
+ * A report written by an earlier run can be read back as a baseline, and
+ * compare_to_baseline() lists every entry whose p99 grew, or whose
+ * throughput (successful calls per second) fell, by more than the allowed
+ * fraction, or whose error rate grew by more than max_error_rate points.
+ * Entries are matched by kind and name; ones missing from either side are
+ * not compared. Single-shot entries (checks, scenarios) have count 1, so
+ * their "p99" is the one duration; min_delta_ms keeps sub-millisecond jitter
+ * on those from failing the gate. finish_perf_report() is the shared tail of
+ * a --json / --baseline run.
+ *
+ * The reader is a small recursive-descent JSON parser, enough for files this
+ * writer produced (and hand edits of them); it is not a general JSON library.
+ */
+
+#pragma once
+
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "json_writer.hpp"
+#include "latency_histogram.hpp"
+
+struct PerfEntry {
+    std::string kind;  // "check", "scenario", "bench", "suite"
+    std::string name;
+    uint64_t count = 0;
+    uint64_t errors = 0;
+    double throughput_rps = 0;  // 0 = not a throughput measurement
+    double p50_ms = 0;
+    double p90_ms = 0;
+    double p99_ms = 0;
+    double max_ms = 0;
+    double mean_ms = 0;
+    bool passed = true;
+    std::map<std::string, uint64_t> errors_by_kind;
+};
+
+/**
+ * Percentiles from a microsecond histogram of every call, failed ones included;
+ * `errors` of them failed. Throughput counts successful calls over `elapsed_s`
+ * if > 0.
+ */
+inline PerfEntry perf_entry(const std::string& kind, const std::string& name, const LatencyHistogram& h,
+                            uint64_t errors, double elapsed_s) {
+    PerfEntry e;
+    e.kind = kind;
+    e.name = name;
+    e.count = h.count();
+    e.errors = errors;
+    uint64_t succeeded = h.count() > errors ? h.count() - errors : 0;
+    e.throughput_rps = elapsed_s > 0 ? succeeded / elapsed_s : 0;
+    e.p50_ms = h.percentile(0.50) / 1000.0;
+    e.p90_ms = h.percentile(0.90) / 1000.0;
+    e.p99_ms = h.percentile(0.99) / 1000.0;
+    e.max_ms = h.max() / 1000.0;
+    e.mean_ms = h.mean() / 1000.0;
+    e.passed = errors == 0;
+    return e;
+}
+
+/** A single timed step (one check or scenario). */
+inline PerfEntry perf_entry(const std::string& kind, const std::string& name, double duration_ms, bool passed) {
+    PerfEntry e;
+    e.kind = kind;
+    e.name = name;
+    e.count = 1;
+    e.errors = passed ? 0 : 1;
+    e.p50_ms = e.p90_ms = e.p99_ms = e.max_ms = e.mean_ms = duration_ms;
+    e.passed = passed;
+    return e;
+}
+
+namespace perf_detail {
+
+struct JsonValue {
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+    Type type = NUL;
+    bool boolean = false;
+    double number = 0;
+    std::string text;
+    std::vector<JsonValue> items;      // ARRAY elements, or OBJECT values
+    std::vector<std::string> keys;     // OBJECT keys, parallel to items
+
+    const JsonValue* get(const std::string& key) const {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == key) return &items[i];
+        }
+        return nullptr;
+    }
+    double num(const char* key, double fallback = 0) const {
+        const JsonValue* v = get(key);
+        return v && v->type == NUMBER ? v->number : fallback;
+    }
+    std::string str(const char* key) const {
+        const JsonValue* v = get(key);
+        return v && v->type == STRING ? v->text : std::string();
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : s_(text), pos_(0) {}
+
+    bool parse(JsonValue& out, std::string& error) {
+        if (!value(out, 0) || (skip_ws(), pos_ != s_.size())) {
+            error = "invalid JSON near offset " + std::to_string(pos_);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static const int MAX_DEPTH = 32;
+
+    void skip_ws() {
+        while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_]))) ++pos_;
+    }
+
+    bool literal(const char* word) {
+        size_t n = std::char_traits<char>::length(word);
+        if (s_.compare(pos_, n, word) != 0) return false;
+        pos_ += n;
+        return true;
+    }
+
+    bool value(JsonValue& out, int depth) {
+        if (depth > MAX_DEPTH) return false;
+        skip_ws();
+        if (pos_ >= s_.size()) return false;
+        char c = s_[pos_];
+        if (c == '{') return object(out, depth);
+        if (c == '[') return array(out, depth);
+        if (c == '"') {
+            out.type = JsonValue::STRING;
+            return string(out.text);
+        }
+        if (literal("true")) { out.type = JsonValue::BOOL; out.boolean = true; return true; }
+        if (literal("false")) { out.type = JsonValue::BOOL; return true; }
+        if (literal("null")) return true;
+        const char* start = s_.c_str() + pos_;
+        char* end = nullptr;
+        out.number = std::strtod(start, &end);
+        if (end == start) return false;
+        out.type = JsonValue::NUMBER;
+        pos_ += static_cast<size_t>(end - start);
+        return true;
+    }
+
+    bool object(JsonValue& out, int depth) {
+        out.type = JsonValue::OBJECT;
+        ++pos_;
+        skip_ws();
+        if (pos_ < s_.size() && s_[pos_] == '}') { ++pos_; return true; }
+        for (;;) {
+            skip_ws();
+            std::string key;
+            if (pos_ >= s_.size() || s_[pos_] != '"' || !string(key)) return false;
+            skip_ws();
+            if (pos_ >= s_.size() || s_[pos_++] != ':') return false;
+            out.keys.push_back(key);
+            out.items.push_back(JsonValue());
+            if (!value(out.items.back(), depth + 1)) return false;
+            skip_ws();
+            if (pos_ >= s_.size()) return false;
+            char c = s_[pos_++];
+            if (c == '}') return true;
+            if (c != ',') return false;
+        }
+    }
+
+    bool array(JsonValue& out, int depth) {
+        out.type = JsonValue::ARRAY;
+        ++pos_;
+        skip_ws();
+        if (pos_ < s_.size() && s_[pos_] == ']') { ++pos_; return true; }
+        for (;;) {
+            out.items.push_back(JsonValue());
+            if (!value(out.items.back(), depth + 1)) return false;
+            skip_ws();
+            if (pos_ >= s_.size()) return false;
+            char c = s_[pos_++];
+            if (c == ']') return true;
+            if (c != ',') return false;
+        }
+    }
+
+    // Escapes are decoded except \u, which is kept as a '?' (names are ASCII).
+    bool string(std::string& out) {
+        ++pos_;
+        while (pos_ < s_.size()) {
+            char c = s_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= s_.size()) return false;
+            char e = s_[pos_++];
+            switch (e) {
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                    if (pos_ + 4 > s_.size()) return false;
+                    pos_ += 4;
+                    out += '?';
+                    break;
+                default: out += e;
+            }
+        }
+        return false;
+    }
+
+    const std::string& s_;
+    size_t pos_;
+};
+
+}  // namespace perf_detail
+
+class PerfReport {
+public:
+    std::string tool;
+    std::string version;
+    int64_t timestamp_ms = 0;
+    std::vector<PerfEntry> entries;
+
+    void add(const PerfEntry& e) { entries.push_back(e); }
+
+    const PerfEntry* find(const std::string& kind, const std::string& name) const {
+        for (const PerfEntry& e : entries) {
+            if (e.kind == kind && e.name == name) return &e;
+        }
+        return nullptr;
+    }
+
+    void write_json(std::ostream& out) const {
+        JsonWriter w(4096);
+        w.begin_object();
+        w.key("tool"); w.value(tool);
+        w.key("version"); w.value(version);
+        w.key("timestamp_ms"); w.value(static_cast<double>(timestamp_ms));
+        w.key("entries");
+        w.raw("[", 1);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const PerfEntry& e = entries[i];
+            if (i) w.raw(",", 1);
+            w.begin_object();
+            w.key("kind"); w.value(e.kind);
+            w.key("name"); w.value(e.name);
+            w.key("count"); w.value(static_cast<double>(e.count));
+            w.key("errors"); w.value(static_cast<double>(e.errors));
+            w.key("throughput_rps"); w.value(round3(e.throughput_rps));
+            w.key("p50_ms"); w.value(round3(e.p50_ms));
+            w.key("p90_ms"); w.value(round3(e.p90_ms));
+            w.key("p99_ms"); w.value(round3(e.p99_ms));
+            w.key("max_ms"); w.value(round3(e.max_ms));
+            w.key("mean_ms"); w.value(round3(e.mean_ms));
+            w.key("passed");
+            w.raw(e.passed ? "true" : "false", e.passed ? 4 : 5);
+            w.key("errors_by_kind");
+            w.begin_object();
+            for (const auto& kv : e.errors_by_kind) {
+                w.key(kv.first.c_str());  // Kinds are identifiers (http_429, network, ...)
+                w.value(static_cast<double>(kv.second));
+            }
+            w.end_object();
+            w.end_object();
+        }
+        w.raw("]", 1);
+        w.end_object();
+        out << w.str() << "\n";
+    }
+
+    bool read_json(const std::string& text, std::string& error) {
+        perf_detail::JsonValue doc;
+        if (!perf_detail::JsonParser(text).parse(doc, error)) return false;
+        const perf_detail::JsonValue* list = doc.get("entries");
+        if (doc.type != perf_detail::JsonValue::OBJECT || !list || list->type != perf_detail::JsonValue::ARRAY) {
+            error = "no \"entries\" array";
+            return false;
+        }
+        tool = doc.str("tool");
+        version = doc.str("version");
+        timestamp_ms = static_cast<int64_t>(doc.num("timestamp_ms"));
+        entries.clear();
+        for (const perf_detail::JsonValue& v : list->items) {
+            PerfEntry e;
+            e.kind = v.str("kind");
+            e.name = v.str("name");
+            e.count = static_cast<uint64_t>(v.num("count"));
+            e.errors = static_cast<uint64_t>(v.num("errors"));
+            e.throughput_rps = v.num("throughput_rps");
+            e.p50_ms = v.num("p50_ms");
+            e.p90_ms = v.num("p90_ms");
+            e.p99_ms = v.num("p99_ms");
+            e.max_ms = v.num("max_ms");
+            e.mean_ms = v.num("mean_ms");
+            const perf_detail::JsonValue* passed = v.get("passed");
+            e.passed = !passed || passed->type != perf_detail::JsonValue::BOOL || passed->boolean;
+            if (const perf_detail::JsonValue* kinds = v.get("errors_by_kind")) {
+                for (size_t i = 0; i < kinds->keys.size(); ++i) {
+                    e.errors_by_kind[kinds->keys[i]] = static_cast<uint64_t>(kinds->items[i].number);
+                }
+            }
+            if (!e.kind.empty() && !e.name.empty()) entries.push_back(e);
+        }
+        return true;
+    }
+
+    bool load(const std::string& path, std::string& error) {
+        std::ifstream in(path.c_str());
+        if (!in) {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::ostringstream text;
+        text << in.rdbuf();
+        return read_json(text.str(), error);
+    }
+
+    bool save(const std::string& path) const {
+        std::ofstream out(path.c_str());
+        if (!out) return false;
+        write_json(out);
+        return static_cast<bool>(out);
+    }
+
+private:
+    static double round3(double v) { return std::round(v * 1000.0) / 1000.0; }
+};
+
+struct PerfGateOptions {
+    double max_regress = 0.10;     // Allowed fractional p99 growth / throughput drop
+    double min_delta_ms = 1.0;     // p99 growth below this never counts
+    double max_error_rate = 0.01;  // Allowed growth in errors/count, in absolute terms
+};
+
+struct PerfRegression {
+    std::string kind;
+    std::string name;
+    std::string metric;  // "p99_ms", "throughput_rps" or "error_pct"
+    double baseline;
+    double current;
+
+    double change() const { return baseline != 0 ? (current - baseline) / baseline : 0; }
+};
+
+/** Parse "10%", "10" (both 10%) or "0.1" into a fraction; negative on bad input. */
+inline double parse_regress_fraction(const std::string& text) {
+    char* end = nullptr;
+    double v = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || v < 0) return -1;
+    if (*end == '%' || v >= 1) return v / 100.0;
+    return v;
+}
+
+inline std::vector<PerfRegression> compare_to_baseline(const PerfReport& current, const PerfReport& baseline,
+                                                       const PerfGateOptions& opts = PerfGateOptions()) {
+    std::vector<PerfRegression> out;
+    for (const PerfEntry& now : current.entries) {
+        const PerfEntry* base = baseline.find(now.kind, now.name);
+        if (!base || !base->count) continue;
+        if (now.p99_ms > base->p99_ms * (1 + opts.max_regress) && now.p99_ms - base->p99_ms >= opts.min_delta_ms) {
+            out.push_back(PerfRegression{now.kind, now.name, "p99_ms", base->p99_ms, now.p99_ms});
+        }
+        // A throughput that fell to zero (every call failed) is the worst drop, not a skip
+        if (base->throughput_rps > 0 && now.throughput_rps < base->throughput_rps * (1 - opts.max_regress)) {
+            out.push_back(PerfRegression{now.kind, now.name, "throughput_rps", base->throughput_rps,
+                                         now.throughput_rps});
+        }
+        double base_rate = static_cast<double>(base->errors) / base->count;
+        double now_rate = now.count ? static_cast<double>(now.errors) / now.count : 0;
+        if (now_rate > base_rate + opts.max_error_rate) {
+            out.push_back(PerfRegression{now.kind, now.name, "error_pct", base_rate * 100, now_rate * 100});
+        }
+    }
+    return out;
+}
+
+/** Where a run's results go: --json, and the --baseline gate. */
+struct PerfOutput {
+    std::string json_path;  // Empty = no JSON
+    std::string baseline_path;
+    PerfReport baseline;    // Loaded up front so a bad path fails before the run
+    PerfGateOptions gate;
+};
+
+/**
+ * Stamp `perf` (the caller sets tool and version), write --json and apply the
+ * --baseline gate. Returns `status`, or 1 if the gate failed.
+ */
+inline int finish_perf_report(PerfReport& perf, const PerfOutput& out, int status) {
+    static const char* const GREEN = "\033[32m";
+    static const char* const RED = "\033[31m";
+    static const char* const RESET = "\033[0m";
+    perf.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (!out.json_path.empty() && !perf.save(out.json_path)) {
+        std::cerr << RED << "Could not write results to " << out.json_path << RESET << std::endl;
+        status = 1;
+    }
+    if (out.baseline_path.empty()) return status;
+
+    size_t compared = 0;
+    for (const PerfEntry& e : perf.entries) {
+        if (out.baseline.find(e.kind, e.name)) ++compared;
+    }
+    std::vector<PerfRegression> regressions = compare_to_baseline(perf, out.baseline, out.gate);
+    std::cout << "Regression gate vs " << out.baseline_path << " (max " << std::fixed << std::setprecision(0)
+              << out.gate.max_regress * 100 << "%, " << compared << " entries compared):" << std::endl;
+    for (const PerfRegression& r : regressions) {
+        std::cout << "  " << RED << "[FAIL]" << RESET << " " << r.kind << "/" << r.name << " " << r.metric
+                  << " " << std::setprecision(2) << r.baseline << " -> " << r.current;
+        if (r.baseline != 0) {
+            std::cout << " (" << std::showpos << std::setprecision(1) << r.change() * 100 << std::noshowpos << "%)";
+        }
+        std::cout << std::endl;
+    }
+    if (compared == 0) {
+        std::cout << "  " << RED << "No entries in common with the baseline." << RESET << std::endl << std::endl;
+        return 1;
+    }
+    if (regressions.empty()) {
+        std::cout << "  " << GREEN << "[PASS]" << RESET << " p99, throughput and error rate within tolerance"
+                  << std::endl;
+    }
+    std::cout << std::endl;
+    return regressions.empty() ? status : 1;
+}
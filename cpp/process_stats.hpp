@@ -0,0 +1,111 @@
+/**
+ * Drip C++ SDK - Process resource readings for the testdrip harness
+ *
+ * peak_rss_bytes() reports the process's resident-set high-water mark, which
+ * is what a memory-bound scenario needs to show it stayed bounded. The value
+ * never goes down, so compare readings taken before and after a scenario.
+ *
+ * sample_process() reads the current values a soak test tracks for leaks:
+ * resident set, open descriptors, sockets and threads. Sockets stand in for
+ * libcurl connections, since the SDK's curl handles aren't visible from
+ * outside it. Readings a platform can't provide are -1.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <dirent.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+/** Peak resident set size in bytes, or 0 where the platform cannot say. */
+inline uint64_t peak_rss_bytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+    return static_cast<uint64_t>(pmc.PeakWorkingSetSize);
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(ru.ru_maxrss);         // bytes
+#else
+    return static_cast<uint64_t>(ru.ru_maxrss) * 1024;  // kilobytes
+#endif
+#endif
+}
+
+struct ProcessSample {
+    int64_t rss_bytes = -1;
+    int64_t open_fds = -1;
+    int64_t sockets = -1;
+    int64_t threads = -1;
+};
+
+inline ProcessSample sample_process() {
+    ProcessSample s;
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        s.rss_bytes = static_cast<int64_t>(pmc.WorkingSetSize);
+    }
+    DWORD handles = 0;
+    if (GetProcessHandleCount(GetCurrentProcess(), &handles)) s.open_fds = handles;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        s.rss_bytes = static_cast<int64_t>(info.resident_size);
+    }
+    if (DIR* dir = opendir("/dev/fd")) {
+        s.open_fds = -1;  // The DIR's own descriptor is listed too
+        while (struct dirent* e = readdir(dir)) {
+            if (e->d_name[0] != '.') ++s.open_fds;
+        }
+        closedir(dir);
+    }
+#else
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        long size = 0, resident = 0;
+        if (std::fscanf(f, "%ld %ld", &size, &resident) == 2) {
+            s.rss_bytes = static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE);
+        }
+        std::fclose(f);
+    }
+    if (DIR* dir = opendir("/proc/self/fd")) {
+        s.open_fds = -1;   // The DIR's own descriptor is listed too
+        s.sockets = 0;
+        while (struct dirent* e = readdir(dir)) {
+            if (e->d_name[0] == '.') continue;
+            ++s.open_fds;
+            char target[64];
+            ssize_t n = readlinkat(dirfd(dir), e->d_name, target, sizeof(target) - 1);
+            if (n > 0 && std::strncmp(target, "socket:", 7) == 0) ++s.sockets;
+        }
+        closedir(dir);
+    }
+    if (FILE* f = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        while (std::fgets(line, sizeof(line), f)) {
+            long n = 0;
+            if (std::sscanf(line, "Threads: %ld", &n) == 1) {
+                s.threads = n;
+                break;
+            }
+        }
+        std::fclose(f);
+    }
+#endif
+    return s;
+}
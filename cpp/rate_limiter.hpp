@@ -0,0 +1,266 @@
+/**
+ * Drip C++ SDK - Client-side rate limiter and concurrency governor
+ *
+ * When every producer sends as fast as it can, a burst gets the whole fleet
+ * throttled at once, everyone backs off together, and throughput oscillates
+ * between overload and idle. ClientGovernor sits in front of a shared
+ * drip::Client and smooths that out in two stages:
+ *
+ *   TokenBucket         caps the request rate (with a burst allowance).
+ *                       Callers reserve a token and sleep until it is due,
+ *                       so waiters are served in arrival order.
+ *   ConcurrencyLimiter  caps requests in flight with an AIMD limit. The
+ *                       limit grows by about one per limit's worth of
+ *                       successes while it is in use, and is cut by
+ *                       backoff_ratio on a 429/503 or when recent latency
+ *                       exceeds latency_tolerance times its long-run
+ *                       average. Cuts are at most one per current latency,
+ *                       so a single overload burst counts once.
+ *
+ * Both are shared by every thread calling through the governor. limit(),
+ * in_flight() and queue_depth() are cheap enough to poll for monitoring.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+class TokenBucket {
+public:
+    /** rate_per_s <= 0 disables the bucket. */
+    TokenBucket(double rate_per_s, double burst)
+        : rate_(rate_per_s), burst_(std::max(1.0, burst)), tokens_(std::max(1.0, burst)),
+          last_(std::chrono::steady_clock::now()) {}
+
+    /** Take one token, sleeping until it is available. */
+    void acquire() {
+        if (rate_ <= 0) return;
+        std::chrono::microseconds wait(0);
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            refill();
+            tokens_ -= 1.0;  // May go negative: a reservation against future refill
+            if (tokens_ < 0) wait = std::chrono::microseconds(static_cast<int64_t>(-tokens_ / rate_ * 1e6));
+        }
+        if (wait.count() > 0) std::this_thread::sleep_for(wait);
+    }
+
+    bool try_acquire() {
+        if (rate_ <= 0) return true;
+        std::lock_guard<std::mutex> lock(mtx_);
+        refill();
+        if (tokens_ < 1.0) return false;
+        tokens_ -= 1.0;
+        return true;
+    }
+
+    double rate() const { return rate_; }
+
+private:
+    void refill() {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed_s = std::chrono::duration<double>(now - last_).count();
+        last_ = now;
+        tokens_ = std::min(burst_, tokens_ + elapsed_s * rate_);
+    }
+
+    std::mutex mtx_;
+    double rate_;
+    double burst_;
+    double tokens_;
+    std::chrono::steady_clock::time_point last_;
+};
+
+struct ConcurrencyLimitOptions {
+    double initial_limit = 8;
+    double min_limit = 1;
+    double max_limit = 256;
+    double backoff_ratio = 0.7;       // Multiplicative decrease on overload
+    double latency_tolerance = 1.5;   // Overload when recent latency > long-run * this
+};
+
+struct GovernorStats {
+    int limit;
+    int in_flight;
+    int queue_depth;       // Callers waiting for a concurrency slot
+    int peak_queue_depth;
+    int min_limit_seen;
+    int max_limit_seen;
+    uint64_t calls;
+    uint64_t throttled;    // 429 and 503 responses
+    uint64_t decreases;    // Limit cuts (429s and latency)
+    int64_t baseline_us;   // Long-run average latency
+};
+
+class ConcurrencyLimiter {
+public:
+    /** Holds one slot for the life of a call; releases it with the call's outcome. */
+    class Permit {
+    public:
+        explicit Permit(ConcurrencyLimiter& limiter)
+            : limiter_(limiter), outcome_(OUTCOME_OK) {
+            limiter_.acquire();
+            start_ = std::chrono::steady_clock::now();
+        }
+        ~Permit() {
+            int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_).count();
+            limiter_.release(us, outcome_);
+        }
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+
+        void throttled() { outcome_ = OUTCOME_THROTTLED; }
+        /** Failure that says nothing about load (bad request, auth, ...). */
+        void ignore() { outcome_ = OUTCOME_IGNORED; }
+
+    private:
+        ConcurrencyLimiter& limiter_;
+        int outcome_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    explicit ConcurrencyLimiter(const ConcurrencyLimitOptions& opts = ConcurrencyLimitOptions())
+        : opts_(opts), limit_(clamp(opts.initial_limit)), in_flight_(0), queued_(0),
+          peak_queued_(0), min_seen_(static_cast<int>(limit_)), max_seen_(static_cast<int>(limit_)),
+          calls_(0), throttled_(0), decreases_(0), baseline_us_(0), last_decrease_(),
+          smoothed_us_(0), samples_(0) {}
+
+    int limit() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return static_cast<int>(limit_);
+    }
+
+    int in_flight() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return in_flight_;
+    }
+
+    int queue_depth() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return queued_;
+    }
+
+    GovernorStats stats() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return {static_cast<int>(limit_), in_flight_, queued_, peak_queued_, min_seen_, max_seen_,
+                calls_, throttled_, decreases_, static_cast<int64_t>(baseline_us_)};
+    }
+
+private:
+    enum { OUTCOME_OK, OUTCOME_THROTTLED, OUTCOME_IGNORED };
+    static const uint64_t WARMUP_SAMPLES = 50;
+
+    double clamp(double v) const { return std::max(opts_.min_limit, std::min(opts_.max_limit, v)); }
+
+    void acquire() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        ++queued_;
+        peak_queued_ = std::max(peak_queued_, queued_);
+        cv_.wait(lock, [this] { return in_flight_ < static_cast<int>(limit_); });
+        --queued_;
+        ++in_flight_;
+    }
+
+    void release(int64_t us, int outcome) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            bool saturated = in_flight_ * 2 >= static_cast<int>(limit_);
+            --in_flight_;
+            ++calls_;
+            if (outcome == OUTCOME_THROTTLED) {
+                ++throttled_;
+                decrease();
+            } else if (outcome == OUTCOME_OK) {
+                double v = static_cast<double>(us);
+                // Short-term vs long-term latency average (gradient style):
+                // queueing at the server shows up as the short one pulling away.
+                // Both start as a plain running mean so early samples don't skew them.
+                ++samples_;
+                double n = static_cast<double>(samples_);
+                smoothed_us_ += (v - smoothed_us_) * std::max(0.1, 1.0 / n);
+                baseline_us_ += (v - baseline_us_) * std::max(0.005, 1.0 / n);
+                if (samples_ >= WARMUP_SAMPLES && smoothed_us_ > baseline_us_ * opts_.latency_tolerance) decrease();
+                else if (saturated) limit_ = clamp(limit_ + 1.0 / limit_);
+            }
+            track_limit();
+        }
+        cv_.notify_all();
+    }
+
+    void decrease() {
+        auto now = std::chrono::steady_clock::now();
+        auto cooldown = std::chrono::microseconds(static_cast<int64_t>(smoothed_us_));
+        if (decreases_ > 0 && now - last_decrease_ < cooldown) return;
+        limit_ = clamp(limit_ * opts_.backoff_ratio);
+        last_decrease_ = now;
+        ++decreases_;
+    }
+
+    void track_limit() {
+        int l = static_cast<int>(limit_);
+        min_seen_ = std::min(min_seen_, l);
+        max_seen_ = std::max(max_seen_, l);
+    }
+
+    ConcurrencyLimitOptions opts_;
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    double limit_;
+    int in_flight_;
+    int queued_;
+    int peak_queued_;
+    int min_seen_;
+    int max_seen_;
+    uint64_t calls_;
+    uint64_t throttled_;
+    uint64_t decreases_;
+    double baseline_us_;
+    std::chrono::steady_clock::time_point last_decrease_;
+    double smoothed_us_;
+    uint64_t samples_;
+};
+
+class ClientGovernor {
+public:
+    ClientGovernor(double rate_per_s, double burst,
+                   const ConcurrencyLimitOptions& opts = ConcurrencyLimitOptions())
+        : bucket_(rate_per_s, burst), limiter_(opts) {}
+
+    ClientGovernor(const ClientGovernor&) = delete;
+    ClientGovernor& operator=(const ClientGovernor&) = delete;
+
+    /** Wait for a token and a concurrency slot, then run fn(). */
+    template <typename F>
+    auto call(F fn) -> decltype(fn()) {
+        bucket_.acquire();
+        ConcurrencyLimiter::Permit permit(limiter_);
+        try {
+            return fn();
+        } catch (const drip::DripError& e) {
+            if (e.status_code() == 429 || e.status_code() == 503) permit.throttled();
+            else permit.ignore();
+            throw;
+        } catch (...) {
+            permit.ignore();
+            throw;
+        }
+    }
+
+    int limit() const { return limiter_.limit(); }
+    int in_flight() const { return limiter_.in_flight(); }
+    int queue_depth() const { return limiter_.queue_depth(); }
+    GovernorStats stats() const { return limiter_.stats(); }
+    double rate() const { return bucket_.rate(); }
+
+private:
+    TokenBucket bucket_;
+    ConcurrencyLimiter limiter_;
+};
@@ -0,0 +1,208 @@
+/**
+ * Drip C++ SDK - Sampled per-stage request profiling for the testdrip harness
+ *
+ * Splits the time of a sampled SDK call into stages, per endpoint, without
+ * running a profiler:
+ *
+ *   harness encode  the harness re-encoding a trackUsage/emitEvent body with
+ *                   JsonWriter to count its bytes; harness overhead that
+ *                   --metrics adds, not the SDK's own serialization
+ *   sdk             the drip::Client call itself: request serialization,
+ *                   transport and response parsing
+ *   error           constructing, throwing and catching the DripError a
+ *                   failed call raised (re-measured on a copy of that error)
+ *
+ * drip::Client's transport and parser are private, so "sdk" can't be split
+ * further from outside. drip-health --profile therefore compares it against
+ * a raw libcurl request to the same endpoint (HttpProbe) to show how much of
+ * it is the SDK rather than the network.
+ *
+ * The hooks are compiled in only with -DDRIP_PROFILE=1 (make PROFILE=1, or
+ * cmake -DDRIP_PROFILE=ON). Without that, DRIP_PROFILE_SCOPE expands to a
+ * no-op and metered() is unchanged. Even when compiled in, nothing is
+ * timed until enable(every): then every Nth call on each thread is sampled,
+ * by a thread-local counter. Unsampled calls cost one increment and a
+ * branch. Timestamps come from the TSC where available (rdtsc), calibrated
+ * against steady_clock over the profiling window, and steady_clock
+ * elsewhere. Samples go into per-stage LatencyHistograms, in ticks until the
+ * report scales them, so memory stays fixed however long the run; they sit
+ * behind one mutex that only sampled calls take.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DRIP_PROFILE_HAVE_TSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define DRIP_PROFILE_HAVE_TSC 1
+#endif
+
+#include "latency_histogram.hpp"
+
+#ifndef DRIP_PROFILE
+#define DRIP_PROFILE 0
+#endif
+
+// Not ERROR: <windows.h> defines that as a macro
+enum class ProfileStage : uint8_t { HARNESS_ENCODE, SDK, FAILURE, COUNT };
+
+inline const char* profile_stage_name(ProfileStage s) {
+    static const char* const names[] = {"harness encode", "sdk", "error"};
+    return names[static_cast<size_t>(s)];
+}
+
+class RequestProfiler {
+public:
+    static const size_t STAGES = static_cast<size_t>(ProfileStage::COUNT);
+    static const size_t MAX_ENDPOINTS = 32;
+
+    static RequestProfiler& instance() {
+        static RequestProfiler p;
+        return p;
+    }
+
+    /** Whether this build has the hooks (DRIP_PROFILE=1). */
+    static constexpr bool compiled_in() { return DRIP_PROFILE != 0; }
+
+    static uint64_t ticks() {
+#if defined(DRIP_PROFILE_HAVE_TSC)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /** Start sampling one call in `every` on each thread. */
+    void enable(int every) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        every_.store(every < 1 ? 1 : every, std::memory_order_relaxed);
+        tick0_ = ticks();
+        clock0_ = std::chrono::steady_clock::now();
+        enabled_.store(true, std::memory_order_release);
+    }
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    int every() const { return every_.load(std::memory_order_relaxed); }
+
+    /** Counts this call and says whether to time it. */
+    bool sample() {
+        if (!enabled()) return false;
+        static thread_local uint32_t calls = 0;
+        return ++calls % static_cast<uint32_t>(every()) == 0;
+    }
+
+    void record(size_t endpoint, ProfileStage stage, uint64_t elapsed_ticks) {
+        if (endpoint >= MAX_ENDPOINTS) return;
+        std::lock_guard<std::mutex> lock(mtx_);
+        std::unique_ptr<LatencyHistogram>& h = endpoints_[endpoint].stages[static_cast<size_t>(stage)];
+        if (!h) h.reset(new LatencyHistogram());
+        h->record(static_cast<int64_t>(elapsed_ticks));
+    }
+
+    /** Nanoseconds per tick, from the TSC's progress against steady_clock since enable(). */
+    double ns_per_tick() const {
+#if defined(DRIP_PROFILE_HAVE_TSC)
+        uint64_t dt = ticks() - tick0_;
+        int64_t dns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - clock0_).count();
+        return dt > 0 && dns > 0 ? static_cast<double>(dns) / dt : 1.0;
+#else
+        return 1.0;
+#endif
+    }
+
+    /** Per-stage histograms for one endpoint, in ticks: scale by ns_per_tick(). */
+    std::vector<LatencyHistogram> stages(size_t endpoint) const {
+        std::vector<LatencyHistogram> out(STAGES);
+        if (endpoint >= MAX_ENDPOINTS) return out;
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (size_t s = 0; s < STAGES; ++s) {
+            if (endpoints_[endpoint].stages[s]) out[s].merge(*endpoints_[endpoint].stages[s]);
+        }
+        return out;
+    }
+
+    /**
+     * Table of every endpoint with samples: per stage, sample count, p50 and
+     * p99, and the stage's share of the endpoint's summed sampled time.
+     * `names[i]` labels endpoint i.
+     */
+    void write_report(std::ostream& os, const char* const* names, size_t count) const {
+        os << "  " << std::left << std::setw(16) << "endpoint" << std::setw(15) << "stage" << std::right
+           << std::setw(9) << "samples" << std::setw(11) << "p50 us" << std::setw(11) << "p99 us"
+           << std::setw(8) << "share" << "\n";
+        double us_per_tick = ns_per_tick() / 1000.0;
+        for (size_t i = 0; i < count && i < MAX_ENDPOINTS; ++i) {
+            std::vector<LatencyHistogram> h = stages(i);
+            double total = 0;
+            for (size_t s = 0; s < STAGES; ++s) total += h[s].mean() * h[s].count();
+            if (total <= 0 && h[static_cast<size_t>(ProfileStage::SDK)].count() == 0) continue;
+            bool first = true;
+            for (size_t s = 0; s < STAGES; ++s) {
+                if (h[s].count() == 0) continue;
+                os << "  " << std::left << std::setw(16) << (first ? names[i] : "")
+                   << std::setw(15) << profile_stage_name(static_cast<ProfileStage>(s)) << std::right
+                   << std::setw(9) << h[s].count() << std::fixed << std::setprecision(1)
+                   << std::setw(11) << h[s].percentile(0.50) * us_per_tick
+                   << std::setw(11) << h[s].percentile(0.99) * us_per_tick
+                   << std::setw(7) << (total > 0 ? 100.0 * h[s].mean() * h[s].count() / total : 0.0) << "%\n";
+                first = false;
+            }
+        }
+    }
+
+private:
+    struct Endpoint {
+        std::unique_ptr<LatencyHistogram> stages[STAGES];  // In ticks; allocated on the first sample
+    };
+
+    RequestProfiler() : enabled_(false), every_(1), tick0_(0) {}
+
+    std::atomic<bool> enabled_;
+    std::atomic<int> every_;
+    uint64_t tick0_;
+    std::chrono::steady_clock::time_point clock0_;
+    mutable std::mutex mtx_;
+    Endpoint endpoints_[MAX_ENDPOINTS];
+};
+
+/** Records the time from construction to destruction under (endpoint, stage) if `active`. */
+class ProfileScope {
+public:
+    ProfileScope(size_t endpoint, ProfileStage stage, bool active)
+        : endpoint_(endpoint), stage_(stage), active_(active), t0_(active ? RequestProfiler::ticks() : 0) {}
+
+    ~ProfileScope() {
+        if (active_) RequestProfiler::instance().record(endpoint_, stage_, RequestProfiler::ticks() - t0_);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    size_t endpoint_;
+    ProfileStage stage_;
+    bool active_;
+    uint64_t t0_;
+};
+
+#if DRIP_PROFILE
+#define DRIP_PROFILE_SCOPE(var, endpoint, stage, active) \
+    ProfileScope var(static_cast<size_t>(endpoint), stage, active)
+#else
+#define DRIP_PROFILE_SCOPE(var, endpoint, stage, active) ((void)0)
+#endif
@@ -0,0 +1,146 @@
+/**
+ * Drip C++ SDK - Retry policy for the testdrip harness
+ *
+ * drip::Client makes one attempt per call, so a 429, a 5xx or a dropped
+ * connection surfaces straight to the caller. Retrier wraps a call with
+ * capped exponential backoff and full jitter (sleep a uniform random time in
+ * [0, min(max_delay, base_delay * 2^n))), so clients that failed together
+ * don't retry together. Every call deposits budget_ratio tokens into a
+ * shared RetryBudget and every retry spends one; when the budget is empty
+ * failures are rethrown instead of retried, which keeps a struggling API
+ * from being hit with max_attempts times its normal load.
+ *
+ * Only errors that mean "try again" are retried: network failures (status
+ * 0), 429 and 5xx. Callers decide which calls are safe to repeat; writes
+ * should only be retried when they carry an idempotency key.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+
+struct RetryPolicy {
+    int max_attempts = 4;            // Including the first
+    int base_delay_ms = 50;
+    int max_delay_ms = 2000;
+    double budget_ratio = 0.1;       // Retry tokens earned per call
+    double budget_max_tokens = 20;   // Also the starting balance
+};
+
+struct RetryStats {
+    uint64_t calls;
+    uint64_t retries;
+    uint64_t budget_exhausted;  // Retryable failures rethrown for lack of budget
+    uint64_t gave_up;           // Retryable failures rethrown after max_attempts
+};
+
+/** Network errors, rate limiting and server errors; everything else is final. */
+inline bool is_retryable_error(const drip::DripError& e) {
+    int status = e.status_code();
+    return status == 0 || status == 429 || status >= 500;
+}
+
+class RetryBudget {
+public:
+    RetryBudget(double ratio, double max_tokens)
+        : ratio_(ratio), max_(max_tokens), tokens_(max_tokens) {}
+
+    void deposit() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        tokens_ = std::min(max_, tokens_ + ratio_);
+    }
+
+    bool withdraw() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (tokens_ < 1.0) return false;
+        tokens_ -= 1.0;
+        return true;
+    }
+
+    double tokens() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return tokens_;
+    }
+
+private:
+    mutable std::mutex mtx_;
+    double ratio_;
+    double max_;
+    double tokens_;
+};
+
+class Retrier {
+public:
+    explicit Retrier(const RetryPolicy& policy = RetryPolicy())
+        : policy_(policy), budget_(policy.budget_ratio, policy.budget_max_tokens), stats_{0, 0, 0, 0} {}
+
+    Retrier(const Retrier&) = delete;
+    Retrier& operator=(const Retrier&) = delete;
+
+    /** Call fn() until it succeeds, fails for good, or the policy says stop. */
+    template <typename F>
+    auto call(F fn) -> decltype(fn()) {
+        budget_.deposit();
+        bump(&RetryStats::calls);
+        for (int attempt = 1;; ++attempt) {
+            try {
+                return fn();
+            } catch (const drip::DripError& e) {
+                if (!is_retryable_error(e)) throw;
+                if (attempt >= policy_.max_attempts) {
+                    bump(&RetryStats::gave_up);
+                    throw;
+                }
+                if (!budget_.withdraw()) {
+                    bump(&RetryStats::budget_exhausted);
+                    throw;
+                }
+                bump(&RetryStats::retries);
+            }
+            std::this_thread::sleep_for(backoff(attempt));
+        }
+    }
+
+    /** Full-jitter delay before retry number `attempt` (1-based). */
+    std::chrono::milliseconds backoff(int attempt) const {
+        int64_t cap = policy_.base_delay_ms;
+        for (int i = 1; i < attempt && cap < policy_.max_delay_ms; ++i) cap *= 2;
+        cap = std::min<int64_t>(cap, policy_.max_delay_ms);
+        if (cap <= 0) return std::chrono::milliseconds(0);
+        std::uniform_int_distribution<int64_t> dist(0, cap);
+        return std::chrono::milliseconds(dist(rng()));
+    }
+
+    RetryStats stats() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return stats_;
+    }
+
+    const RetryBudget& budget() const { return budget_; }
+
+private:
+    static std::minstd_rand& rng() {
+        static thread_local std::minstd_rand gen(static_cast<unsigned>(
+            std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+            static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count())));
+        return gen;
+    }
+
+    void bump(uint64_t RetryStats::*field) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        ++(stats_.*field);
+    }
+
+    RetryPolicy policy_;
+    RetryBudget budget_;
+    mutable std::mutex mtx_;
+    RetryStats stats_;
+};
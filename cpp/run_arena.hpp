@@ -0,0 +1,232 @@
+/**
+ * Drip C++ SDK - Arena-backed run builder for the testdrip harness
+ *
+ * A RecordRunParams of N events costs several heap allocations per event: the
+ * event's strings, one node per metadata entry plus its key and value, and
+ * whatever std::to_string / ostringstream produced along the way, all freed
+ * individually when the params go out of scope. ArenaRun keeps a whole run in
+ * a MonotonicArena instead. Events and metadata entries are arena records
+ * linked in insertion order, values are formatted directly into arena memory,
+ * and keys are borrowed pointers (string literals in practice), so building a
+ * 10k-event run touches the heap once per arena block and releasing it is a
+ * handful of frees.
+ *
+ * recordRun() still takes a RecordRunParams, so to_params() materializes one
+ * at send time; RunStreamWriter users can feed to_event() per event instead
+ * and never hold the whole run as std containers.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+/** Pointer + length into arena (or static) storage. Not NUL-terminated. */
+struct ArenaString {
+    const char* data;
+    size_t size;
+
+    std::string str() const { return size ? std::string(data, size) : std::string(); }
+};
+
+class MonotonicArena {
+public:
+    explicit MonotonicArena(size_t block_size = 64 * 1024)
+        : block_size_(block_size ? block_size : 1024), cur_(nullptr), left_(0), used_(0) {}
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    void* allocate(size_t n, size_t align = alignof(std::max_align_t)) {
+        size_t pad = (align - reinterpret_cast<uintptr_t>(cur_) % align) % align;
+        if (pad + n > left_) {
+            grow(n + align);
+            pad = (align - reinterpret_cast<uintptr_t>(cur_) % align) % align;
+        }
+        char* p = cur_ + pad;
+        cur_ = p + n;
+        left_ -= pad + n;
+        used_ += n;
+        return p;
+    }
+
+    /** Construct a trivially destructible T in the arena (never destroyed). */
+    template <typename T>
+    T* make() {
+        return new (allocate(sizeof(T), alignof(T))) T();
+    }
+
+    ArenaString copy(const char* s, size_t n) {
+        char* p = static_cast<char*>(allocate(n, 1));
+        std::memcpy(p, s, n);
+        return {p, n};
+    }
+
+    ArenaString copy(const std::string& s) { return copy(s.data(), s.size()); }
+
+    /** printf into the arena; values longer than 255 chars are truncated. */
+    ArenaString format(const char* fmt, ...)
+#if defined(__GNUC__)
+        __attribute__((format(printf, 2, 3)))
+#endif
+    {
+        char buf[256];
+        va_list ap;
+        va_start(ap, fmt);
+        int n = std::vsnprintf(buf, sizeof(buf), fmt, ap);
+        va_end(ap);
+        if (n < 0) n = 0;
+        if (static_cast<size_t>(n) >= sizeof(buf)) n = sizeof(buf) - 1;
+        return copy(buf, static_cast<size_t>(n));
+    }
+
+    /** Drop everything; keeps the first block for reuse. */
+    void reset() {
+        if (blocks_.size() > 1) blocks_.resize(1);
+        cur_ = blocks_.empty() ? nullptr : blocks_[0].get();
+        left_ = blocks_.empty() ? 0 : block_size_;
+        used_ = 0;
+    }
+
+    size_t bytes_used() const { return used_; }
+    size_t blocks() const { return blocks_.size(); }
+
+private:
+    void grow(size_t min_size) {
+        size_t size = min_size > block_size_ ? min_size : block_size_;
+        blocks_.push_back(std::unique_ptr<char[]>(new char[size]));
+        cur_ = blocks_.back().get();
+        left_ = size;
+    }
+
+    size_t block_size_;
+    std::vector<std::unique_ptr<char[]> > blocks_;
+    char* cur_;
+    size_t left_;
+    size_t used_;
+};
+
+struct ArenaMetadataEntry {
+    const char* key;  // Borrowed; must outlive the run
+    ArenaString value;
+    ArenaMetadataEntry* next;
+};
+
+struct ArenaEvent {
+    const char* event_type;  // Borrowed; must outlive the run
+    double quantity;
+    const char* units;       // Borrowed, may be null
+    ArenaString description;
+    double cost_units;
+    ArenaMetadataEntry* metadata;
+    ArenaMetadataEntry* metadata_tail;
+    ArenaEvent* next;
+};
+
+class ArenaRun {
+public:
+    /** Fluent handle for filling in one event; valid for the life of the run. */
+    class EventBuilder {
+    public:
+        EventBuilder& units(const char* u) {
+            e_->units = u;
+            return *this;
+        }
+        EventBuilder& cost_units(double c) {
+            e_->cost_units = c;
+            return *this;
+        }
+        EventBuilder& description(const std::string& d) {
+            e_->description = arena_->copy(d);
+            return *this;
+        }
+        EventBuilder& description(ArenaString d) {
+            e_->description = d;
+            return *this;
+        }
+        EventBuilder& meta(const char* key, ArenaString value) {
+            ArenaMetadataEntry* m = arena_->make<ArenaMetadataEntry>();
+            m->key = key;
+            m->value = value;
+            if (e_->metadata_tail) e_->metadata_tail->next = m;
+            else e_->metadata = m;
+            e_->metadata_tail = m;
+            return *this;
+        }
+        EventBuilder& meta(const char* key, const char* value) {
+            return meta(key, ArenaString{value, std::strlen(value)});
+        }
+        EventBuilder& meta(const char* key, long long value) {
+            return meta(key, arena_->format("%lld", value));
+        }
+        EventBuilder& meta(const char* key, int value) {
+            return meta(key, static_cast<long long>(value));
+        }
+        /** Fixed-point, matching to_string_2f() style values when precision is 2. */
+        EventBuilder& meta(const char* key, double value, int precision) {
+            return meta(key, arena_->format("%.*f", precision, value));
+        }
+
+    private:
+        friend class ArenaRun;
+        EventBuilder(MonotonicArena* arena, ArenaEvent* e) : arena_(arena), e_(e) {}
+        MonotonicArena* arena_;
+        ArenaEvent* e_;
+    };
+
+    /** `header` supplies customer, workflow, status and run metadata; its events are ignored. */
+    explicit ArenaRun(const drip::RecordRunParams& header, size_t block_size = 64 * 1024)
+        : header_(header), arena_(block_size), head_(nullptr), tail_(nullptr), count_(0) {
+        header_.events.clear();
+    }
+
+    EventBuilder add_event(const char* event_type, double quantity) {
+        ArenaEvent* e = arena_.make<ArenaEvent>();
+        e->event_type = event_type;
+        e->quantity = quantity;
+        if (tail_) tail_->next = e;
+        else head_ = e;
+        tail_ = e;
+        ++count_;
+        return EventBuilder(&arena_, e);
+    }
+
+    MonotonicArena& arena() { return arena_; }
+    const ArenaEvent* first() const { return head_; }
+    size_t size() const { return count_; }
+
+    static drip::RecordRunEvent to_event(const ArenaEvent& e) {
+        drip::RecordRunEvent out;
+        out.event_type = e.event_type;
+        out.quantity = e.quantity;
+        if (e.units) out.units = e.units;
+        out.description = e.description.str();
+        out.cost_units = e.cost_units;
+        for (const ArenaMetadataEntry* m = e.metadata; m; m = m->next) out.metadata[m->key] = m->value.str();
+        return out;
+    }
+
+    /** The run as the SDK's RecordRunParams, for handing to recordRun(). */
+    drip::RecordRunParams to_params() const {
+        drip::RecordRunParams p = header_;
+        p.events.reserve(count_);
+        for (const ArenaEvent* e = head_; e; e = e->next) p.events.push_back(to_event(*e));
+        return p;
+    }
+
+private:
+    drip::RecordRunParams header_;
+    MonotonicArena arena_;
+    ArenaEvent* head_;
+    ArenaEvent* tail_;
+    size_t count_;
+};
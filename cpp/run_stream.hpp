@@ -0,0 +1,133 @@
+/**
+ * Drip C++ SDK - Paginated recordRun upload for the testdrip harness
+ *
+ * recordRun() takes the whole event list in one RecordRunParams, so a job
+ * that scores millions of items has to hold every RecordRunEvent (and its
+ * metadata map) in memory before the first byte goes out. RunStreamWriter
+ * accepts events one at a time and uploads them as a sequence of recordRun()
+ * requests of at most max_events_per_request events each. One part is on the
+ * wire while the next is being filled, so memory stays at about two parts
+ * no matter how many events the run has.
+ *
+ * Part N carries external_run_id "<stream_id>-part-N" (so a retried part is
+ * deduplicated like any other external run ID) and metadata "stream_id" /
+ * "stream_part" so the parts can be stitched back together. The stream ID is
+ * the header's external_run_id, or unique_id("stream") when that is empty,
+ * so parts of concurrent writers never dedup each other. Every part
+ * shares the header's customer, workflow, status and metadata.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <utility>
+
+#include "client_metrics.hpp"
+#include "unique_id.hpp"
+
+struct RunStreamOptions {
+    size_t max_events_per_request = 500;
+};
+
+struct RunStreamStats {
+    uint64_t events = 0;
+    uint64_t requests = 0;
+    uint64_t events_created = 0;  // As reported back by the API
+    double total_cost_units = 0;
+    std::string last_run_id;
+};
+
+class RunStreamWriter {
+public:
+    /** `header` supplies everything but the events; any events in it are ignored. */
+    RunStreamWriter(drip::Client& client, const drip::RecordRunParams& header,
+                    const RunStreamOptions& opts = RunStreamOptions())
+        : client_(client), opts_(opts), header_(header), part_(0), finished_(false) {
+        if (opts_.max_events_per_request == 0) opts_.max_events_per_request = 1;
+        header_.events.clear();
+        stream_id_ = header_.external_run_id;
+        if (stream_id_.empty()) stream_id_ = unique_id("stream");
+        start_part();
+    }
+
+    /** Sends whatever is buffered; errors are swallowed here, call finish() to see them. */
+    ~RunStreamWriter() {
+        if (finished_) return;
+        try {
+            finish();
+        } catch (...) {
+        }
+    }
+
+    RunStreamWriter(const RunStreamWriter&) = delete;
+    RunStreamWriter& operator=(const RunStreamWriter&) = delete;
+
+    /** Buffer one event, uploading the current part once it is full. Rethrows upload errors. */
+    void add(drip::RecordRunEvent&& evt) {
+        current_.events.push_back(std::move(evt));
+        ++stats_.events;
+        if (current_.events.size() >= opts_.max_events_per_request) send_part();
+    }
+
+    void add(const drip::RecordRunEvent& evt) {
+        drip::RecordRunEvent copy(evt);
+        add(std::move(copy));
+    }
+
+    /** Upload the last partial part and wait for every request to complete. */
+    RunStreamStats finish() {
+        if (!finished_) {
+            finished_ = true;
+            if (!current_.events.empty() || stats_.requests == 0) send_part();
+            collect();
+        }
+        return stats_;
+    }
+
+    const std::string& stream_id() const { return stream_id_; }
+
+private:
+    void start_part() {
+        current_ = header_;
+        current_.events.reserve(opts_.max_events_per_request);
+        ++part_;
+        current_.external_run_id = stream_id_ + "-part-" + std::to_string(part_);
+        current_.metadata["stream_id"] = stream_id_;
+        current_.metadata["stream_part"] = std::to_string(part_);
+    }
+
+    void send_part() {
+        // At most one part in flight: wait for it before handing off the next
+        collect();
+        drip::Client* client = &client_;
+        drip::RecordRunParams part;
+        std::swap(part, current_);
+        in_flight_ = std::async(std::launch::async, [client](drip::RecordRunParams p) {
+            return metered(Endpoint::RECORD_RUN, p, [&] { return client->recordRun(p); });
+        }, std::move(part));
+        ++stats_.requests;
+        if (!finished_) start_part();
+    }
+
+    void collect() {
+        if (!in_flight_.valid()) return;
+        drip::RecordRunResult r = in_flight_.get();
+        stats_.events_created += r.events.created;
+        stats_.total_cost_units += r.total_cost_units;
+        stats_.last_run_id = r.run.id;
+    }
+
+    drip::Client& client_;
+    RunStreamOptions opts_;
+    drip::RecordRunParams header_;
+    drip::RecordRunParams current_;
+    std::string stream_id_;
+    int part_;
+    bool finished_;
+    std::future<drip::RecordRunResult> in_flight_;
+    RunStreamStats stats_;
+};
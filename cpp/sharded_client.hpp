@@ -0,0 +1,196 @@
+/**
+ * Drip C++ SDK - Thread-per-core sharded client for the testdrip harness
+ *
+ * One drip::Client shared by every thread funnels them all through the same
+ * impl_ and connection (RACE_TEST_REPORT.md), so whatever locking it does
+ * inside becomes the ceiling as thread counts grow. ShardedClient gives each
+ * worker thread a shard of its own instead: a private drip::Client (its own
+ * connection and buffers) and private counters, so the hot path shares no
+ * writable memory with any other thread.
+ *
+ *   ShardedClient clients(config, 32, true);   // 32 shards, pin threads to CPUs
+ *   // on each worker thread:
+ *   clients.bind(worker_index);                // optional; else round-robin on first use
+ *   clients.call([&](drip::Client& c) { return c.trackUsage(params); });
+ *
+ * A shard's client is constructed lazily by the first thread that uses it,
+ * after that thread has been pinned, so with pinning on its allocations are
+ * first-touch local to that CPU's NUMA node without needing libnuma.
+ * Pinning is Linux-only and a no-op elsewhere.
+ *
+ * Each shard's counters are relaxed atomics that only its own thread
+ * touches on the hot path (uncontended, so an increment stays in that core's
+ * cache), and totals() adds them up without taking a lock, even while the
+ * workers are busy. Every shard is a separate allocation padded past a
+ * cache line, so neighbouring shards' counters never share one.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+struct ShardTotals {
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    int64_t latency_us = 0;      // Sum over all requests
+    uint64_t min_requests = 0;   // Least-loaded shard that was used
+    uint64_t max_requests = 0;   // Most-loaded shard
+    size_t shards_used = 0;
+
+    double mean_latency_us() const { return requests ? static_cast<double>(latency_us) / requests : 0.0; }
+};
+
+class ShardedClient {
+public:
+    /** `shards` = 0 means one per hardware thread. */
+    ShardedClient(const drip::Config& config, size_t shards = 0, bool pin_threads = false)
+        : config_(config), pin_(pin_threads), next_(0), id_(next_instance_id()) {
+        if (shards == 0) shards = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < shards; ++i) shards_.push_back(std::unique_ptr<Shard>(new Shard()));
+    }
+
+    ShardedClient(const ShardedClient&) = delete;
+    ShardedClient& operator=(const ShardedClient&) = delete;
+
+    size_t shards() const { return shards_.size(); }
+    const drip::Config& config() const { return config_; }
+
+    /** Bind the calling thread to shard `index % shards()`, pinning it to a CPU if enabled. */
+    void bind(size_t index) {
+        Binding& b = binding();
+        b.instance = id_;
+        b.shard = index % shards_.size();
+        if (pin_) pin_current_thread(index);
+    }
+
+    /** The calling thread's client; unbound threads take the next shard round-robin. */
+    drip::Client& local() { return *shard_client(local_shard()); }
+
+    /** Run fn(client) on this thread's shard, counting it in the shard's stats. */
+    template <typename F>
+    auto call(F fn) -> decltype(fn(std::declval<drip::Client&>())) {
+        Shard& s = local_shard();
+        drip::Client& c = *shard_client(s);
+        struct Count {
+            Shard& s;
+            std::chrono::steady_clock::time_point t0;
+            bool failed;
+            ~Count() {
+                int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - t0).count();
+                s.requests.fetch_add(1, std::memory_order_relaxed);
+                s.latency_us.fetch_add(us, std::memory_order_relaxed);
+                if (failed) s.errors.fetch_add(1, std::memory_order_relaxed);
+            }
+        } count{s, std::chrono::steady_clock::now(), false};
+        try {
+            return fn(c);
+        } catch (...) {
+            count.failed = true;
+            throw;
+        }
+    }
+
+    /** Sum of every shard's counters; lock-free and safe while workers run. */
+    ShardTotals totals() const {
+        ShardTotals t;
+        bool first = true;
+        for (const auto& s : shards_) {
+            uint64_t n = s->requests.load(std::memory_order_relaxed);
+            t.requests += n;
+            t.errors += s->errors.load(std::memory_order_relaxed);
+            t.latency_us += s->latency_us.load(std::memory_order_relaxed);
+            if (!n) continue;
+            ++t.shards_used;
+            if (first || n < t.min_requests) t.min_requests = n;
+            if (n > t.max_requests) t.max_requests = n;
+            first = false;
+        }
+        return t;
+    }
+
+    /** Clients constructed so far (one per shard that has been used). */
+    size_t created() const {
+        size_t n = 0;
+        for (const auto& s : shards_) {
+            if (s->ready.load(std::memory_order_acquire)) ++n;
+        }
+        return n;
+    }
+
+    /** Pin the calling thread to CPU `index % hardware threads`; false if unsupported. */
+    static bool pin_current_thread(size_t index) {
+#if defined(__linux__)
+        unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(static_cast<int>(index % cpus), &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)index;
+        return false;
+#endif
+    }
+
+private:
+    struct Shard {
+        std::once_flag once;
+        std::atomic<bool> ready{false};
+        std::unique_ptr<drip::Client> client;
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<int64_t> latency_us{0};
+        char pad[64];  // Keeps the next allocation off these counters' cache line
+    };
+
+    struct Binding {
+        uint64_t instance = 0;  // Which ShardedClient the shard index belongs to
+        size_t shard = 0;
+    };
+
+    static uint64_t next_instance_id() {
+        static std::atomic<uint64_t> ids{0};
+        return ++ids;
+    }
+
+    static Binding& binding() {
+        static thread_local Binding b;
+        return b;
+    }
+
+    Shard& local_shard() {
+        Binding& b = binding();
+        if (b.instance != id_) bind(next_.fetch_add(1, std::memory_order_relaxed));
+        return *shards_[b.shard];
+    }
+
+    // Two threads bound to one shard (more threads than shards) share its client.
+    drip::Client* shard_client(Shard& s) {
+        std::call_once(s.once, [&] {
+            s.client.reset(new drip::Client(config_));
+            s.ready.store(true, std::memory_order_release);
+        });
+        return s.client.get();
+    }
+
+    drip::Config config_;
+    bool pin_;
+    std::atomic<size_t> next_;
+    uint64_t id_;
+    std::vector<std::unique_ptr<Shard> > shards_;
+};
@@ -0,0 +1,136 @@
+/**
+ * Drip C++ SDK - Soak-test trend tracking for the testdrip harness
+ *
+ * A soak run loops the same workload for hours and takes one SoakSample per
+ * interval: process resources plus that interval's latency percentiles.
+ * SoakMonitor keeps the series and, at the end, flags the ones that only
+ * ever went up, which is the shape a leak has. Noise that goes both ways is
+ * fine; a steady climb is not.
+ *
+ * A resource series is flagged as growing when, after the warm-up samples:
+ *   - no interval-to-interval step fell by `min_growth` or more,
+ *   - it rose in at least MIN_RISES separate steps (one step up is a pool
+ *     settling at a new size, not a leak), and
+ *   - it ended at least `min_growth` above where it started.
+ * That catches slow leaks that only tick up every few intervals as well as
+ * fast ones, while anything that is released again is left alone.
+ * Latency is noisier, so it is flagged as drifting when the median p99 of
+ * the last third of the run exceeds the first third's by LATENCY_DRIFT_RATIO.
+ *
+ * Warm-up (the first WARMUP_FRACTION of samples, at least one) is skipped:
+ * allocator arenas, TLS sessions and connection pools all grow to a steady
+ * size at the start of any run.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.hpp"
+#include "process_stats.hpp"
+
+struct SoakSample {
+    double elapsed_s = 0;
+    uint64_t iterations = 0;   // Cumulative
+    uint64_t errors = 0;       // Cumulative
+    ProcessSample process;
+    int64_t p50_us = 0;        // This interval only
+    int64_t p99_us = 0;
+};
+
+struct SoakVerdict {
+    std::string metric;
+    bool judged = false;  // False when the run was too short to say
+    bool flagged = false;
+    double first = 0;   // After warm-up
+    double last = 0;
+    double scale = 1;   // Multiply first/last by this for display in `unit`
+    const char* unit = "";
+    std::string detail;
+};
+
+class SoakMonitor {
+public:
+    static constexpr double WARMUP_FRACTION = 0.1;
+    static constexpr double LATENCY_DRIFT_RATIO = 1.5;
+    static const size_t MIN_SAMPLES = 5;  // Fewer post-warm-up samples than this are not judged
+    static const size_t MIN_RISES = 3;
+
+    void add(const SoakSample& s) { samples_.push_back(s); }
+    const std::vector<SoakSample>& samples() const { return samples_; }
+
+    std::vector<SoakVerdict> verdicts() const {
+        std::vector<SoakVerdict> out;
+        out.push_back(growth("rss", [](const SoakSample& s) { return s.process.rss_bytes; },
+                             1024.0 * 1024.0));
+        out.back().scale = 1.0 / (1024.0 * 1024.0);
+        out.back().unit = "MB";
+        out.push_back(growth("open_fds", [](const SoakSample& s) { return s.process.open_fds; }, 1));
+        out.push_back(growth("sockets", [](const SoakSample& s) { return s.process.sockets; }, 1));
+        out.push_back(growth("threads", [](const SoakSample& s) { return s.process.threads; }, 1));
+        out.push_back(latency_drift());
+        return out;
+    }
+
+private:
+    size_t warmup() const {
+        size_t n = static_cast<size_t>(samples_.size() * WARMUP_FRACTION);
+        return std::max<size_t>(n, 1);
+    }
+
+    template <typename Get>
+    SoakVerdict growth(const char* metric, Get get, double min_growth) const {
+        SoakVerdict v;
+        v.metric = metric;
+        size_t start = warmup();
+        if (samples_.size() < start + MIN_SAMPLES || get(samples_[start]) < 0) {
+            v.detail = "not enough samples";
+            return v;
+        }
+        v.judged = true;
+        v.first = static_cast<double>(get(samples_[start]));
+        v.last = static_cast<double>(get(samples_.back()));
+        size_t steps = 0, rises = 0, falls = 0;
+        for (size_t i = start + 1; i < samples_.size(); ++i) {
+            int64_t d = get(samples_[i]) - get(samples_[i - 1]);
+            ++steps;
+            if (d > 0) ++rises;
+            if (d < 0 && -d >= min_growth) ++falls;
+        }
+        v.flagged = falls == 0 && rises >= MIN_RISES && v.last - v.first >= min_growth;
+        v.detail = "rose in " + std::to_string(rises) + "/" + std::to_string(steps) + " intervals";
+        return v;
+    }
+
+    SoakVerdict latency_drift() const {
+        SoakVerdict v;
+        v.metric = "p99 latency";
+        v.scale = 1e-3;
+        v.unit = "ms";
+        size_t start = warmup();
+        size_t n = samples_.size() > start ? samples_.size() - start : 0;
+        if (n < MIN_SAMPLES) {
+            v.detail = "not enough samples";
+            return v;
+        }
+        v.judged = true;
+        size_t third = std::max<size_t>(n / 3, 1);
+        v.first = median_p99(start, start + third);
+        v.last = median_p99(samples_.size() - third, samples_.size());
+        v.flagged = v.first > 0 && v.last > v.first * LATENCY_DRIFT_RATIO;
+        v.detail = "median p99, first vs last third of the run";
+        return v;
+    }
+
+    double median_p99(size_t begin, size_t end) const {
+        std::vector<int64_t> v;
+        for (size_t i = begin; i < end; ++i) v.push_back(samples_[i].p99_us);
+        std::sort(v.begin(), v.end());
+        return v.empty() ? 0 : static_cast<double>(v[v.size() / 2]);
+    }
+
+    std::vector<SoakSample> samples_;
+};
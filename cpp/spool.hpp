@@ -0,0 +1,519 @@
+/**
+ * Drip C++ SDK - Durable usage spool for the testdrip harness
+ *
+ * UsageSpool is a ring file of trackUsage / emitEvent records, mapped
+ * into memory so an append is a memcpy into the page cache plus a header
+ * update — microseconds, whether or not the API is reachable. SpoolDrainer
+ * replays records in order on a background thread and only advances the
+ * spool's read offset once the API has accepted a record, so a crash or
+ * outage loses nothing that made it into the file; reopening the file
+ * resumes from the first undelivered record.
+ *
+ * Every record carries an idempotency key (one is assigned on append when the
+ * caller left it empty, scoped by unique_id() so no other spool or process
+ * can assign the same one), so a record that was delivered but not yet marked
+ * drained when the process died is deduplicated server-side on replay.
+ *
+ * Layout: a fixed header (magic, version, read/write offsets) followed by
+ * records [u32 size][u8 kind][payload], written before the write offset is
+ * published, so a torn append is simply never seen. A record that doesn't fit
+ * before the end of the file goes to the start of the data area instead, behind
+ * a zero size marker, once the drainer has freed that space; each offset is a
+ * single field only its own side moves, so the ring survives a crash at any
+ * point. When the drainer catches up, both offsets rewind to the start of the
+ * data area. Appends fail (and return false) only when undelivered records
+ * fill the file.
+ *
+ * Durability is against process crashes: dirty pages belong to the kernel
+ * once written. sync() forces them to disk for power-loss safety.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "client_metrics.hpp"
+#include "unique_id.hpp"
+
+class UsageSpool {
+public:
+    enum RecordKind : uint8_t { RECORD_TRACK_USAGE = 1, RECORD_EMIT_EVENT = 2 };
+
+    /** A decoded record; only the params matching `kind` are filled in. */
+    struct Record {
+        RecordKind kind;
+        drip::TrackUsageParams usage;
+        drip::EmitEventParams event;
+    };
+
+    /**
+     * Open (or create) the spool at `path`. An existing spool keeps its
+     * undelivered records; `capacity_bytes` only applies to new files.
+     * Throws std::runtime_error if the file cannot be mapped.
+     */
+    UsageSpool(const std::string& path, size_t capacity_bytes = 16 * 1024 * 1024)
+        : path_(path), base_(nullptr), size_(0), key_seq_(0) {
+        map_file(capacity_bytes < 4096 ? 4096 : capacity_bytes);
+        header_ = reinterpret_cast<Header*>(base_);
+        if (header_->magic != MAGIC) {
+            header_->magic = MAGIC;
+            header_->version = 2;
+            header_->read_offset = sizeof(Header);
+            header_->write_offset = sizeof(Header);
+        } else if ((header_->version != 1 && header_->version != 2) ||
+                   header_->read_offset < sizeof(Header) || header_->read_offset > size_ ||
+                   header_->write_offset < sizeof(Header) || header_->write_offset > size_ ||
+                   (header_->version == 1 && header_->read_offset > header_->write_offset)) {
+            unmap_file();
+            throw std::runtime_error("spool file is corrupt: " + path);
+        } else {
+            header_->version = 2;  // A version 1 file is a ring that never wrapped
+        }
+        key_prefix_ = unique_id("spool") + "-";
+    }
+
+    ~UsageSpool() { unmap_file(); }
+
+    UsageSpool(const UsageSpool&) = delete;
+    UsageSpool& operator=(const UsageSpool&) = delete;
+
+    /** Any thread. False if the spool is full. */
+    bool append(const drip::TrackUsageParams& p) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        const std::string key = p.idempotency_key.empty() ? next_key_locked() : p.idempotency_key;
+        return append_locked(RECORD_TRACK_USAGE, [&](Encoder& enc) {
+            enc.str(p.customer_id);
+            enc.str(p.meter);
+            enc.num(p.quantity);
+            enc.str(p.units);
+            enc.str(p.description);
+            enc.str(key);
+            enc.map(p.metadata);
+        });
+    }
+
+    /** Any thread. False if the spool is full. */
+    bool append(const drip::EmitEventParams& p) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        const std::string key = p.idempotency_key.empty() ? next_key_locked() : p.idempotency_key;
+        return append_locked(RECORD_EMIT_EVENT, [&](Encoder& enc) {
+            enc.str(p.run_id);
+            enc.str(p.event_type);
+            enc.num(p.quantity);
+            enc.str(p.units);
+            enc.str(p.description);
+            enc.str(key);
+            enc.num(p.cost_units);
+            enc.map(p.metadata);
+        });
+    }
+
+    /** Decode the oldest undelivered record without removing it. */
+    bool peek(Record& out) const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (header_->read_offset == header_->write_offset) return false;
+        const char* p = base_ + record_offset_locked(header_->read_offset);
+        uint32_t rec_size;
+        std::memcpy(&rec_size, p, 4);
+        Decoder dec(p + 5, p + rec_size);
+        out.kind = static_cast<RecordKind>(static_cast<uint8_t>(p[4]));
+        if (out.kind == RECORD_TRACK_USAGE) {
+            drip::TrackUsageParams& u = out.usage;
+            u.customer_id = dec.str();
+            u.meter = dec.str();
+            u.quantity = dec.num();
+            u.units = dec.str();
+            u.description = dec.str();
+            u.idempotency_key = dec.str();
+            dec.map(u.metadata);
+        } else {
+            drip::EmitEventParams& e = out.event;
+            e.run_id = dec.str();
+            e.event_type = dec.str();
+            e.quantity = dec.num();
+            e.units = dec.str();
+            e.description = dec.str();
+            e.idempotency_key = dec.str();
+            e.cost_units = dec.num();
+            dec.map(e.metadata);
+        }
+        return true;
+    }
+
+    /** Mark the record returned by peek() as delivered. */
+    void pop() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (header_->read_offset == header_->write_offset) return;
+        uint64_t start = record_offset_locked(header_->read_offset);
+        uint32_t rec_size;
+        std::memcpy(&rec_size, base_ + start, 4);
+        header_->read_offset = start + rec_size;
+        if (header_->read_offset == header_->write_offset) {
+            // Drained: rewind so the file is reused from the start
+            header_->read_offset = sizeof(Header);
+            header_->write_offset = sizeof(Header);
+        }
+    }
+
+    /** Bytes of undelivered records, counting the unused tail of a wrapped ring. */
+    size_t pending_bytes() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        uint64_t r = header_->read_offset, w = header_->write_offset;
+        return static_cast<size_t>(w >= r ? w - r : (size_ - r) + (w - sizeof(Header)));
+    }
+
+    bool empty() const { return pending_bytes() == 0; }
+
+    /** Flush dirty pages to disk. */
+    void sync() {
+#if defined(_WIN32)
+        FlushViewOfFile(base_, 0);
+#else
+        msync(base_, size_, MS_SYNC);
+#endif
+    }
+
+    const std::string& path() const { return path_; }
+
+private:
+    static const uint64_t MAGIC = 0x31304C4F4F505344ULL;  // "DSPOOL01"
+
+    struct Header {
+        uint64_t magic;
+        uint64_t version;
+        uint64_t read_offset;
+        uint64_t write_offset;
+    };
+
+    /** Serializes one record straight into the mapping at `start`, up to `limit`. */
+    struct Encoder {
+        Encoder(UsageSpool* s, uint64_t at, uint64_t end)
+            : spool(s), start(at), pos(at + 5), limit(end), ok(pos <= limit) {}
+
+        void bytes(const void* data, size_t n) {
+            if (!ok || pos + n > limit) {
+                ok = false;
+                return;
+            }
+            std::memcpy(spool->base_ + pos, data, n);
+            pos += n;
+        }
+        void u32(uint32_t v) { bytes(&v, 4); }
+        void num(double v) { bytes(&v, 8); }
+        void str(const std::string& s) {
+            u32(static_cast<uint32_t>(s.size()));
+            bytes(s.data(), s.size());
+        }
+        void map(const drip::Metadata& m) {
+            u32(static_cast<uint32_t>(m.size()));
+            for (drip::Metadata::const_iterator it = m.begin(); it != m.end(); ++it) {
+                str(it->first);
+                str(it->second);
+            }
+        }
+
+        UsageSpool* spool;
+        uint64_t start;
+        uint64_t pos;
+        uint64_t limit;
+        bool ok;
+    };
+
+    struct Decoder {
+        Decoder(const char* b, const char* e) : p(b), end(e) {}
+
+        uint32_t u32() {
+            uint32_t v = 0;
+            if (p + 4 <= end) std::memcpy(&v, p, 4);
+            p += 4;
+            return v;
+        }
+        double num() {
+            double v = 0;
+            if (p + 8 <= end) std::memcpy(&v, p, 8);
+            p += 8;
+            return v;
+        }
+        std::string str() {
+            uint32_t n = u32();
+            if (p + n > end) n = 0;
+            std::string s(p, n);
+            p += n;
+            return s;
+        }
+        void map(drip::Metadata& m) {
+            m.clear();
+            for (uint32_t n = u32(); n > 0 && p < end; --n) {
+                std::string k = str();
+                m[k] = str();
+            }
+        }
+
+        const char* p;
+        const char* end;
+    };
+
+    /**
+     * Where the record at `offset` starts: the start of the data area when the
+     * writer wrapped there, marked by a zero size or a tail too short to hold one.
+     */
+    uint64_t record_offset_locked(uint64_t offset) const {
+        if (size_ - offset < 5) return sizeof(Header);
+        uint32_t rec_size;
+        std::memcpy(&rec_size, base_ + offset, 4);
+        return rec_size == 0 ? sizeof(Header) : offset;
+    }
+
+    /**
+     * Encode a record with `fill` at the write offset, or at the start of the
+     * data area when the tail is too short. A record never reaches the read
+     * offset, so a full ring stays distinguishable from an empty one.
+     */
+    template <typename Fill>
+    bool append_locked(RecordKind kind, Fill fill) {
+        uint64_t r = header_->read_offset, w = header_->write_offset;
+        Encoder enc(this, w, w >= r ? size_ : r - 1);
+        fill(enc);
+        if (!enc.ok && w >= r && r > sizeof(Header)) {
+            enc = Encoder(this, sizeof(Header), r - 1);
+            fill(enc);
+        }
+        if (!enc.ok) return false;
+        uint32_t rec_size = static_cast<uint32_t>(enc.pos - enc.start);
+        std::memcpy(base_ + enc.start, &rec_size, 4);
+        base_[enc.start + 4] = static_cast<char>(kind);
+        if (enc.start != w && size_ - w >= 4) {
+            const uint32_t wrap = 0;
+            std::memcpy(base_ + w, &wrap, 4);
+        }
+        // Publish only after the record bytes are in place
+        std::atomic_thread_fence(std::memory_order_release);
+        header_->write_offset = enc.pos;
+        return true;
+    }
+
+    std::string next_key_locked() { return key_prefix_ + std::to_string(key_seq_++); }
+
+#if defined(_WIN32)
+    void map_file(size_t capacity) {
+        file_ = CreateFileA(path_.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) throw std::runtime_error("cannot open spool: " + path_);
+        LARGE_INTEGER existing;
+        GetFileSizeEx(file_, &existing);
+        size_ = existing.QuadPart > 0 ? static_cast<size_t>(existing.QuadPart) : capacity;
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<uint64_t>(size_) >> 32),
+                                      static_cast<DWORD>(size_ & 0xffffffffu), nullptr);
+        if (!mapping_) {
+            CloseHandle(file_);
+            throw std::runtime_error("cannot map spool: " + path_);
+        }
+        base_ = static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size_));
+        if (!base_) {
+            CloseHandle(mapping_);
+            CloseHandle(file_);
+            throw std::runtime_error("cannot map spool: " + path_);
+        }
+    }
+
+    void unmap_file() {
+        if (!base_) return;
+        FlushViewOfFile(base_, 0);
+        UnmapViewOfFile(base_);
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+        base_ = nullptr;
+    }
+
+    HANDLE file_;
+    HANDLE mapping_;
+#else
+    void map_file(size_t capacity) {
+        fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) throw std::runtime_error("cannot open spool: " + path_);
+        struct stat st;
+        if (fstat(fd_, &st) == 0 && st.st_size > 0) {
+            size_ = static_cast<size_t>(st.st_size);
+        } else {
+            size_ = capacity;
+            if (ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+                ::close(fd_);
+                throw std::runtime_error("cannot size spool: " + path_);
+            }
+        }
+        void* p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd_);
+            throw std::runtime_error("cannot map spool: " + path_);
+        }
+        base_ = static_cast<char*>(p);
+    }
+
+    void unmap_file() {
+        if (!base_) return;
+        msync(base_, size_, MS_ASYNC);
+        munmap(base_, size_);
+        ::close(fd_);
+        base_ = nullptr;
+    }
+
+    int fd_;
+#endif
+
+    std::string path_;
+    char* base_;
+    size_t size_;
+    Header* header_;
+    mutable std::mutex mtx_;
+    std::string key_prefix_;
+    uint64_t key_seq_;
+};
+
+struct SpoolDrainerStats {
+    uint64_t replayed = 0;
+    uint64_t duplicates = 0;       // Of replayed: 409s, already delivered under the same idempotency key
+    uint64_t failed_attempts = 0;  // Transient failures (network, 429, 5xx); the record stays queued
+    uint64_t dropped = 0;          // Rejected by the API (other 4xx) and discarded
+    bool halted = false;           // Stopped on 401/403 until set_client(); the record stays queued
+    std::string last_error;
+};
+
+/**
+ * Replays a UsageSpool in order on a background thread. Transient failures
+ * back off (10ms doubling to 1s) and retry the same record. A 409 means the
+ * record was delivered before (a replay after a crash) and counts as replayed.
+ * A 401/403 stops draining, keeping the record, until the client is swapped:
+ * credentials are the caller's to fix, and every later record would fail the
+ * same way. The client can be swapped while running, e.g. once connectivity
+ * is restored.
+ */
+class SpoolDrainer {
+public:
+    SpoolDrainer(UsageSpool& spool, drip::Client& client)
+        : spool_(spool), client_(&client), stopping_(false) {
+        thread_ = std::thread(&SpoolDrainer::run, this);
+    }
+
+    ~SpoolDrainer() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    SpoolDrainer(const SpoolDrainer&) = delete;
+    SpoolDrainer& operator=(const SpoolDrainer&) = delete;
+
+    void set_client(drip::Client& client) {
+        {
+            // Under the lock, so a drainer halted on an auth error can't miss it
+            std::lock_guard<std::mutex> lock(mtx_);
+            client_.store(&client);
+        }
+        cv_.notify_all();  // Cut any backoff short
+    }
+
+    /** Wake the drainer after appends (it also polls). */
+    void notify() { cv_.notify_all(); }
+
+    /** Wait until the spool is empty; false on timeout. */
+    bool wait_drained(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return drained_cv_.wait_for(lock, timeout, [this] { return spool_.empty(); });
+    }
+
+    SpoolDrainerStats stats() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return stats_;
+    }
+
+private:
+    void run() {
+        int backoff_ms = 0;
+        UsageSpool::Record rec;
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (!stopping_) {
+            if (!spool_.peek(rec)) {
+                drained_cv_.notify_all();
+                cv_.wait_for(lock, std::chrono::milliseconds(5));
+                continue;
+            }
+            drip::Client* client = client_.load();
+            lock.unlock();
+
+            bool delivered = false, duplicate = false, retry = false, auth = false;
+            std::string error;
+            try {
+                if (rec.kind == UsageSpool::RECORD_TRACK_USAGE) {
+                    metered(Endpoint::TRACK_USAGE, rec.usage, [&] { return client->trackUsage(rec.usage); });
+                } else {
+                    metered(Endpoint::EMIT_EVENT, rec.event, [&] { return client->emitEvent(rec.event); });
+                }
+                delivered = true;
+            } catch (const drip::DripError& e) {
+                int status = e.status_code();
+                duplicate = status == 409;
+                auth = status == 401 || status == 403;
+                retry = status == 0 || status == 429 || status >= 500;
+                error = e.what();
+            } catch (const std::exception& e) {
+                retry = true;
+                error = e.what();
+            }
+
+            lock.lock();
+            if (delivered || duplicate) {
+                spool_.pop();
+                ++stats_.replayed;
+                if (duplicate) ++stats_.duplicates;
+                backoff_ms = 0;
+            } else if (auth) {
+                stats_.halted = true;
+                stats_.last_error = error;
+                cv_.wait(lock, [&] { return stopping_ || client_.load() != client; });
+                stats_.halted = false;
+            } else if (retry) {
+                ++stats_.failed_attempts;
+                stats_.last_error = error;
+                backoff_ms = backoff_ms == 0 ? 10 : (backoff_ms < 1000 ? backoff_ms * 2 : 1000);
+                cv_.wait_for(lock, std::chrono::milliseconds(backoff_ms),
+                             [&] { return stopping_ || client_.load() != client; });
+            } else {
+                spool_.pop();
+                ++stats_.dropped;
+                stats_.last_error = error;
+            }
+        }
+    }
+
+    UsageSpool& spool_;
+    std::atomic<drip::Client*> client_;
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable drained_cv_;
+    bool stopping_;
+    SpoolDrainerStats stats_;
+    std::thread thread_;
+};
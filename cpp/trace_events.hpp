@@ -0,0 +1,190 @@
+/**
+ * Drip C++ SDK - Chrome trace-event recorder for the testdrip harness
+ *
+ * Records timed spans from any thread and writes them as Chrome trace-event
+ * JSON ("ph":"X" complete events), which chrome://tracing and Perfetto draw
+ * as one lane per thread. Every metered() SDK call becomes a span while
+ * tracing is on, so a race-test trace shows which calls overlapped on which
+ * worker and where each one waited.
+ *
+ *   TraceRecorder::instance().enable();
+ *   { TraceSpan span("race: mixed load", "race"); ... }
+ *   TraceRecorder::instance().write_json(file);
+ *
+ * Like ClientMetrics, each thread appends to its own shard (an uncontended
+ * mutex), and timestamps are microseconds since the recorder was created.
+ * Recording stops at max_events to bound memory on long benchmarks; the
+ * dump notes how many spans were dropped.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "json_writer.hpp"
+
+struct TraceEvent {
+    std::string name;
+    const char* category;  // Borrowed; a literal in practice
+    int64_t ts_us;
+    int64_t dur_us;
+    std::map<std::string, std::string> args;
+};
+
+class TraceRecorder {
+public:
+    static const size_t DEFAULT_MAX_EVENTS = 1000000;
+
+    static TraceRecorder& instance() {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+
+    void enable(bool on = true) { enabled_.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void set_max_events(size_t n) { max_events_ = n; }
+
+    /** Microseconds since the recorder was created. */
+    int64_t now_us() const { return to_us(std::chrono::steady_clock::now()); }
+
+    int64_t to_us(std::chrono::steady_clock::time_point t) const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(t - epoch_).count();
+    }
+
+    /** Name the calling thread's lane in the trace viewer. */
+    void set_thread_name(const std::string& name) {
+        Shard& s = local_shard();
+        std::lock_guard<std::mutex> lock(s.mtx);
+        s.name = name;
+    }
+
+    void complete(TraceEvent event) {
+        if (!enabled()) return;
+        if (recorded_.fetch_add(1, std::memory_order_relaxed) >= max_events_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Shard& s = local_shard();
+        std::lock_guard<std::mutex> lock(s.mtx);
+        s.events.push_back(std::move(event));
+    }
+
+    void complete(const std::string& name, const char* category, int64_t ts_us, int64_t dur_us) {
+        complete(TraceEvent{name, category, ts_us, dur_us, std::map<std::string, std::string>()});
+    }
+
+    void write_json(std::ostream& out) const {
+        JsonWriter w(1 << 16);
+        w.begin_object();
+        w.key("traceEvents");
+        w.raw("[", 1);
+        bool first = true;
+        std::lock_guard<std::mutex> lock(shards_mtx_);
+        for (const auto& s : shards_) {
+            std::lock_guard<std::mutex> shard_lock(s->mtx);
+            if (!first) w.raw(",", 1);
+            first = false;
+            w.begin_object();  // Lane label
+            w.key("name"); w.value(std::string("thread_name"));
+            w.key("ph"); w.value(std::string("M"));
+            w.key("pid"); w.value(1.0);
+            w.key("tid"); w.value(static_cast<double>(s->tid));
+            w.key("args");
+            w.value(std::map<std::string, std::string>{{"name", s->name}});
+            w.end_object();
+            for (const TraceEvent& e : s->events) {
+                w.raw(",", 1);
+                w.begin_object();
+                w.key("name"); w.value(e.name);
+                w.key("cat"); w.value(std::string(e.category));
+                w.key("ph"); w.value(std::string("X"));
+                w.key("ts"); w.value(static_cast<double>(e.ts_us));
+                w.key("dur"); w.value(static_cast<double>(e.dur_us));
+                w.key("pid"); w.value(1.0);
+                w.key("tid"); w.value(static_cast<double>(s->tid));
+                if (!e.args.empty()) {
+                    w.key("args");
+                    w.value(e.args);
+                }
+                w.end_object();
+            }
+        }
+        w.raw("]", 1);
+        w.key("displayTimeUnit"); w.value(std::string("ms"));
+        w.key("otherData");
+        w.value(std::map<std::string, std::string>{{"dropped_events", std::to_string(dropped_.load())}});
+        w.end_object();
+        out << w.str() << "\n";
+    }
+
+    uint64_t dropped() const { return dropped_.load(); }
+
+private:
+    struct Shard {
+        std::mutex mtx;
+        uint32_t tid;
+        std::string name;
+        std::vector<TraceEvent> events;
+    };
+
+    TraceRecorder()
+        : enabled_(false), max_events_(DEFAULT_MAX_EVENTS), recorded_(0), dropped_(0),
+          epoch_(std::chrono::steady_clock::now()) {}
+
+    Shard& local_shard() {
+        static thread_local Shard* shard = nullptr;
+        if (!shard) {
+            std::lock_guard<std::mutex> lock(shards_mtx_);
+            shards_.push_back(std::unique_ptr<Shard>(new Shard()));
+            shard = shards_.back().get();
+            shard->tid = static_cast<uint32_t>(shards_.size());
+            shard->name = "thread " + std::to_string(shard->tid);
+        }
+        return *shard;
+    }
+
+    std::atomic<bool> enabled_;
+    size_t max_events_;
+    std::atomic<uint64_t> recorded_;
+    std::atomic<uint64_t> dropped_;
+    std::chrono::steady_clock::time_point epoch_;
+    mutable std::mutex shards_mtx_;
+    std::vector<std::unique_ptr<Shard> > shards_;
+};
+
+/** Records a span from construction to destruction when tracing is enabled. */
+class TraceSpan {
+public:
+    TraceSpan(const std::string& name, const char* category)
+        : active_(TraceRecorder::instance().enabled()) {
+        if (!active_) return;
+        event_.name = name;
+        event_.category = category;
+        event_.ts_us = TraceRecorder::instance().now_us();
+    }
+
+    ~TraceSpan() {
+        if (!active_) return;
+        event_.dur_us = TraceRecorder::instance().now_us() - event_.ts_us;
+        TraceRecorder::instance().complete(std::move(event_));
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void arg(const std::string& key, const std::string& value) {
+        if (active_) event_.args[key] = value;
+    }
+
+private:
+    bool active_;
+    TraceEvent event_;
+};
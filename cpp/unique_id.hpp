@@ -0,0 +1,49 @@
+/**
+ * Drip C++ SDK - Process-unique IDs for client-assigned idempotency keys
+ *
+ * Helpers that assign their own idempotency keys or external run IDs need a
+ * prefix no other producer can share: the API deduplicates on the key alone,
+ * so two producers that both send "<prefix>0" lose one write. A wall-clock
+ * timestamp isn't enough (two processes or hosts start in the same
+ * millisecond all the time), so unique_id() combines it with a random
+ * per-process nonce and a per-process instance counter:
+ *
+ *   unique_id("uagg")  ->  "uagg_1760400000000_9f3c2a7d51e08b64_3"
+ *
+ * Callers append their own separator and sequence number.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace unique_id_detail {
+
+/** Drawn once per process; the clock is mixed in for random_device implementations that are deterministic. */
+inline const std::string& process_nonce() {
+    static const std::string nonce = [] {
+        std::random_device rd;
+        uint64_t v = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+        v ^= static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) * 0x9E3779B97F4A7C15ull;
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+        return std::string(buf);
+    }();
+    return nonce;
+}
+
+}  // namespace unique_id_detail
+
+/** "<tag>_<wall-clock ms>_<process nonce>_<instance>"; distinct on every call, across processes and hosts. */
+inline std::string unique_id(const std::string& tag) {
+    static std::atomic<uint64_t> instance{0};
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return tag + "_" + std::to_string(ms) + "_" + unique_id_detail::process_nonce() + "_" +
+           std::to_string(++instance);
+}
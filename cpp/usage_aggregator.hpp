@@ -0,0 +1,317 @@
+/**
+ * Drip C++ SDK - Windowed usage pre-aggregation for the testdrip harness
+ *
+ * UsageBatcher cuts round trips but still bills every event; at thousands of
+ * predictions per second per customer the events themselves are the waste.
+ * UsageAggregator rolls them up instead: events are grouped by (customer,
+ * meter, units, values of the chosen metadata dimensions), and each group
+ * sends one trackUsage() per time window carrying the summed quantity plus
+ * agg_count / agg_min / agg_max (and agg_cost_units when costs were given)
+ * in its metadata. Metadata outside the dimensions is dropped: per-event
+ * fields like request IDs are exactly what aggregation gives up.
+ *
+ * Totals are exact. Quantities are accumulated as integers in units of
+ * 1/quantity_scale (default 1e-6), so order and grouping can't introduce
+ * floating-point drift; an event whose quantity isn't a whole number of
+ * those units is sent on its own, unaggregated, rather than rounded. A group
+ * is also closed early before its sum would leave the range a double holds
+ * exactly (2^53), so the rolled-up quantity survives the JSON round trip.
+ * Each rolled-up call gets an idempotency key, so a retry can't bill twice;
+ * the keys are scoped by unique_id(), so parallel aggregators never share one.
+ * stats() tracks the fixed-point totals accepted, sent, billed (as echoed
+ * back in TrackUsageResult::quantity) and failed, so callers can check
+ * accepted == billed + failed.
+ *
+ * Events that carry their own idempotency_key are passed through untouched.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client_metrics.hpp"
+#include "unique_id.hpp"
+
+struct UsageAggregatorOptions {
+    int window_ms = 1000;
+    std::vector<std::string> dimensions;  // Metadata keys that split groups (kept on the rolled-up event)
+    int64_t quantity_scale = 1000000;     // Fixed-point resolution: 1/scale units
+};
+
+struct UsageAggregatorStats {
+    uint64_t events_in = 0;
+    uint64_t passthrough = 0;     // Keyed or not representable at quantity_scale; sent unaggregated
+    uint64_t calls_sent = 0;      // trackUsage() round trips
+    uint64_t events_sent = 0;     // Input events covered by successful calls
+    uint64_t events_failed = 0;
+    int64_t quantity_in = 0;      // Fixed point (1/quantity_scale units)
+    int64_t quantity_sent = 0;
+    int64_t quantity_billed = 0;  // Sum of the API's echoed quantities
+    int64_t quantity_failed = 0;
+    std::string last_error;
+
+    bool exact() const { return quantity_in == quantity_sent + quantity_failed && quantity_billed == quantity_sent; }
+};
+
+class UsageAggregator {
+public:
+    explicit UsageAggregator(drip::Client& client, const UsageAggregatorOptions& opts = UsageAggregatorOptions())
+        : client_(client), opts_(opts), in_flight_(0), flush_all_(false), closing_(false), seq_(0),
+          key_prefix_(unique_id("uagg") + "_") {
+        if (opts_.quantity_scale < 1) opts_.quantity_scale = 1;
+        sender_ = std::thread(&UsageAggregator::run, this);
+    }
+
+    ~UsageAggregator() { close(); }
+
+    UsageAggregator(const UsageAggregator&) = delete;
+    UsageAggregator& operator=(const UsageAggregator&) = delete;
+
+    /** Add one event; `cost_units` is summed into agg_cost_units. Returns false once closed. */
+    bool add(const drip::TrackUsageParams& params, double cost_units = 0) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (closing_) return false;
+        ++stats_.events_in;
+        int64_t q = 0, c = 0;
+        if (!params.idempotency_key.empty() || !to_fixed(params.quantity, q) || !to_fixed(cost_units, c)) {
+            Group g;
+            g.params = params;
+            g.passthrough = true;
+            g.count = 1;
+            g.sum = to_fixed_rounded(params.quantity);
+            ++stats_.passthrough;
+            stats_.quantity_in += g.sum;
+            ready_.push_back(g);
+            work_cv_.notify_one();
+            return true;
+        }
+        stats_.quantity_in += q;
+
+        std::string key = group_key(params);
+        std::map<std::string, Group>::iterator it = groups_.find(key);
+        if (it != groups_.end() && (overflows(it->second.sum, q) || overflows(it->second.cost, c))) {
+            ready_.push_back(it->second);
+            groups_.erase(it);
+            it = groups_.end();
+            work_cv_.notify_one();
+        }
+        if (it == groups_.end()) {
+            Group g;
+            g.params.customer_id = params.customer_id;
+            g.params.meter = params.meter;
+            g.params.units = params.units;
+            for (size_t i = 0; i < opts_.dimensions.size(); ++i) {
+                std::map<std::string, std::string>::const_iterator m = params.metadata.find(opts_.dimensions[i]);
+                if (m != params.metadata.end()) g.params.metadata.insert(*m);
+            }
+            g.count = 0;
+            g.sum = 0;
+            g.cost = 0;
+            g.min = g.max = params.quantity;
+            g.opened_at = Clock::now();
+            it = groups_.insert(std::make_pair(key, g)).first;
+            work_cv_.notify_one();
+        }
+        Group& g = it->second;
+        ++g.count;
+        g.sum += q;
+        g.cost += c;
+        if (params.quantity < g.min) g.min = params.quantity;
+        if (params.quantity > g.max) g.max = params.quantity;
+        return true;
+    }
+
+    /** Send every open group now and wait until all of them are delivered (or failed). */
+    void flush() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        flush_all_ = true;
+        work_cv_.notify_one();
+        drained_cv_.wait(lock, [this] { return groups_.empty() && ready_.empty() && in_flight_ == 0; });
+    }
+
+    /** Flush, then stop the sender thread. Further adds are refused. */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (closing_ && !sender_.joinable()) return;
+            closing_ = true;
+            work_cv_.notify_one();
+        }
+        if (sender_.joinable()) sender_.join();
+    }
+
+    UsageAggregatorStats stats() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return stats_;
+    }
+
+    /** A fixed-point total from stats() back in units. */
+    double to_units(int64_t fixed) const { return static_cast<double>(fixed) / opts_.quantity_scale; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    static const int64_t MAX_EXACT = static_cast<int64_t>(1) << 53;
+
+    struct Group {
+        drip::TrackUsageParams params;
+        bool passthrough = false;  // Caller's params, sent as-is
+        uint64_t count = 0;
+        int64_t sum = 0;   // Fixed point
+        int64_t cost = 0;  // Fixed point
+        double min = 0;
+        double max = 0;
+        Clock::time_point opened_at;
+    };
+
+    /** Exact conversion to fixed point; false if `v` has finer resolution than the scale. */
+    bool to_fixed(double v, int64_t& out) const {
+        double scaled = v * static_cast<double>(opts_.quantity_scale);
+        if (!std::isfinite(scaled) || std::fabs(scaled) >= static_cast<double>(MAX_EXACT)) return false;
+        out = static_cast<int64_t>(std::llround(scaled));
+        return static_cast<double>(out) / opts_.quantity_scale == v;
+    }
+
+    int64_t to_fixed_rounded(double v) const {
+        double scaled = v * static_cast<double>(opts_.quantity_scale);
+        return std::isfinite(scaled) && std::fabs(scaled) < static_cast<double>(MAX_EXACT)
+            ? static_cast<int64_t>(std::llround(scaled)) : 0;
+    }
+
+    static bool overflows(int64_t sum, int64_t add) {
+        int64_t next = sum + add;
+        return next >= MAX_EXACT || next <= -MAX_EXACT;
+    }
+
+    std::string group_key(const drip::TrackUsageParams& p) const {
+        std::string key = p.customer_id + '\x1f' + p.meter + '\x1f' + p.units;
+        for (size_t i = 0; i < opts_.dimensions.size(); ++i) {
+            std::map<std::string, std::string>::const_iterator m = p.metadata.find(opts_.dimensions[i]);
+            key += '\x1f';
+            if (m != p.metadata.end()) key += m->second;
+        }
+        return key;
+    }
+
+    static std::string format_units(double v) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.15g", v);
+        return buf;
+    }
+
+    /** Turn a closed group into the one call that bills it. */
+    void finish_locked(Group& g) {
+        if (g.passthrough) return;
+        g.params.quantity = to_units(g.sum);
+        g.params.metadata["agg_count"] = std::to_string(g.count);
+        g.params.metadata["agg_min"] = format_units(g.min);
+        g.params.metadata["agg_max"] = format_units(g.max);
+        g.params.metadata["agg_window_ms"] = std::to_string(opts_.window_ms);
+        if (g.cost != 0) g.params.metadata["agg_cost_units"] = format_units(to_units(g.cost));
+        g.params.idempotency_key = key_prefix_ + std::to_string(seq_++);
+    }
+
+    void take_due_locked(std::vector<Group>& out, bool all) {
+        Clock::time_point now = Clock::now();
+        std::chrono::milliseconds window(opts_.window_ms);
+        for (std::map<std::string, Group>::iterator it = groups_.begin(); it != groups_.end(); ) {
+            if (all || now - it->second.opened_at >= window) {
+                out.push_back(it->second);
+                groups_.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+        out.insert(out.end(), ready_.begin(), ready_.end());
+        ready_.clear();
+        for (size_t i = 0; i < out.size(); ++i) finish_locked(out[i]);
+    }
+
+    Clock::time_point next_deadline_locked() const {
+        Clock::time_point deadline = Clock::time_point::max();
+        for (std::map<std::string, Group>::const_iterator it = groups_.begin(); it != groups_.end(); ++it) {
+            Clock::time_point d = it->second.opened_at + std::chrono::milliseconds(opts_.window_ms);
+            if (d < deadline) deadline = d;
+        }
+        return deadline;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        for (;;) {
+            std::vector<Group> batch;
+            bool all = flush_all_ || closing_;
+            take_due_locked(batch, all);
+
+            if (batch.empty()) {
+                if (all) {
+                    flush_all_ = false;
+                    drained_cv_.notify_all();
+                    if (closing_) return;
+                }
+                Clock::time_point deadline = next_deadline_locked();
+                if (deadline == Clock::time_point::max()) {
+                    work_cv_.wait(lock);
+                } else {
+                    work_cv_.wait_until(lock, deadline);
+                }
+                continue;
+            }
+
+            in_flight_ += batch.size();
+            lock.unlock();
+            UsageAggregatorStats delta;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                const Group& g = batch[i];
+                try {
+                    drip::TrackUsageResult r = metered(Endpoint::TRACK_USAGE, g.params, [&] { return client_.trackUsage(g.params); });
+                    delta.events_sent += g.count;
+                    delta.quantity_sent += g.sum;
+                    delta.quantity_billed += to_fixed_rounded(r.quantity);
+                } catch (const std::exception& e) {
+                    delta.events_failed += g.count;
+                    delta.quantity_failed += g.sum;
+                    delta.last_error = e.what();
+                }
+                ++delta.calls_sent;
+            }
+            lock.lock();
+
+            in_flight_ -= batch.size();
+            stats_.calls_sent += delta.calls_sent;
+            stats_.events_sent += delta.events_sent;
+            stats_.events_failed += delta.events_failed;
+            stats_.quantity_sent += delta.quantity_sent;
+            stats_.quantity_billed += delta.quantity_billed;
+            stats_.quantity_failed += delta.quantity_failed;
+            if (!delta.last_error.empty()) stats_.last_error = delta.last_error;
+            if (groups_.empty() && ready_.empty() && in_flight_ == 0) drained_cv_.notify_all();
+        }
+    }
+
+    drip::Client& client_;
+    UsageAggregatorOptions opts_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable work_cv_;     // Sender: new group, flush or close requested
+    std::condition_variable drained_cv_;  // flush(): everything delivered
+    std::map<std::string, Group> groups_;
+    std::vector<Group> ready_;  // Passthrough events and groups closed early, sent on the next pass
+    size_t in_flight_;
+    bool flush_all_;
+    bool closing_;
+    uint64_t seq_;
+    std::string key_prefix_;
+    UsageAggregatorStats stats_;
+    std::thread sender_;
+};
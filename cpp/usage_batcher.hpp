@@ -0,0 +1,259 @@
+/**
+ * Drip C++ SDK - Client-side trackUsage batching for the testdrip harness
+ *
+ * UsageBatcher takes TrackUsageParams from any number of producer threads and
+ * coalesces them per (customer_id, meter, units): quantities are summed and a
+ * single trackUsage() call is sent per group. A background thread flushes a
+ * group once it holds max_batch_size events or its oldest event has waited
+ * max_linger_ms. When max_queue events are pending, enqueue() blocks until
+ * the sender catches up (back-pressure); try_enqueue() returns false instead.
+ *
+ * Coalesced calls keep only the metadata entries every event in the group
+ * agrees on, plus "batched_events" with the event count. Events that carry
+ * their own idempotency_key are never merged, so their dedup semantics are
+ * unchanged; they are still sent from the background thread.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client_metrics.hpp"
+#include "unique_id.hpp"
+
+struct UsageBatcherOptions {
+    size_t max_batch_size = 100;
+    int max_linger_ms = 50;
+    size_t max_queue = 10000;
+};
+
+struct UsageBatcherStats {
+    uint64_t enqueued = 0;
+    uint64_t rejected = 0;       // try_enqueue() calls refused because the queue was full
+    uint64_t calls_sent = 0;     // trackUsage() round-trips issued
+    uint64_t events_sent = 0;
+    uint64_t events_failed = 0;
+    std::string last_error;
+};
+
+class UsageBatcher {
+public:
+    explicit UsageBatcher(drip::Client& client, const UsageBatcherOptions& opts = UsageBatcherOptions())
+        : client_(client), opts_(opts), pending_(0), in_flight_(0), flush_all_(false),
+          closing_(false), batch_seq_(0),
+          batch_prefix_(unique_id("ubatch") + "_") {
+        sender_ = std::thread(&UsageBatcher::run, this);
+    }
+
+    ~UsageBatcher() { close(); }
+
+    UsageBatcher(const UsageBatcher&) = delete;
+    UsageBatcher& operator=(const UsageBatcher&) = delete;
+
+    /** Queue an event, blocking while the batcher is full. Returns false once closed. */
+    bool enqueue(const drip::TrackUsageParams& params) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        space_cv_.wait(lock, [this] { return closing_ || pending_ < opts_.max_queue; });
+        if (closing_) return false;
+        add_locked(params);
+        return true;
+    }
+
+    /** Queue an event without blocking. Returns false if the batcher is full or closed. */
+    bool try_enqueue(const drip::TrackUsageParams& params) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (closing_) return false;
+        if (pending_ >= opts_.max_queue) {
+            ++stats_.rejected;
+            return false;
+        }
+        add_locked(params);
+        return true;
+    }
+
+    /** Send everything queued so far and wait until it has been delivered (or failed). */
+    void flush() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        flush_all_ = true;
+        work_cv_.notify_one();
+        drained_cv_.wait(lock, [this] { return pending_ == 0 && in_flight_ == 0; });
+    }
+
+    /** Flush, then stop the sender thread. Further enqueues are refused. */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (closing_ && !sender_.joinable()) return;
+            closing_ = true;
+            work_cv_.notify_one();
+            space_cv_.notify_all();
+        }
+        if (sender_.joinable()) sender_.join();
+    }
+
+    UsageBatcherStats stats() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return stats_;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Group {
+        drip::TrackUsageParams params;
+        size_t count;
+        Clock::time_point first_at;
+    };
+
+    void add_locked(const drip::TrackUsageParams& params) {
+        ++pending_;
+        ++stats_.enqueued;
+        if (!params.idempotency_key.empty()) {
+            Group g;
+            g.params = params;
+            g.count = 1;
+            g.first_at = Clock::now();
+            ready_.push_back(g);
+            work_cv_.notify_one();
+            return;
+        }
+
+        std::string key = params.customer_id + '\x1f' + params.meter + '\x1f' + params.units;
+        std::map<std::string, Group>::iterator it = groups_.find(key);
+        if (it == groups_.end()) {
+            Group g;
+            g.params = params;
+            g.count = 1;
+            g.first_at = Clock::now();
+            groups_.insert(std::make_pair(key, g));
+            work_cv_.notify_one();
+            return;
+        }
+
+        Group& g = it->second;
+        g.params.quantity += params.quantity;
+        ++g.count;
+        if (g.params.description != params.description) g.params.description.clear();
+        for (std::map<std::string, std::string>::iterator m = g.params.metadata.begin();
+             m != g.params.metadata.end(); ) {
+            std::map<std::string, std::string>::const_iterator o = params.metadata.find(m->first);
+            if (o == params.metadata.end() || o->second != m->second) {
+                g.params.metadata.erase(m++);
+            } else {
+                ++m;
+            }
+        }
+        if (g.count >= opts_.max_batch_size) {
+            ready_.push_back(g);
+            groups_.erase(it);
+            work_cv_.notify_one();
+        }
+    }
+
+    /** Move every group that is due (or all of them, when draining) into `out`. */
+    void take_due_locked(std::vector<Group>& out, bool all) {
+        Clock::time_point now = Clock::now();
+        std::chrono::milliseconds linger(opts_.max_linger_ms);
+        for (std::map<std::string, Group>::iterator it = groups_.begin(); it != groups_.end(); ) {
+            if (all || now - it->second.first_at >= linger) {
+                out.push_back(it->second);
+                groups_.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+        out.insert(out.end(), ready_.begin(), ready_.end());
+        ready_.clear();
+    }
+
+    Clock::time_point next_deadline_locked() const {
+        Clock::time_point deadline = Clock::time_point::max();
+        for (std::map<std::string, Group>::const_iterator it = groups_.begin(); it != groups_.end(); ++it) {
+            Clock::time_point d = it->second.first_at + std::chrono::milliseconds(opts_.max_linger_ms);
+            if (d < deadline) deadline = d;
+        }
+        return deadline;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        for (;;) {
+            std::vector<Group> batch;
+            bool all = flush_all_ || closing_;
+            take_due_locked(batch, all);
+
+            if (batch.empty()) {
+                if (all) {
+                    flush_all_ = false;
+                    drained_cv_.notify_all();
+                    if (closing_) return;
+                }
+                Clock::time_point deadline = next_deadline_locked();
+                if (deadline == Clock::time_point::max()) {
+                    work_cv_.wait(lock);
+                } else {
+                    work_cv_.wait_until(lock, deadline);
+                }
+                continue;
+            }
+
+            in_flight_ += batch.size();
+            lock.unlock();
+            size_t sent = 0, failed = 0, calls = 0;
+            std::string error;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                Group& g = batch[i];
+                if (g.count > 1) {
+                    g.params.metadata["batched_events"] = std::to_string(g.count);
+                    g.params.idempotency_key = batch_prefix_ + std::to_string(batch_seq_++);
+                }
+                try {
+                    metered(Endpoint::TRACK_USAGE, g.params, [&] { return client_.trackUsage(g.params); });
+                    sent += g.count;
+                } catch (const std::exception& e) {
+                    failed += g.count;
+                    error = e.what();
+                }
+                ++calls;
+            }
+            lock.lock();
+
+            size_t events = sent + failed;
+            in_flight_ -= batch.size();
+            pending_ -= events;
+            stats_.calls_sent += calls;
+            stats_.events_sent += sent;
+            stats_.events_failed += failed;
+            if (!error.empty()) stats_.last_error = error;
+            space_cv_.notify_all();
+            if (pending_ == 0 && in_flight_ == 0) drained_cv_.notify_all();
+        }
+    }
+
+    drip::Client& client_;
+    UsageBatcherOptions opts_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable work_cv_;     // Sender: new events, flush or close requested
+    std::condition_variable space_cv_;    // Producers: queue has room again
+    std::condition_variable drained_cv_;  // flush(): everything delivered
+    std::map<std::string, Group> groups_;
+    std::vector<Group> ready_;  // Full groups and keyed singles, sent on the next pass
+    size_t pending_;    // Events accepted but not yet delivered or failed
+    size_t in_flight_;  // Groups currently being sent
+    bool flush_all_;
+    bool closing_;
+    uint64_t batch_seq_;
+    std::string batch_prefix_;
+    UsageBatcherStats stats_;
+    std::thread sender_;
+};
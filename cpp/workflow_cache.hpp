@@ -0,0 +1,145 @@
+/**
+ * Drip C++ SDK - Workflow slug resolution cache for the testdrip harness
+ *
+ * startRun() needs a real workflow ID (wf_xxx), and the SDK only hands one
+ * out as a side effect of recordRun(), which resolves the slug (and creates
+ * the workflow if it is missing) on every call. WorkflowCache remembers
+ * slug -> ID so that cost is paid once per slug per process. Lookups are
+ * single-flight: callers asking for a slug that is already being resolved
+ * wait on that resolve instead of starting their own, so N concurrent first
+ * uses create the workflow once rather than racing N creations
+ * (RACE_TEST_REPORT.md #2). recordRun() itself takes only a slug and
+ * resolves it on every call, so recordRun callers save no round-trips here:
+ * the seed is one extra call per slug, bought for the single creation.
+ *
+ * Failed resolves are not cached; every waiter gets the exception and the
+ * next get() tries again. With a non-zero ttl entries are re-resolved once
+ * they are older than ttl.
+ */
+
+#pragma once
+
+#include <drip/drip.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "client_metrics.hpp"
+
+struct WorkflowCacheStats {
+    uint64_t hits = 0;
+    uint64_t resolves = 0;  // Resolver calls made (misses + expiries)
+    uint64_t waits = 0;     // Lookups that joined a resolve already in flight
+};
+
+class WorkflowCache {
+public:
+    typedef std::function<std::string()> Resolver;
+
+    /** ttl of zero keeps entries for the life of the cache. */
+    explicit WorkflowCache(std::chrono::milliseconds ttl = std::chrono::milliseconds(0)) : ttl_(ttl) {}
+
+    WorkflowCache(const WorkflowCache&) = delete;
+    WorkflowCache& operator=(const WorkflowCache&) = delete;
+
+    /**
+     * Workflow ID for `slug`, calling `resolve` only if no fresh entry exists
+     * and no other thread is already resolving it. Rethrows resolver errors.
+     */
+    std::string get(const std::string& slug, const Resolver& resolve) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        std::map<std::string, Entry>::iterator it = entries_.find(slug);
+        if (it != entries_.end()) {
+            Entry& e = it->second;
+            if (!e.resolved) {
+                ++stats_.waits;
+                std::shared_future<std::string> pending = e.value;
+                lock.unlock();
+                return pending.get();
+            }
+            if (ttl_.count() == 0 || Clock::now() < e.expires_at) {
+                ++stats_.hits;
+                return e.value.get();
+            }
+            entries_.erase(it);
+        }
+
+        std::shared_ptr<std::promise<std::string> > promise = std::make_shared<std::promise<std::string> >();
+        Entry e;
+        e.value = promise->get_future().share();
+        e.resolved = false;
+        entries_[slug] = e;
+        ++stats_.resolves;
+        lock.unlock();
+
+        std::string id;
+        try {
+            id = resolve();
+            if (id.empty()) throw std::runtime_error("no workflow ID returned for '" + slug + "'");
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+            lock.lock();
+            entries_.erase(slug);
+            throw;
+        }
+        promise->set_value(id);
+
+        lock.lock();
+        it = entries_.find(slug);
+        if (it != entries_.end()) {
+            it->second.resolved = true;
+            it->second.expires_at = Clock::now() + ttl_;
+        }
+        return id;
+    }
+
+    /** Drop a slug, e.g. after the API rejected its cached ID. */
+    void invalidate(const std::string& slug) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        std::map<std::string, Entry>::iterator it = entries_.find(slug);
+        if (it != entries_.end() && it->second.resolved) entries_.erase(it);
+    }
+
+    WorkflowCacheStats stats() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return stats_;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        std::shared_future<std::string> value;
+        bool resolved;
+        Clock::time_point expires_at;
+    };
+
+    std::chrono::milliseconds ttl_;
+    mutable std::mutex mtx_;
+    std::map<std::string, Entry> entries_;
+    WorkflowCacheStats stats_;
+};
+
+/**
+ * Resolver that learns a slug's ID the only way the SDK offers: one minimal
+ * recordRun() (which creates the workflow if needed) and its run.workflow_id.
+ */
+inline std::string resolve_workflow_via_record_run(drip::Client& client, const std::string& customer_id,
+                                                   const std::string& slug) {
+    drip::RecordRunParams seed;
+    seed.customer_id = customer_id;
+    seed.workflow = slug;
+    seed.status = drip::RUN_COMPLETED;
+    drip::RecordRunEvent init;
+    init.event_type = "workflow.init";
+    init.quantity = 1;
+    seed.events.push_back(init);
+    return metered(Endpoint::RECORD_RUN, [&] { return client.recordRun(seed); }).run.workflow_id;
+}